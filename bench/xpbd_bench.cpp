@@ -0,0 +1,438 @@
+#include <benchmark/benchmark.h>
+#include <glm/glm.hpp>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "core/log.h"
+#include "physics/xpbd.h"
+#include "physics/entity.h"
+#include "physics/collider.h"
+#include "physics/collision_broad_phase.h"
+#include "physics/sweep_and_prune_broad_phase.h"
+#include "physics/spatial_hash_grid.h"
+#include "core/thread_pool.h"
+#include "physics/collision_narrow_phase.h"
+#include "geometry/sphere_mesh.h"
+#include "geometry/cube_mesh.h"
+#include "geometry/signed_distance_grid.h"
+
+// 性能基准：所有结果以 items/s 报告，便于每次优化都在相同场景上对比
+// 用法：xpbd_bench --benchmark_filter=BroadPhase  （参数见 Google Benchmark 文档）
+
+namespace
+{
+    // 半径 0.1 的低分辨率球，宽相只关心包围盒，顶点越少越能体现树本身的开销
+    const float SphereRadius = 0.1f;
+
+    // count 个球排成近似立方的网格，间距略小于直径，使相邻的球两两重叠
+    std::vector<glm::vec3> makeGrid(int count, float spacing)
+    {
+        int side = static_cast<int>(std::ceil(std::cbrt(static_cast<float>(count))));
+        std::vector<glm::vec3> positions;
+        positions.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            int x = i % side;
+            int y = (i / side) % side;
+            int z = i / (side * side);
+            positions.emplace_back(x * spacing, y * spacing, z * spacing);
+        }
+        return positions;
+    }
+
+    // 场景持有网格和实体的所有权
+    struct Scene
+    {
+        std::vector<std::unique_ptr<Mesh>> meshes;
+        std::vector<std::unique_ptr<Entity>> entities;
+
+        Entity* add(Mesh* mesh, const glm::vec3& position, float mass)
+        {
+            entities.emplace_back(new Entity(mesh, position, mass));
+            return entities.back().get();
+        }
+    };
+
+    // 宽相场景：count 个重叠排列的球
+    void buildBroadPhaseScene(Scene& scene, BroadPhase& broadPhase, int count)
+    {
+        scene.meshes.emplace_back(new SphereMesh(SphereRadius, 6, 6));
+        Mesh* mesh = scene.meshes.back().get();
+        for (const glm::vec3& position : makeGrid(count, 1.8f * SphereRadius))
+        {
+            broadPhase.addObject(scene.add(mesh, position, 1.0f));
+        }
+    }
+
+    // 下落场景：count 个球分布在地面上方的若干层中，彼此分开
+    void buildFallingScene(Scene& scene, XPBDSystem& system, int count)
+    {
+        scene.meshes.emplace_back(new SphereMesh(SphereRadius, 8, 8));
+        scene.meshes.emplace_back(new CubeMesh(2.0f, 2.0f, 0.05f));
+        Mesh* sphere = scene.meshes[0].get();
+        Mesh* ground = scene.meshes[1].get();
+
+        const int perLayer = 64; // 8 x 8，落在 2 x 2 的地面内
+        for (int i = 0; i < count; ++i)
+        {
+            int layer = i / perLayer;
+            int x = (i % perLayer) % 8;
+            int z = (i % perLayer) / 8;
+            glm::vec3 position(-0.85f + x * 0.24f, 0.3f + layer * 0.3f, -0.85f + z * 0.24f);
+            system.addObject(scene.add(sphere, position, 1.0f));
+        }
+        system.addObject(scene.add(ground, glm::vec3(0.0f, -0.1f, 0.0f), 0.0f));
+        system.initialize();
+    }
+
+    // 堆叠场景：若干列竖直叠放、刚好接触的球，每列 5 个
+    void buildStackingScene(Scene& scene, XPBDSystem& system, int count)
+    {
+        scene.meshes.emplace_back(new SphereMesh(SphereRadius, 8, 8));
+        scene.meshes.emplace_back(new CubeMesh(2.0f, 2.0f, 0.05f));
+        Mesh* sphere = scene.meshes[0].get();
+        Mesh* ground = scene.meshes[1].get();
+
+        const int height = 5;
+        for (int i = 0; i < count; ++i)
+        {
+            int column = i / height;
+            int level = i % height;
+            int x = column % 8;
+            int z = column / 8;
+            glm::vec3 position(-0.85f + x * 0.24f, 0.025f + level * 2.0f * SphereRadius, -0.85f + z * 0.24f);
+            system.addObject(scene.add(sphere, position, 1.0f));
+        }
+        system.addObject(scene.add(ground, glm::vec3(0.0f, -0.1f, 0.0f), 0.0f));
+        system.initialize();
+    }
+
+    // 网格的三角形作为凸包的面，支撑函数据此建立顶点邻接关系
+    std::vector<std::vector<unsigned int>> triangleFaces(const Mesh& mesh)
+    {
+        const std::vector<unsigned int>& indices = mesh.getIndices();
+        std::vector<std::vector<unsigned int>> faces;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            faces.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+        }
+        return faces;
+    }
+}
+
+// 宽相：批量加载，每次迭代新建宽相、加入所有刚体并完成第一次 update + collectCollisionPairs
+template <typename BroadPhaseT>
+static void BM_BroadPhaseBulkLoad(benchmark::State& state)
+{
+    Scene scene;
+    BroadPhaseT source;
+    buildBroadPhaseScene(scene, source, static_cast<int>(state.range(0)));
+    ThreadPool pool;
+
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    for (auto _ : state)
+    {
+        BroadPhaseT broadPhase;
+        broadPhase.setThreadPool(&pool);
+        for (auto& entity : scene.entities)
+        {
+            broadPhase.addObject(entity.get());
+        }
+        broadPhase.update();
+        broadPhase.collectCollisionPairs(pairs);
+        benchmark::DoNotOptimize(pairs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_BroadPhaseBulkLoad, CollisionBroadPhase)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BroadPhaseBulkLoad, SweepAndPruneBroadPhase)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BroadPhaseBulkLoad, SpatialHashGrid)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond);
+
+// 宽相：刷新所有包围盒（刚体静止）
+template <typename BroadPhaseT>
+static void BM_BroadPhaseUpdate(benchmark::State& state)
+{
+    Scene scene;
+    BroadPhaseT broadPhase;
+    buildBroadPhaseScene(scene, broadPhase, static_cast<int>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        broadPhase.update();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_BroadPhaseUpdate, CollisionBroadPhase)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_BroadPhaseUpdate, SweepAndPruneBroadPhase)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_BroadPhaseUpdate, SpatialHashGrid)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+
+// 宽相：收集潜在碰撞对
+template <typename BroadPhaseT>
+static void BM_BroadPhaseCollectPairs(benchmark::State& state)
+{
+    Scene scene;
+    BroadPhaseT broadPhase;
+    buildBroadPhaseScene(scene, broadPhase, static_cast<int>(state.range(0)));
+    broadPhase.update();
+
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    for (auto _ : state)
+    {
+        broadPhase.collectCollisionPairs(pairs);
+        benchmark::DoNotOptimize(pairs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["pairs"] = static_cast<double>(pairs.size());
+}
+BENCHMARK_TEMPLATE(BM_BroadPhaseCollectPairs, CollisionBroadPhase)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_BroadPhaseCollectPairs, SweepAndPruneBroadPhase)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_BroadPhaseCollectPairs, SpatialHashGrid)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+
+// 宽相：所有刚体整体平移（传送带式的连贯运动），每次迭代 update + collectCollisionPairs
+template <typename BroadPhaseT>
+static void BM_BroadPhaseCoherentMotion(benchmark::State& state)
+{
+    Scene scene;
+    BroadPhaseT broadPhase;
+    buildBroadPhaseScene(scene, broadPhase, static_cast<int>(state.range(0)));
+    broadPhase.update();
+
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    const glm::vec3 velocity(0.5f, 0.0f, 0.0f);
+    const float dt = 1.0f / 120.0f;
+    for (auto _ : state)
+    {
+        for (auto& entity : scene.entities)
+        {
+            entity->setPosition(entity->getPosition() + velocity * dt);
+        }
+        broadPhase.update();
+        broadPhase.collectCollisionPairs(pairs);
+        benchmark::DoNotOptimize(pairs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_BroadPhaseCoherentMotion, CollisionBroadPhase)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_BroadPhaseCoherentMotion, SweepAndPruneBroadPhase)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_BroadPhaseCoherentMotion, SpatialHashGrid)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMicrosecond);
+
+// 粒子：空间哈希重建 + 邻居对，参数为粒子数和线程数，模拟每个子步重建一次的颗粒/流体负载
+static void BM_SpatialHashNeighbourPairs(benchmark::State& state)
+{
+    const int count = static_cast<int>(state.range(0));
+    const float spacing = 0.18f;
+    std::vector<glm::vec3> positions = makeGrid(count, spacing);
+    ThreadPool pool(static_cast<size_t>(state.range(1)));
+    SpatialHashGrid grid;
+    grid.setThreadPool(&pool);
+
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for (auto _ : state)
+    {
+        grid.build(positions, 2.0f * SphereRadius);
+        grid.collectNeighbourPairs(2.0f * SphereRadius, pairs);
+        benchmark::DoNotOptimize(pairs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["pairs"] = static_cast<double>(pairs.size());
+}
+BENCHMARK(BM_SpatialHashNeighbourPairs)->ArgsProduct({ { 10000, 100000, 1000000 }, { 1, 4 } })->Unit(benchmark::kMillisecond);
+
+// 场景查询：在 10000 个球中批量检测射线，参数为射线数和线程数
+static void BM_BroadPhaseRayCastBatch(benchmark::State& state)
+{
+    Scene scene;
+    CollisionBroadPhase broadPhase;
+    buildBroadPhaseScene(scene, broadPhase, 10000);
+    ThreadPool pool(static_cast<size_t>(state.range(1)));
+    broadPhase.setThreadPool(&pool);
+    broadPhase.update();
+
+    // 从场景一侧射入，起点在 y-z 平面上均匀分布
+    const int count = static_cast<int>(state.range(0));
+    std::vector<RayCastQuery> rays(count);
+    for (int i = 0; i < count; ++i)
+    {
+        float u = static_cast<float>(i % 64) / 64.0f;
+        float v = static_cast<float>(i / 64 % 64) / 64.0f;
+        rays[i].origin = glm::vec3(-1.0f, 4.0f * u, 4.0f * v);
+        rays[i].direction = glm::vec3(1.0f, 0.1f * (v - 0.5f), 0.1f * (u - 0.5f));
+        rays[i].maxDistance = 10.0f;
+    }
+
+    std::vector<RayCastHit> hits;
+    for (auto _ : state)
+    {
+        broadPhase.rayCastClosestBatch(rays, hits);
+        benchmark::DoNotOptimize(hits.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BroadPhaseRayCastBatch)->ArgsProduct({ { 1000, 10000 }, { 1, 4 } })->Unit(benchmark::kMillisecond);
+
+// 窄相：两个相交的球，参数为 SphereMesh 的经纬分段数
+static void BM_NarrowPhaseDetect(benchmark::State& state)
+{
+    int resolution = static_cast<int>(state.range(0));
+    SphereMesh mesh(SphereRadius, resolution, resolution);
+    Entity a(&mesh, glm::vec3(0.0f), 1.0f);
+    Entity b(&mesh, glm::vec3(0.15f, 0.05f, 0.0f), 1.0f);
+    CollisionNarrowPhase narrowPhase;
+    // 距离场在第一次查询时烘焙，不计入计时
+    mesh.getSignedDistanceGrid();
+
+    for (auto _ : state)
+    {
+        float penetration = 0.0f;
+        glm::vec3 normal(0.0f);
+        bool hit = narrowPhase.detectCollision(&a, a.getPosition(), &b, b.getPosition(), penetration, normal);
+        benchmark::DoNotOptimize(hit);
+        benchmark::DoNotOptimize(penetration);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["triangles"] = static_cast<double>(mesh.getIndexCount() / 3);
+}
+BENCHMARK(BM_NarrowPhaseDetect)->RangeMultiplier(2)->Range(8, 128);
+
+// 距离场烘焙：每次迭代重新构造，参数为 SphereMesh 的经纬分段数
+static void BM_SignedDistanceGridBake(benchmark::State& state)
+{
+    int resolution = static_cast<int>(state.range(0));
+    SphereMesh mesh(SphereRadius, resolution, resolution);
+
+    for (auto _ : state)
+    {
+        SignedDistanceGrid grid(mesh);
+        benchmark::DoNotOptimize(grid.getCellSize());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["triangles"] = static_cast<double>(mesh.getIndexCount() / 3);
+}
+BENCHMARK(BM_SignedDistanceGridBake)->RangeMultiplier(2)->Range(8, 128)->Unit(benchmark::kMillisecond);
+
+// 窄相：同样的两个球改为挂上以网格为凸包的碰撞体，走 GJK/EPA；支撑顶点下标跨迭代保存，与成对缓存相同
+static void BM_NarrowPhaseConvex(benchmark::State& state)
+{
+    int resolution = static_cast<int>(state.range(0));
+    SphereMesh mesh(SphereRadius, resolution, resolution);
+    Collider hull(mesh.getPositions(), triangleFaces(mesh));
+    Entity a(&mesh, glm::vec3(0.0f), 1.0f);
+    Entity b(&mesh, glm::vec3(0.15f, 0.05f, 0.0f), 1.0f);
+    a.setCollider(&hull);
+    b.setCollider(&hull);
+    CollisionNarrowPhase narrowPhase;
+    unsigned int hintA = 0;
+    unsigned int hintB = 0;
+
+    for (auto _ : state)
+    {
+        float penetration = 0.0f;
+        float separation = 0.0f;
+        glm::vec3 normal(0.0f);
+        bool hit = narrowPhase.detectCollision(&a, a.getPosition(), &b, b.getPosition(), penetration, normal,
+                                               separation, &hintA, &hintB);
+        benchmark::DoNotOptimize(hit);
+        benchmark::DoNotOptimize(penetration);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["vertices"] = static_cast<double>(mesh.getPositions().size());
+}
+BENCHMARK(BM_NarrowPhaseConvex)->RangeMultiplier(2)->Range(8, 128);
+
+// 支撑点查询：凸包顶点数随 SphereMesh 分辨率变化，方向每次旋转以避免分支预测偏向
+static void BM_ColliderSupportPoint(benchmark::State& state)
+{
+    int resolution = static_cast<int>(state.range(0));
+    SphereMesh mesh(SphereRadius, resolution, resolution);
+    Collider collider(mesh.getPositions(), std::vector<std::vector<unsigned int>>());
+
+    const int directionCount = 64;
+    std::vector<glm::vec3> directions;
+    for (int i = 0; i < directionCount; ++i)
+    {
+        float theta = 2.399963f * i; // 黄金角，方向均匀分布在球面上
+        float y = 1.0f - 2.0f * (i + 0.5f) / directionCount;
+        float r = std::sqrt(1.0f - y * y);
+        directions.emplace_back(r * std::cos(theta), y, r * std::sin(theta));
+    }
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        glm::vec3 support = collider.getSupportPoint(directions[i++ & (directionCount - 1)]);
+        benchmark::DoNotOptimize(support);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["vertices"] = static_cast<double>(mesh.getPositions().size());
+}
+BENCHMARK(BM_ColliderSupportPoint)->RangeMultiplier(2)->Range(8, 128);
+
+// 支撑点查询：带面信息的凸包从上次的支撑顶点爬山，方向每次转动一个小角度，模拟帧间的时间相关性
+static void BM_ColliderSupportHillClimb(benchmark::State& state)
+{
+    int resolution = static_cast<int>(state.range(0));
+    SphereMesh mesh(SphereRadius, resolution, resolution);
+    Collider collider(mesh.getPositions(), triangleFaces(mesh));
+
+    const int directionCount = 1024;
+    std::vector<glm::vec3> directions;
+    for (int i = 0; i < directionCount; ++i)
+    {
+        float angle = 2.0f * 3.14159265f * i / directionCount;
+        directions.emplace_back(std::cos(angle), 0.3f * std::sin(3.0f * angle), std::sin(angle));
+    }
+
+    size_t i = 0;
+    unsigned int hint = 0;
+    for (auto _ : state)
+    {
+        glm::vec3 support = collider.getSupportPoint(directions[i++ & (directionCount - 1)], hint);
+        benchmark::DoNotOptimize(support);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["vertices"] = static_cast<double>(mesh.getPositions().size());
+}
+BENCHMARK(BM_ColliderSupportHillClimb)->RangeMultiplier(2)->Range(4, 128);
+
+// 完整时间步：下落场景，items 为 刚体数 x 步数
+static void BM_XPBDRunFalling(benchmark::State& state)
+{
+    Scene scene;
+    XPBDSystem system;
+    buildFallingScene(scene, system, static_cast<int>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        system.run();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_XPBDRunFalling)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMillisecond);
+
+// 完整时间步：堆叠场景（休眠前的接触求解负载）
+static void BM_XPBDRunStacking(benchmark::State& state)
+{
+    Scene scene;
+    XPBDSystem system;
+    system.setSleepEnabled(false); // 保持所有堆叠处于活动状态，测量接触求解本身
+    buildStackingScene(scene, system, static_cast<int>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        system.run();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_XPBDRunStacking)->RangeMultiplier(4)->Range(20, 320)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+    // 场景初始化会输出大量 Info 日志，基准测试中只保留警告和错误
+    Logger::instance().setLevel(LogLevel::Warn);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -308,6 +308,7 @@ int hash_map_delete(Hash_Map *hm, const void *key) {
 }
 
 Hash_Map_Iterator hash_map_get_iterator(Hash_Map *hm) {
+    (void)hm;
     return (Hash_Map_Iterator)0;
 }
 
@@ -0,0 +1,149 @@
+#include "core/log.h"
+#include "core/ring_buffer.h"
+#include <chrono>
+#include <cstdarg>
+
+namespace
+{
+    const size_t QueueCapacity = 8192;
+
+    const char* levelName(LogLevel level)
+    {
+        static const char* names[] = { "T", "D", "I", "W", "E" };
+        return names[static_cast<uint8_t>(level)];
+    }
+
+    const char* categoryName(LogCategory category)
+    {
+        static const char* names[] = { "general", "solver", "broad", "narrow", "geometry" };
+        return names[static_cast<uint8_t>(category)];
+    }
+
+    uint64_t nowNs()
+    {
+        static const auto start = std::chrono::steady_clock::now();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    // 按首次写日志的顺序给线程编号，比 std::thread::id 更易读
+    uint32_t currentThreadId()
+    {
+        static std::atomic<uint32_t> nextId(0);
+        thread_local uint32_t id = nextId.fetch_add(1);
+        return id;
+    }
+}
+
+Logger& Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : queue(new RingBuffer<LogRecord>(QueueCapacity)),
+      minLevel(static_cast<uint8_t>(LogLevel::Info)),
+      categoryMask(~0u),
+      output(stdout),
+      dropped(0), pushed(0), written(0),
+      started(false), stopping(false)
+{
+}
+
+Logger::~Logger()
+{
+    if (started.load())
+    {
+        stopping.store(true);
+        drainThread.join();
+    }
+    drain();
+}
+
+void Logger::setCategoryEnabled(LogCategory category, bool enabled)
+{
+    uint32_t bit = 1u << static_cast<uint8_t>(category);
+    if (enabled) categoryMask.fetch_or(bit, std::memory_order_relaxed);
+    else categoryMask.fetch_and(~bit, std::memory_order_relaxed);
+}
+
+void Logger::write(LogLevel level, LogCategory category, const char* format, ...)
+{
+    LogRecord record;
+    record.timestampNs = nowNs();
+    record.threadId = currentThreadId();
+    record.level = level;
+    record.category = category;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(record.message, sizeof(record.message), format, args);
+    va_end(args);
+
+    ensureStarted();
+    if (queue->tryPush(record))
+    {
+        pushed.fetch_add(1, std::memory_order_release);
+    }
+    else
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Logger::flush()
+{
+    if (!started.load(std::memory_order_acquire)) return;
+    uint64_t target = pushed.load(std::memory_order_acquire);
+    while (written.load(std::memory_order_acquire) < target)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    FILE* file = output.load(std::memory_order_relaxed);
+    if (file) fflush(file);
+}
+
+void Logger::ensureStarted()
+{
+    if (started.load(std::memory_order_acquire)) return;
+    // 只有第一次写日志的线程负责启动后台线程
+    bool expected = false;
+    if (started.compare_exchange_strong(expected, true))
+    {
+        drainThread = std::thread(&Logger::drainLoop, this);
+    }
+}
+
+void Logger::drainLoop()
+{
+    while (!stopping.load(std::memory_order_acquire))
+    {
+        if (drain() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    drain();
+}
+
+size_t Logger::drain()
+{
+    size_t count = 0;
+    LogRecord record;
+    FILE* file = output.load(std::memory_order_relaxed);
+    while (queue->tryPop(record))
+    {
+        if (file)
+        {
+            fprintf(file, "[%12.6f][%s][%s][t%u] %s\n", record.timestampNs * 1e-9, levelName(record.level),
+                    categoryName(record.category), record.threadId, record.message);
+        }
+        ++count;
+    }
+    if (count > 0)
+    {
+        written.fetch_add(count, std::memory_order_release);
+    }
+    return count;
+}
@@ -0,0 +1,144 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+// 分级、分类的日志
+// 调用线程只做格式化并写入无锁环形队列，由后台线程统一输出，求解器线程不会在 stdout 上串行化
+// Release 构建（定义 NDEBUG）默认整体编译掉，宏参数不会被求值；可用 -DXPBD_LOGGING_ENABLED=1 强制开启
+// XPBD_LOG_COMPILE_LEVEL 可在编译期去掉低于该级别的日志（0 = Trace ... 4 = Error）
+
+enum class LogLevel : uint8_t
+{
+    Trace = 0,
+    Debug,
+    Info,
+    Warn,
+    Error
+};
+
+enum class LogCategory : uint8_t
+{
+    General = 0,
+    Solver,
+    BroadPhase,
+    NarrowPhase,
+    Geometry,
+    Count
+};
+
+#ifndef XPBD_LOGGING_ENABLED
+#ifdef NDEBUG
+#define XPBD_LOGGING_ENABLED 0
+#else
+#define XPBD_LOGGING_ENABLED 1
+#endif
+#endif
+
+#ifndef XPBD_LOG_COMPILE_LEVEL
+#define XPBD_LOG_COMPILE_LEVEL 0
+#endif
+
+// 编译期的级别过滤；级别为 0 时直接返回 true，避免比较恒为真触发 -Wtype-limits
+#if XPBD_LOG_COMPILE_LEVEL > 0
+constexpr bool logLevelCompiledIn(LogLevel level) { return static_cast<int>(level) >= XPBD_LOG_COMPILE_LEVEL; }
+#else
+constexpr bool logLevelCompiledIn(LogLevel) { return true; }
+#endif
+
+// 队列中的一条日志，消息定长以避免在热路径上分配内存，超长部分被截断
+struct LogRecord
+{
+    uint64_t timestampNs;
+    uint32_t threadId;
+    LogLevel level;
+    LogCategory category;
+    char message[192];
+};
+
+template <typename T> class RingBuffer;
+
+class Logger
+{
+    public:
+        static Logger& instance();
+
+        // 运行期过滤：低于 level 的日志在格式化之前就被丢弃
+        void setLevel(LogLevel level) { minLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+        LogLevel getLevel() const { return static_cast<LogLevel>(minLevel.load(std::memory_order_relaxed)); }
+        // 按类别开关
+        void setCategoryEnabled(LogCategory category, bool enabled);
+        bool isEnabled(LogLevel level, LogCategory category) const
+        {
+            return static_cast<uint8_t>(level) >= minLevel.load(std::memory_order_relaxed) &&
+                   (categoryMask.load(std::memory_order_relaxed) & (1u << static_cast<uint8_t>(category))) != 0;
+        }
+
+        // 输出目标，默认为 stdout
+        void setOutput(FILE* file) { output.store(file, std::memory_order_relaxed); }
+
+        // printf 风格；队列满时丢弃该条并计数，从不阻塞
+        void write(LogLevel level, LogCategory category, const char* format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+            __attribute__((format(printf, 4, 5)))
+#endif
+            ;
+
+        // 阻塞直到队列中已有的日志全部输出
+        void flush();
+        uint64_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+    private:
+        Logger();
+        ~Logger();
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        std::unique_ptr<RingBuffer<LogRecord>> queue;
+        std::atomic<uint8_t> minLevel;
+        std::atomic<uint32_t> categoryMask;
+        std::atomic<FILE*> output;
+        std::atomic<uint64_t> dropped;
+        std::atomic<uint64_t> pushed;      // 成功入队的条数
+        std::atomic<uint64_t> written;     // 已输出的条数
+        std::atomic<bool> started;
+        std::atomic<bool> stopping;
+        std::thread drainThread;
+
+        void ensureStarted();
+        void drainLoop();
+        // 输出队列中当前的全部日志，返回条数
+        size_t drain();
+};
+
+#if XPBD_LOGGING_ENABLED
+#define XPBD_LOG_ENABLED(level, category) \
+    (::logLevelCompiledIn(level) && ::Logger::instance().isEnabled(level, category))
+#define XPBD_LOG(level, category, ...)                                      \
+    do                                                                      \
+    {                                                                       \
+        if (XPBD_LOG_ENABLED(level, category))                              \
+            ::Logger::instance().write(level, category, __VA_ARGS__);       \
+    } while (0)
+#else
+// 关闭时保留一个永不执行的调用，参数不会被求值，但格式串仍做类型检查且不会产生“未使用变量”警告
+#define XPBD_LOG_ENABLED(level, category) false
+#define XPBD_LOG(level, category, ...)                                      \
+    do                                                                      \
+    {                                                                       \
+        if (false)                                                          \
+            ::Logger::instance().write(level, category, __VA_ARGS__);       \
+    } while (0)
+#endif
+
+#define XPBD_LOG_TRACE(category, ...) XPBD_LOG(::LogLevel::Trace, ::LogCategory::category, __VA_ARGS__)
+#define XPBD_LOG_DEBUG(category, ...) XPBD_LOG(::LogLevel::Debug, ::LogCategory::category, __VA_ARGS__)
+#define XPBD_LOG_INFO(category, ...) XPBD_LOG(::LogLevel::Info, ::LogCategory::category, __VA_ARGS__)
+#define XPBD_LOG_WARN(category, ...) XPBD_LOG(::LogLevel::Warn, ::LogCategory::category, __VA_ARGS__)
+#define XPBD_LOG_ERROR(category, ...) XPBD_LOG(::LogLevel::Error, ::LogCategory::category, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,88 @@
+#include "core/profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+uint64_t Profiler::nowNs()
+{
+    // 以 1 为起点，0 保留给“未开始计时”
+    static const auto start = std::chrono::steady_clock::now();
+    return 1 + static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+Profiler::ThreadBuffer& Profiler::localBuffer()
+{
+    // 缓冲区归 Profiler 所有，线程退出后数据仍可导出
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers.emplace_back(new ThreadBuffer());
+        buffer = buffers.back().get();
+        buffer->threadId = static_cast<uint32_t>(buffers.size() - 1);
+        buffer->zones.reserve(4096);
+    }
+    return *buffer;
+}
+
+void Profiler::record(const char* name, uint64_t startNs, uint64_t endNs)
+{
+    localBuffer().zones.push_back(ProfileZone{ name, startNs, endNs });
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (auto& buffer : buffers)
+    {
+        buffer->zones.clear();
+    }
+}
+
+size_t Profiler::getZoneCount() const
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    size_t count = 0;
+    for (const auto& buffer : buffers)
+    {
+        count += buffer->zones.size();
+    }
+    return count;
+}
+
+void Profiler::exportChromeTrace(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    char line[512];
+    for (const auto& buffer : buffers)
+    {
+        for (const ProfileZone& zone : buffer->zones)
+        {
+            // trace_event 的 ts/dur 以微秒为单位，保留三位小数即纳秒精度
+            snprintf(line, sizeof(line),
+                     "%s\n{\"name\":\"%s\",\"cat\":\"xpbd\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                     first ? "" : ",", zone.name, zone.startNs * 1e-3, (zone.endNs - zone.startNs) * 1e-3,
+                     buffer->threadId);
+            out << line;
+            first = false;
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file) return false;
+    exportChromeTrace(file);
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,89 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 作用域计时区间（zone），用于分析一个时间步在各阶段的耗时
+// 每个线程写自己的缓冲区，记录时不加锁；运行期关闭时每个 zone 只有一次原子读
+// 定义 XPBD_PROFILING_ENABLED=0 可在编译期完全去掉
+// 导出为 Chrome trace_event JSON，可直接在 Perfetto / chrome://tracing 中打开
+
+#ifndef XPBD_PROFILING_ENABLED
+#define XPBD_PROFILING_ENABLED 1
+#endif
+
+struct ProfileZone
+{
+    const char* name;     // 必须是字符串字面量等静态存储的字符串
+    uint64_t startNs;
+    uint64_t endNs;
+};
+
+class Profiler
+{
+    public:
+        static Profiler& instance();
+
+        void setEnabled(bool enabled) { active.store(enabled, std::memory_order_relaxed); }
+        bool isEnabled() const { return active.load(std::memory_order_relaxed); }
+
+        // 以下接口需要在没有线程正在记录时调用（例如两个时间步之间）
+        void clear();
+        size_t getZoneCount() const;
+        // 写出 {"traceEvents":[...]}，每个 zone 为一个 "ph":"X" 完整事件，时间单位为微秒
+        void exportChromeTrace(std::ostream& out) const;
+        bool exportChromeTrace(const std::string& path) const;
+
+        static uint64_t nowNs();
+        void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    private:
+        struct ThreadBuffer
+        {
+            uint32_t threadId;
+            std::vector<ProfileZone> zones;
+        };
+
+        Profiler() : active(false) {}
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        std::atomic<bool> active;
+        mutable std::mutex buffersMutex;   // 只在线程第一次记录时和导出时使用
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+        ThreadBuffer& localBuffer();
+};
+
+// 构造时记录开始时间，析构时写入当前线程的缓冲区
+class ScopedProfileZone
+{
+    public:
+        explicit ScopedProfileZone(const char* zoneName)
+            : name(zoneName), startNs(Profiler::instance().isEnabled() ? Profiler::nowNs() : 0) {}
+        ~ScopedProfileZone()
+        {
+            if (startNs != 0) Profiler::instance().record(name, startNs, Profiler::nowNs());
+        }
+
+    private:
+        const char* name;
+        uint64_t startNs;
+};
+
+#define XPBD_PROFILE_CONCAT_INNER(a, b) a##b
+#define XPBD_PROFILE_CONCAT(a, b) XPBD_PROFILE_CONCAT_INNER(a, b)
+
+#if XPBD_PROFILING_ENABLED
+#define XPBD_PROFILE_ZONE(name) ::ScopedProfileZone XPBD_PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#else
+#define XPBD_PROFILE_ZONE(name) ((void)0)
+#endif
+
+#endif
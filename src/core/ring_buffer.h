@@ -0,0 +1,108 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 有界无锁环形队列（多生产者、多消费者），每个槽位带序号，生产者和消费者各自用 CAS 抢占位置
+// 队列满时 tryPush 立即返回 false，不会阻塞调用线程
+// capacity 会向上取整为 2 的幂
+template <typename T>
+class RingBuffer
+{
+    public:
+        explicit RingBuffer(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity) size <<= 1;
+            mask = size - 1;
+            slots = std::vector<Slot>(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            head.store(0, std::memory_order_relaxed);
+            tail.store(0, std::memory_order_relaxed);
+        }
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        size_t capacity() const { return mask + 1; }
+
+        bool tryPush(const T& value)
+        {
+            size_t position = tail.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Slot& slot = slots[position & mask];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (diff == 0)
+                {
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        slot.value = value;
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false; // 队列已满
+                }
+                else
+                {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool tryPop(T& value)
+        {
+            size_t position = head.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Slot& slot = slots[position & mask];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+                if (diff == 0)
+                {
+                    if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        value = slot.value;
+                        slot.sequence.store(position + mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false; // 队列为空
+                }
+                else
+                {
+                    position = head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            T value;
+
+            Slot() : sequence(0) {}
+            Slot(const Slot& other) : sequence(other.sequence.load()), value(other.value) {}
+        };
+
+        std::vector<Slot> slots;
+        size_t mask;
+        // 生产者和消费者的位置放在不同缓存行上，避免伪共享
+        alignas(64) std::atomic<size_t> tail;
+        alignas(64) std::atomic<size_t> head;
+};
+
+#endif
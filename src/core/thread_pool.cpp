@@ -0,0 +1,109 @@
+#include "core/thread_pool.h"
+#include "core/profiler.h"
+#include <algorithm>
+#include <chrono>
+
+ThreadPool::ThreadPool(size_t threadCount, int spinCount)
+    : spinCount(spinCount), currentTask(nullptr), taskCount(0), batchSize(1), nextBegin(0), activeWorkers(0), generation(0), stopping(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    // 调用线程也参与计算，因此只需要 threadCount - 1 个工作线程
+    for (size_t i = 1; i < threadCount; ++i)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wakeUp.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t)>& task, size_t minBatchSize)
+{
+    if (count == 0) return;
+    if (workers.empty() || count <= minBatchSize)
+    {
+        task(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(callMutex);
+
+    // 每个线程大约分到 4 块，兼顾负载均衡和领取开销
+    size_t batches = getThreadCount() * 4;
+    currentTask = &task;
+    taskCount = count;
+    batchSize = std::max(minBatchSize, (count + batches - 1) / batches);
+    nextBegin.store(0, std::memory_order_relaxed);
+    activeWorkers.store(workers.size(), std::memory_order_relaxed);
+    {
+        // 在锁内发布，保证正在进入休眠的线程不会错过唤醒
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wakeUp.notify_all();
+
+    runBatches();
+    while (activeWorkers.load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+    currentTask = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned long seenGeneration = 0;
+    while (true)
+    {
+        // 先自旋等待新任务（覆盖同一时间步内相邻两次 parallelFor 的间隔），超时后休眠
+        int spins = 0;
+        while (generation.load(std::memory_order_acquire) == seenGeneration && !stopping.load(std::memory_order_relaxed))
+        {
+            if (++spins < spinCount)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeUp.wait_for(lock, std::chrono::milliseconds(10), [&] {
+                return stopping.load() || generation.load() != seenGeneration;
+            });
+        }
+        if (stopping.load()) return;
+        seenGeneration = generation.load(std::memory_order_acquire);
+
+        runBatches();
+        activeWorkers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void ThreadPool::runBatches()
+{
+    while (true)
+    {
+        size_t begin = nextBegin.fetch_add(batchSize, std::memory_order_relaxed);
+        if (begin >= taskCount) return;
+        size_t end = std::min(taskCount, begin + batchSize);
+        XPBD_PROFILE_ZONE("ThreadPool::batch");
+        (*currentTask)(begin, end);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的线程池，只提供阻塞式的 parallelFor
+// 求解器每个子步要按颜色发起很多次很小的并行任务，因此工作线程先自旋等待新任务，
+// 长时间空闲后才进入休眠；任务块通过原子计数领取
+// 调用线程同样参与计算，threadCount 为参与计算的线程总数（含调用线程）
+// 多个仿真可以共用一个线程池（如 shared()），不同线程同时调用 parallelFor 时依次执行
+class ThreadPool
+{
+    public:
+        // 工作线程空闲时先让出时间片的次数，之后进入休眠
+        static constexpr int DefaultSpinCount = 2000;
+
+        // threadCount 为 0 时取硬件线程数
+        explicit ThreadPool(size_t threadCount = 0, int spinCount = DefaultSpinCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t getThreadCount() const { return workers.size() + 1; }
+        int getSpinCount() const { return spinCount; }
+
+        // 进程内共用的线程池，线程数取硬件线程数，第一次调用时创建
+        static ThreadPool& shared();
+
+        // 把 [0, count) 切成若干块并行执行 task(begin, end)，全部完成后返回
+        // count 不超过 minBatchSize 时直接在调用线程上执行，避免小任务的同步开销
+        // 不可重入：task 内部不能再调用同一线程池的 parallelFor
+        void parallelFor(size_t count, const std::function<void(size_t, size_t)>& task, size_t minBatchSize = 64);
+
+    private:
+        std::vector<std::thread> workers;
+        const int spinCount;
+        std::mutex callMutex;   // 同一时间只有一个调用者的任务在执行
+
+        // 当前任务，由 generation 的递增发布给工作线程
+        const std::function<void(size_t, size_t)>* currentTask;
+        size_t taskCount;
+        size_t batchSize;
+        std::atomic<size_t> nextBegin;
+        std::atomic<size_t> activeWorkers;   // 尚未完成当前任务的工作线程数
+        std::atomic<unsigned long> generation;
+        std::atomic<bool> stopping;
+
+        // 仅用于唤醒休眠中的工作线程
+        std::mutex sleepMutex;
+        std::condition_variable wakeUp;
+
+        void workerLoop();
+        // 领取并执行当前任务的剩余块，直到取完
+        void runBatches();
+};
+
+#endif
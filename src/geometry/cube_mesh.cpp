@@ -1,4 +1,4 @@
-#include "render/cube_mesh.h"
+#include "geometry/cube_mesh.h"
 
 CubeMesh::CubeMesh(float length, float width, float height) : Mesh()
 {
@@ -61,17 +61,5 @@ CubeMesh::CubeMesh(float length, float width, float height) : Mesh()
     addFace(3, 2, 6, 7, tempNormals[4]); // 上
     addFace(4, 5, 1, 0, tempNormals[5]); // 下
 
-    // 构建 vertexData
-    vertexData.clear();
-    for (size_t i = 0; i < positions.size(); ++i) 
-    {
-        vertexData.push_back(positions[i].x);
-        vertexData.push_back(positions[i].y);
-        vertexData.push_back(positions[i].z);
-        vertexData.push_back(normals[i].x);
-        vertexData.push_back(normals[i].y);
-        vertexData.push_back(normals[i].z);
-    }
-    vertexDataSize = vertexData.size();
-    indexCount = indices.size();
+    computeBounds();
 }
\ No newline at end of file
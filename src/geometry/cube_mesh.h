@@ -1,7 +1,7 @@
 #ifndef CUBE_MESH_H
 #define CUBE_MESH_H
 
-#include "mesh.h"
+#include "geometry/mesh.h"
 
 class CubeMesh : public Mesh 
 {
@@ -0,0 +1,108 @@
+#include "geometry/geometry_util.h"
+#include <algorithm>
+
+glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c,
+                                 TriangleFeature& feature, glm::vec3& barycentric)
+{
+    const glm::vec3 ab = b - a;
+    const glm::vec3 ac = c - a;
+    const glm::vec3 ap = p - a;
+    const float d1 = glm::dot(ab, ap);
+    const float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+    {
+        feature = TriangleFeatureVertexA;
+        barycentric = glm::vec3(1.0f, 0.0f, 0.0f);
+        return a;
+    }
+
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp);
+    const float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+    {
+        feature = TriangleFeatureVertexB;
+        barycentric = glm::vec3(0.0f, 1.0f, 0.0f);
+        return b;
+    }
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        const float t = d1 / (d1 - d3);
+        feature = TriangleFeatureEdgeAB;
+        barycentric = glm::vec3(1.0f - t, t, 0.0f);
+        return a + ab * t;
+    }
+
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp);
+    const float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+    {
+        feature = TriangleFeatureVertexC;
+        barycentric = glm::vec3(0.0f, 0.0f, 1.0f);
+        return c;
+    }
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        const float t = d2 / (d2 - d6);
+        feature = TriangleFeatureEdgeCA;
+        barycentric = glm::vec3(1.0f - t, 0.0f, t);
+        return a + ac * t;
+    }
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+        const float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        feature = TriangleFeatureEdgeBC;
+        barycentric = glm::vec3(0.0f, 1.0f - t, t);
+        return b + (c - b) * t;
+    }
+
+    const float denom = 1.0f / (va + vb + vc);
+    const float v = vb * denom;
+    const float w = vc * denom;
+    feature = TriangleFeatureFace;
+    barycentric = glm::vec3(1.0f - v - w, v, w);
+    return a + ab * v + ac * w;
+}
+
+glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    TriangleFeature feature;
+    glm::vec3 barycentric;
+    return closestPointOnTriangle(p, a, b, c, feature, barycentric);
+}
+
+std::vector<unsigned int> weldVertices(const std::vector<glm::vec3>& positions, float tolerance)
+{
+    // 按 x 排序后只需比较 x 相差不超过 tolerance 的顶点
+    const unsigned int count = static_cast<unsigned int>(positions.size());
+    std::vector<unsigned int> order(count);
+    for (unsigned int i = 0; i < count; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+        return positions[a].x < positions[b].x;
+    });
+
+    const unsigned int Unassigned = count;
+    std::vector<unsigned int> canonical(count, Unassigned);
+    for (unsigned int k = 0; k < count; ++k)
+    {
+        unsigned int i = order[k];
+        if (canonical[i] != Unassigned) continue;
+        canonical[i] = i;
+        for (unsigned int m = k + 1; m < count && positions[order[m]].x - positions[i].x <= tolerance; ++m)
+        {
+            unsigned int j = order[m];
+            if (canonical[j] == Unassigned && glm::length(positions[j] - positions[i]) <= tolerance)
+            {
+                canonical[j] = i;
+            }
+        }
+    }
+    return canonical;
+}
@@ -0,0 +1,29 @@
+#ifndef GEOMETRY_UTIL_H
+#define GEOMETRY_UTIL_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// 三角形上最近点所在的特征：面、三个顶点、三条边（ab、bc、ca）
+enum TriangleFeature
+{
+    TriangleFeatureFace,
+    TriangleFeatureVertexA,
+    TriangleFeatureVertexB,
+    TriangleFeatureVertexC,
+    TriangleFeatureEdgeAB,
+    TriangleFeatureEdgeBC,
+    TriangleFeatureEdgeCA
+};
+
+// 三角形 abc 上离 p 最近的点，按 Voronoi 区域分类（Ericson, Real-Time Collision Detection 5.1.5）
+// feature 为最近点所在的特征，barycentric 为最近点关于 a、b、c 的重心坐标
+glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c,
+                                 TriangleFeature& feature, glm::vec3& barycentric);
+glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+
+// 把相距不超过 tolerance 的顶点归并为一个，返回每个顶点归并到的顶点下标（该组中按 x 排序的第一个）
+// 网格在接缝和极点处会重复顶点，OBJ 加载后每个三角形各有一份顶点，且浮点误差下坐标未必完全相同
+std::vector<unsigned int> weldVertices(const std::vector<glm::vec3>& positions, float tolerance);
+
+#endif
@@ -0,0 +1,129 @@
+#include "geometry/mesh.h"
+#include "geometry/signed_distance_grid.h"
+#include "core/log.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+Mesh::Mesh(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+    const std::vector<unsigned int>& indices)
+: positions(positions), normals(normals), indices(indices) 
+{
+    computeBounds();
+}
+
+std::shared_ptr<const SignedDistanceGrid> Mesh::getSignedDistanceGrid() const
+{
+    std::shared_ptr<const SignedDistanceGrid> grid = std::atomic_load(&signedDistanceGrid);
+    if (!grid)
+    {
+        grid = std::make_shared<const SignedDistanceGrid>(*this);
+        std::shared_ptr<const SignedDistanceGrid> expected;
+        if (!std::atomic_compare_exchange_strong(&signedDistanceGrid, &expected, grid)) grid = expected;
+    }
+    return grid;
+}
+
+void Mesh::computeBounds()
+{
+    // 几何变化后距离场需要重新烘焙
+    std::atomic_store(&signedDistanceGrid, std::shared_ptr<const SignedDistanceGrid>());
+
+    if (positions.empty())
+    {
+        boundsMin = boundsMax = boundingCenter = glm::vec3(0.0f);
+        boundingRadius = 0.0f;
+        return;
+    }
+
+    boundsMin = boundsMax = positions[0];
+    for (const auto& position : positions)
+    {
+        boundsMin = glm::min(boundsMin, position);
+        boundsMax = glm::max(boundsMax, position);
+    }
+
+    // 球心取包围盒中心，半径取到最远顶点的距离；对对称网格即为最小包围球
+    boundingCenter = 0.5f * (boundsMin + boundsMax);
+    float radiusSquared = 0.0f;
+    for (const auto& position : positions)
+    {
+        glm::vec3 d = position - boundingCenter;
+        radiusSquared = std::max(radiusSquared, glm::dot(d, d));
+    }
+    boundingRadius = std::sqrt(radiusSquared);
+}
+
+bool Mesh::loadFromOBJ(const std::string& filename)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<glm::vec3> tempPositions;
+    std::vector<glm::vec3> tempNormals;
+    std::string line;
+
+    positions.clear();
+    normals.clear();
+    indices.clear();
+
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string type;
+        iss >> type;
+
+        if (type == "v") // 顶点
+        {
+            glm::vec3 pos;
+            iss >> pos.x >> pos.y >> pos.z;
+            tempPositions.push_back(pos);
+        }
+        else if (type == "vn") // 法线
+        {
+            glm::vec3 normal;
+            iss >> normal.x >> normal.y >> normal.z;
+            tempNormals.push_back(normal);
+        }
+        else if (type == "f") // 面
+        {
+            std::string v1, v2, v3;
+            iss >> v1 >> v2 >> v3;
+
+            // 解析每个顶点的索引（格式：vertex//normal）
+            unsigned int idx1, idx2, idx3;
+            unsigned int nidx1, nidx2, nidx3;
+
+            sscanf(v1.c_str(), "%u//%u", &idx1, &nidx1);
+            sscanf(v2.c_str(), "%u//%u", &idx2, &nidx2);
+            sscanf(v3.c_str(), "%u//%u", &idx3, &nidx3);
+
+            idx1--; idx2--; idx3--;
+            nidx1--; nidx2--; nidx3--;
+
+            positions.push_back(tempPositions[idx1]);
+            positions.push_back(tempPositions[idx2]);
+            positions.push_back(tempPositions[idx3]);
+            normals.push_back(tempNormals[nidx1]);
+            normals.push_back(tempNormals[nidx2]);
+            normals.push_back(tempNormals[nidx3]);
+
+            indices.push_back(positions.size() - 3);
+            indices.push_back(positions.size() - 2);
+            indices.push_back(positions.size() - 1);
+        }
+    }
+
+    file.close();
+    computeBounds();
+    XPBD_LOG_INFO(Geometry, "Loaded OBJ: %s with %zu vertices and %zu triangles.",
+                  filename.c_str(), positions.size(), indices.size() / 3);
+    return true;
+}
\ No newline at end of file
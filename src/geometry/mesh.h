@@ -0,0 +1,56 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <memory>
+
+class SignedDistanceGrid;
+
+// 纯几何网格数据（不依赖 OpenGL），物理模块和无窗口环境均可直接使用
+// GPU 资源由 render/gl_mesh.h 中的 GLMesh 单独管理
+class Mesh
+{
+    public:
+        Mesh() : boundsMin(0.0f), boundsMax(0.0f), boundingCenter(0.0f), boundingRadius(0.0f) {}
+        Mesh(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+            const std::vector<unsigned int>& indices);
+        virtual ~Mesh() {}
+
+        // 获取几何数据
+        int getIndexCount() const { return static_cast<int>(indices.size()); }
+        const std::vector<glm::vec3>& getPositions() const { return positions; }
+        const std::vector<glm::vec3>& getNormals() const { return normals; }
+        const std::vector<unsigned int>& getIndices() const { return indices; }
+        // 加载 OBJ 文件
+        bool loadFromOBJ(const std::string& filename);
+
+        // 局部坐标系下的包围体，在网格构建或加载时计算一次；没有顶点时均为 0
+        const glm::vec3& getLocalBoundsMin() const { return boundsMin; }
+        const glm::vec3& getLocalBoundsMax() const { return boundsMax; }
+        const glm::vec3& getBoundingSphereCenter() const { return boundingCenter; }
+        float getBoundingSphereRadius() const { return boundingRadius; }
+
+        // 局部坐标系下的有向距离场，第一次调用时由三角形烘焙，之后的查询与三角形数无关
+        // 多个线程同时第一次调用时可能各自烘焙一次，只保留其中一份；修改 positions 后由 computeBounds 作废
+        // 返回共享所有权：查询期间持有返回值，网格此时被重新加载也不会释放正在使用的距离场
+        std::shared_ptr<const SignedDistanceGrid> getSignedDistanceGrid() const;
+
+    protected:
+        std::vector<glm::vec3> positions; // 顶点位置
+        std::vector<glm::vec3> normals;   // 法线
+        std::vector<unsigned int> indices; // 索引
+
+        // 修改 positions 后调用，重新计算局部包围体
+        void computeBounds();
+
+    private:
+        glm::vec3 boundsMin;              // 局部包围盒
+        glm::vec3 boundsMax;
+        glm::vec3 boundingCenter;         // 包围球，球心取包围盒中心
+        float boundingRadius;
+        mutable std::shared_ptr<const SignedDistanceGrid> signedDistanceGrid;
+};
+
+#endif
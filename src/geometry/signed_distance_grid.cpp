@@ -0,0 +1,316 @@
+#include "geometry/signed_distance_grid.h"
+#include "geometry/mesh.h"
+#include "geometry/geometry_util.h"
+#include "core/log.h"
+#include "core/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace
+{
+    // 网格外扩的距离：包围盒最长边的一半再加两格，使相互接触的两个同等大小物体的中心都落在对方的网格内
+    const float PaddingRatio = 0.5f;
+    const int PaddingCells = 2;
+    // 三角形包围盒外扩该格数内的节点直接求精确距离，其余节点由扫描传播
+    const int ExactBandCells = 1;
+
+    struct Triangle
+    {
+        unsigned int vertices[3];   // 焊接后的顶点下标
+        glm::vec3 normal;           // 单位面法线，已统一为朝外
+        glm::vec3 edgeNormals[3];   // 边 ab、bc、ca 的伪法线：两侧面法线之和
+    };
+
+    float angleBetween(const glm::vec3& u, const glm::vec3& v)
+    {
+        float denom = glm::length(u) * glm::length(v);
+        if (denom <= 0.0f) return 0.0f;
+        return std::acos(glm::clamp(glm::dot(u, v) / denom, -1.0f, 1.0f));
+    }
+}
+
+SignedDistanceGrid::SignedDistanceGrid(const Mesh& mesh, int resolution)
+    : origin(0.0f), cellSize(0.0f), dimensions(0)
+{
+    XPBD_PROFILE_ZONE("SignedDistanceGrid::bake");
+    const std::vector<glm::vec3>& positions = mesh.getPositions();
+    const std::vector<unsigned int>& indices = mesh.getIndices();
+    if (positions.empty() || indices.size() < 3) return;
+
+    const glm::vec3& boundsMin = mesh.getLocalBoundsMin();
+    const glm::vec3& boundsMax = mesh.getLocalBoundsMax();
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const float maxExtent = std::max(std::max(std::max(extent.x, extent.y), extent.z), 1e-6f);
+
+    // 焊接顶点（否则顶点和边的伪法线只包含一侧的面），去掉退化三角形
+    std::vector<unsigned int> canonical = weldVertices(positions, 1e-5f * maxExtent);
+    std::vector<Triangle> triangles;
+    triangles.reserve(indices.size() / 3);
+    const float minArea = 1e-12f * maxExtent * maxExtent;
+    float signedVolume = 0.0f;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        Triangle triangle;
+        for (int corner = 0; corner < 3; ++corner) triangle.vertices[corner] = canonical[indices[t + corner]];
+        const glm::vec3& a = positions[triangle.vertices[0]];
+        const glm::vec3& b = positions[triangle.vertices[1]];
+        const glm::vec3& c = positions[triangle.vertices[2]];
+        glm::vec3 cross = glm::cross(b - a, c - a);
+        float area = glm::length(cross);
+        if (area <= minArea) continue;
+        triangle.normal = cross / area;
+        signedVolume += glm::dot(a, glm::cross(b, c));
+        triangles.push_back(triangle);
+    }
+    if (triangles.empty()) return;
+
+    // 伪法线要求面法线朝外；绕序一致但整体朝内时（有向体积为负）全部翻转
+    if (signedVolume < 0.0f)
+    {
+        for (Triangle& triangle : triangles)
+        {
+            std::swap(triangle.vertices[1], triangle.vertices[2]);
+            triangle.normal = -triangle.normal;
+        }
+    }
+
+    // 顶点伪法线：各相邻面法线按该面在此顶点的内角加权求和
+    std::vector<glm::vec3> vertexNormals(positions.size(), glm::vec3(0.0f));
+    // 边伪法线：按无向边排序后把共享同一条边的面法线相加
+    std::vector<std::pair<unsigned long long, unsigned int>> edges;
+    edges.reserve(triangles.size() * 3);
+    for (unsigned int t = 0; t < triangles.size(); ++t)
+    {
+        const Triangle& triangle = triangles[t];
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int v = triangle.vertices[corner];
+            unsigned int next = triangle.vertices[(corner + 1) % 3];
+            unsigned int prev = triangle.vertices[(corner + 2) % 3];
+            vertexNormals[v] += angleBetween(positions[next] - positions[v], positions[prev] - positions[v]) * triangle.normal;
+
+            unsigned long long low = std::min(v, next);
+            unsigned long long high = std::max(v, next);
+            edges.emplace_back((high << 32) | low, t * 3 + corner);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for (size_t begin = 0; begin < edges.size(); )
+    {
+        size_t end = begin;
+        glm::vec3 sum(0.0f);
+        while (end < edges.size() && edges[end].first == edges[begin].first)
+        {
+            sum += triangles[edges[end].second / 3].normal;
+            ++end;
+        }
+        for (size_t e = begin; e < end; ++e)
+        {
+            triangles[edges[e].second / 3].edgeNormals[edges[e].second % 3] = sum;
+        }
+        begin = end;
+    }
+
+    exactTriangles.resize(triangles.size());
+    for (size_t t = 0; t < triangles.size(); ++t)
+    {
+        const Triangle& triangle = triangles[t];
+        ExactTriangle& exact = exactTriangles[t];
+        exact.pseudoNormals[TriangleFeatureFace] = triangle.normal;
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            exact.corners[corner] = positions[triangle.vertices[corner]];
+            exact.pseudoNormals[TriangleFeatureVertexA + corner] = vertexNormals[triangle.vertices[corner]];
+            exact.pseudoNormals[TriangleFeatureEdgeAB + corner] = triangle.edgeNormals[corner];
+        }
+    }
+
+    // 网格覆盖包围盒向外扩展 PaddingRatio 倍最长边的范围
+    cellSize = maxExtent / static_cast<float>(std::max(resolution, 1));
+    const int padding = static_cast<int>(std::ceil(PaddingRatio * maxExtent / cellSize)) + PaddingCells;
+    origin = boundsMin - glm::vec3(padding * cellSize);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        dimensions[axis] = static_cast<int>(std::ceil(extent[axis] / cellSize)) + 2 * padding + 1;
+    }
+    const int nx = dimensions.x;
+    const int ny = dimensions.y;
+    const int nz = dimensions.z;
+    const size_t nodeCount = static_cast<size_t>(nx) * ny * nz;
+    auto nodeIndex = [&](int i, int j, int k) { return (static_cast<size_t>(k) * ny + j) * nx + i; };
+    auto nodePosition = [&](int i, int j, int k) { return origin + cellSize * glm::vec3(i, j, k); };
+
+    std::vector<float> distanceSq(nodeCount, std::numeric_limits<float>::max());
+    std::vector<int> closest(nodeCount, -1);
+    auto distanceSqTo = [&](const glm::vec3& p, int t) {
+        const Triangle& triangle = triangles[t];
+        glm::vec3 q = closestPointOnTriangle(p, positions[triangle.vertices[0]], positions[triangle.vertices[1]],
+                                             positions[triangle.vertices[2]]);
+        glm::vec3 d = p - q;
+        return glm::dot(d, d);
+    };
+
+    // 三角形附近的节点：直接求精确距离
+    for (int t = 0; t < static_cast<int>(triangles.size()); ++t)
+    {
+        const Triangle& triangle = triangles[t];
+        glm::vec3 lower = glm::min(glm::min(positions[triangle.vertices[0]], positions[triangle.vertices[1]]), positions[triangle.vertices[2]]);
+        glm::vec3 upper = glm::max(glm::max(positions[triangle.vertices[0]], positions[triangle.vertices[1]]), positions[triangle.vertices[2]]);
+        int first[3], last[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            first[axis] = std::max(static_cast<int>(std::floor((lower[axis] - origin[axis]) / cellSize)) - ExactBandCells, 0);
+            last[axis] = std::min(static_cast<int>(std::ceil((upper[axis] - origin[axis]) / cellSize)) + ExactBandCells,
+                                  dimensions[axis] - 1);
+        }
+        for (int k = first[2]; k <= last[2]; ++k)
+            for (int j = first[1]; j <= last[1]; ++j)
+                for (int i = first[0]; i <= last[0]; ++i)
+                {
+                    size_t node = nodeIndex(i, j, k);
+                    float d = distanceSqTo(nodePosition(i, j, k), t);
+                    if (d < distanceSq[node])
+                    {
+                        distanceSq[node] = d;
+                        closest[node] = t;
+                    }
+                }
+    }
+
+    // 沿 8 个方向扫描，每个节点检查上游 7 个邻居的最近三角形，取其中最近者（Bridson 的 makelevelset3）
+    auto sweep = [&](int di, int dj, int dk) {
+        int i0 = di > 0 ? 1 : nx - 2, i1 = di > 0 ? nx : -1;
+        int j0 = dj > 0 ? 1 : ny - 2, j1 = dj > 0 ? ny : -1;
+        int k0 = dk > 0 ? 1 : nz - 2, k1 = dk > 0 ? nz : -1;
+        const int offsets[7][3] = { { di, 0, 0 }, { 0, dj, 0 }, { 0, 0, dk }, { di, dj, 0 },
+                                    { di, 0, dk }, { 0, dj, dk }, { di, dj, dk } };
+        for (int k = k0; k != k1; k += dk)
+            for (int j = j0; j != j1; j += dj)
+                for (int i = i0; i != i1; i += di)
+                {
+                    size_t node = nodeIndex(i, j, k);
+                    glm::vec3 p = nodePosition(i, j, k);
+                    for (const auto& offset : offsets)
+                    {
+                        int t = closest[nodeIndex(i - offset[0], j - offset[1], k - offset[2])];
+                        if (t < 0 || t == closest[node]) continue;
+                        float d = distanceSqTo(p, t);
+                        if (d < distanceSq[node])
+                        {
+                            distanceSq[node] = d;
+                            closest[node] = t;
+                        }
+                    }
+                }
+    };
+    for (int dk = -1; dk <= 1; dk += 2)
+        for (int dj = -1; dj <= 1; dj += 2)
+            for (int di = -1; di <= 1; di += 2)
+                sweep(di, dj, dk);
+
+    // 符号：节点到最近点的向量与最近特征的伪法线同向为外部
+    values.resize(nodeCount);
+    for (int k = 0; k < nz; ++k)
+        for (int j = 0; j < ny; ++j)
+            for (int i = 0; i < nx; ++i)
+            {
+                size_t node = nodeIndex(i, j, k);
+                const ExactTriangle& triangle = exactTriangles[closest[node]];
+                glm::vec3 p = nodePosition(i, j, k);
+                TriangleFeature feature;
+                glm::vec3 barycentric;
+                glm::vec3 q = closestPointOnTriangle(p, triangle.corners[0], triangle.corners[1], triangle.corners[2],
+                                                     feature, barycentric);
+                float distance = glm::length(p - q);
+                values[node] = glm::dot(p - q, triangle.pseudoNormals[feature]) < 0.0f ? -distance : distance;
+            }
+
+    XPBD_LOG_DEBUG(Geometry, "Baked SDF grid: %d x %d x %d nodes from %zu triangles", nx, ny, nz, triangles.size());
+}
+
+float SignedDistanceGrid::sample(const glm::vec3& point, glm::vec3* gradient) const
+{
+    // 网格坐标
+    const glm::vec3 g = (point - origin) / cellSize;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (g[axis] < 0.0f || g[axis] > static_cast<float>(dimensions[axis] - 1))
+        {
+            return exactDistance(point, gradient);
+        }
+    }
+
+    int base[3];
+    glm::vec3 f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        base[axis] = std::min(static_cast<int>(g[axis]), dimensions[axis] - 2);
+        f[axis] = g[axis] - static_cast<float>(base[axis]);
+    }
+
+    const float c000 = value(base[0], base[1], base[2]);
+    const float c100 = value(base[0] + 1, base[1], base[2]);
+    const float c010 = value(base[0], base[1] + 1, base[2]);
+    const float c110 = value(base[0] + 1, base[1] + 1, base[2]);
+    const float c001 = value(base[0], base[1], base[2] + 1);
+    const float c101 = value(base[0] + 1, base[1], base[2] + 1);
+    const float c011 = value(base[0], base[1] + 1, base[2] + 1);
+    const float c111 = value(base[0] + 1, base[1] + 1, base[2] + 1);
+
+    // 先沿 x 插值，再沿 y、z
+    const float c00 = c000 + (c100 - c000) * f.x;
+    const float c10 = c010 + (c110 - c010) * f.x;
+    const float c01 = c001 + (c101 - c001) * f.x;
+    const float c11 = c011 + (c111 - c011) * f.x;
+    const float c0 = c00 + (c10 - c00) * f.y;
+    const float c1 = c01 + (c11 - c01) * f.y;
+
+    if (gradient)
+    {
+        // 三线性函数对 f 的偏导，再除以格宽换算到局部坐标
+        const float dx0 = (c100 - c000) + ((c110 - c010) - (c100 - c000)) * f.y;
+        const float dx1 = (c101 - c001) + ((c111 - c011) - (c101 - c001)) * f.y;
+        const float dy0 = c10 - c00;
+        const float dy1 = c11 - c01;
+        *gradient = glm::vec3((dx0 + (dx1 - dx0) * f.z) / cellSize,
+                              (dy0 + (dy1 - dy0) * f.z) / cellSize,
+                              (c1 - c0) / cellSize);
+    }
+    return c0 + (c1 - c0) * f.z;
+}
+
+float SignedDistanceGrid::exactDistance(const glm::vec3& point, glm::vec3* gradient) const
+{
+    if (exactTriangles.empty())
+    {
+        if (gradient) *gradient = glm::vec3(0.0f);
+        return std::numeric_limits<float>::max();
+    }
+
+    float minDistanceSq = std::numeric_limits<float>::max();
+    glm::vec3 closest = point;
+    const ExactTriangle* closestTriangle = nullptr;
+    TriangleFeature closestFeature = TriangleFeatureFace;
+    for (const ExactTriangle& triangle : exactTriangles)
+    {
+        TriangleFeature feature;
+        glm::vec3 barycentric;
+        glm::vec3 q = closestPointOnTriangle(point, triangle.corners[0], triangle.corners[1], triangle.corners[2],
+                                             feature, barycentric);
+        glm::vec3 d = point - q;
+        float distanceSq = glm::dot(d, d);
+        if (distanceSq < minDistanceSq)
+        {
+            minDistanceSq = distanceSq;
+            closest = q;
+            closestTriangle = &triangle;
+            closestFeature = feature;
+        }
+    }
+    float distance = std::sqrt(minDistanceSq);
+    float sign = glm::dot(point - closest, closestTriangle->pseudoNormals[closestFeature]) < 0.0f ? -1.0f : 1.0f;
+    if (gradient) *gradient = distance > 0.0f ? sign * (point - closest) / distance : glm::vec3(0.0f);
+    return sign * distance;
+}
@@ -0,0 +1,52 @@
+#ifndef SIGNED_DISTANCE_GRID_H
+#define SIGNED_DISTANCE_GRID_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+class Mesh;
+
+// 网格局部坐标系下的有向距离场（外正内负），在包围盒外扩一圈的规则网格节点上烘焙一次，
+// 网格内的查询三线性插值，代价与三角形数无关
+// 烘焙：三角形附近的节点直接求到三角形的精确距离，其余节点沿网格扫描传播最近三角形再求精确距离；
+// 符号由最近点所在特征（面、边、顶点）的角度加权伪法线判断，要求网格封闭，绕序一致（朝内朝外均可）
+class SignedDistanceGrid
+{
+    public:
+        // 网格包围盒最长边上的格数
+        static constexpr int DefaultResolution = 16;
+
+        explicit SignedDistanceGrid(const Mesh& mesh, int resolution = DefaultResolution);
+
+        // 没有三角形时为空，调用者应改用其它方式求距离
+        bool empty() const { return values.empty(); }
+
+        // point 处的有向距离，gradient 非空时给出插值函数的解析梯度（未归一化）
+        // 网格外的点（小物体查询远处大物体的中心时常见）逐个三角形求精确距离，代价与三角形数成正比
+        float sample(const glm::vec3& point, glm::vec3* gradient = nullptr) const;
+        // point 处的精确有向距离：逐个三角形求最近点，符号与烘焙时一样由最近特征的伪法线判断，代价与三角形数成正比
+        // gradient 非空时给出单位梯度
+        float exactDistance(const glm::vec3& point, glm::vec3* gradient = nullptr) const;
+
+        const glm::vec3& getOrigin() const { return origin; }
+        float getCellSize() const { return cellSize; }
+        const glm::ivec3& getDimensions() const { return dimensions; }
+
+    private:
+        glm::vec3 origin;        // 第 (0, 0, 0) 个节点的位置
+        float cellSize;
+        glm::ivec3 dimensions;   // 各轴节点数
+        std::vector<float> values;  // 节点上的有向距离，x 变化最快
+
+        // 焊接后的非退化三角形，伪法线按 TriangleFeature 的顺序排列（面、三个顶点、三条边），面法线已统一为朝外
+        struct ExactTriangle
+        {
+            glm::vec3 corners[3];
+            glm::vec3 pseudoNormals[7];
+        };
+        std::vector<ExactTriangle> exactTriangles;
+
+        float value(int i, int j, int k) const { return values[(k * dimensions.y + j) * dimensions.x + i]; }
+};
+
+#endif
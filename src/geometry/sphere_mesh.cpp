@@ -1,4 +1,4 @@
-#include "render/sphere_mesh.h"
+#include "geometry/sphere_mesh.h"
 #include <iostream>
 
 SphereMesh::SphereMesh(float radius, int sectors, int stacks) : Mesh()
@@ -48,16 +48,5 @@ SphereMesh::SphereMesh(float radius, int sectors, int stacks) : Mesh()
         }
     }
 
-    // 构建 vertexData
-    vertexData.clear();
-    for (size_t i = 0; i < positions.size(); ++i) {
-        vertexData.push_back(positions[i].x);
-        vertexData.push_back(positions[i].y);
-        vertexData.push_back(positions[i].z);
-        vertexData.push_back(normals[i].x);
-        vertexData.push_back(normals[i].y);
-        vertexData.push_back(normals[i].z);
-    }
-    vertexDataSize = vertexData.size();
-    indexCount = indices.size();
+    computeBounds();
 }
\ No newline at end of file
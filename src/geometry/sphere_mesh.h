@@ -1,7 +1,7 @@
 #ifndef SPHERE_MESH_H
 #define SPHERE_MESH_H
 
-#include "mesh.h"
+#include "geometry/mesh.h"
 
 class SphereMesh : public Mesh
 {
@@ -0,0 +1,79 @@
+#include <glm/glm.hpp>
+#include "physics/xpbd.h"
+#include "physics/entity.h"
+#include "geometry/sphere_mesh.h"
+#include "geometry/cube_mesh.h"
+#include "core/profiler.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// 无窗口运行入口：不创建 OpenGL 上下文，按最快速度推进仿真并统计每步耗时
+// 用法：XPBD_EXP_headless [步数] [trace.json]
+// 给出第二个参数时开启分阶段计时，并导出 Chrome trace_event JSON（可用 Perfetto 打开）
+int main(int argc, char** argv)
+{
+    int stepCount = 1000;
+    const char* tracePath = (argc > 2) ? argv[2] : nullptr;
+    if (argc > 1)
+    {
+        stepCount = std::atoi(argv[1]);
+        if (stepCount <= 0)
+        {
+            std::cerr << "Invalid step count: " << argv[1] << std::endl;
+            return -1;
+        }
+    }
+
+    XPBDSystem xpbdSystem;
+
+    // 与 main.cpp 相同的场景：两个球体 + 地面
+    SphereMesh* sphereMesh1 = new SphereMesh(0.1f, 50, 50);
+    SphereMesh* sphereMesh2 = new SphereMesh(0.1f, 50, 50);
+    CubeMesh* groundMesh = new CubeMesh(2.0f, 2.0f, 0.05f);
+
+    Entity* sphereEntity1 = new Entity(sphereMesh1, glm::vec3(0.0f, 0.1f, 0.0f), 1.0f);
+    Entity* sphereEntity2 = new Entity(sphereMesh2, glm::vec3(0.15f, 5.0f, 0.0f), 1.0f);
+    Entity* groundEntity = new Entity(groundMesh, glm::vec3(0.0f, -0.1f, 0.0f), 0); // 质量 0 表示固定
+    // 从高处落下的球速度较大，开启连续碰撞检测
+    sphereEntity2->setCCDEnabled(true);
+
+    xpbdSystem.addObject(sphereEntity1);
+    xpbdSystem.addObject(sphereEntity2);
+    xpbdSystem.addObject(groundEntity);
+
+    xpbdSystem.initialize();
+
+    Profiler::instance().setEnabled(tracePath != nullptr);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < stepCount; ++i)
+    {
+        xpbdSystem.run();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "Headless run: " << stepCount << " steps in " << totalMs << " ms ("
+              << totalMs / stepCount << " ms/step)" << std::endl;
+
+    if (tracePath != nullptr)
+    {
+        Profiler::instance().setEnabled(false);
+        if (Profiler::instance().exportChromeTrace(tracePath))
+        {
+            std::cout << "Trace written to " << tracePath << " (" << Profiler::instance().getZoneCount() << " zones)" << std::endl;
+        }
+        else
+        {
+            std::cerr << "Failed to write trace: " << tracePath << std::endl;
+        }
+    }
+
+    delete sphereEntity1;
+    delete sphereEntity2;
+    delete groundEntity;
+    delete sphereMesh1;
+    delete sphereMesh2;
+    delete groundMesh;
+    return 0;
+}
@@ -4,8 +4,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "physics/xpbd.h"
 #include "render/mesh_renderer.h"
-#include "render/sphere_mesh.h"
-#include "render/cube_mesh.h"
+#include "geometry/sphere_mesh.h"
+#include "geometry/cube_mesh.h"
 #include "physics/entity.h"
 #include <cstdlib>
 #include <iostream>
@@ -60,23 +60,22 @@ int main()
     SphereMesh* sphereMesh1 = new SphereMesh(0.1f, 50, 50);
     std::cout << "SphereMesh1 created with " << sphereMesh1->getPositions().size() << " vertices, "
               << sphereMesh1->getIndices().size() << " indices" << std::endl;
-    sphereMesh1->initialize();
 
     SphereMesh* sphereMesh2 = new SphereMesh(0.1f, 50, 50);
     std::cout << "SphereMesh2 created with " << sphereMesh2->getPositions().size() << " vertices, "
               << sphereMesh2->getIndices().size() << " indices" << std::endl;
-    sphereMesh2->initialize();
 
     // === 创建地面 Mesh ===
     CubeMesh* groundMesh = new CubeMesh(2.0f, 2.0f, 0.05f); // 长 2.0，宽 2.0，高 0.05
     std::cout << "GroundMesh created with " << groundMesh->getPositions().size() << " vertices, "
               << groundMesh->getIndices().size() << " indices" << std::endl;
-    groundMesh->initialize();
 
     // 创建 Entity 对象
     Entity* sphereEntity1 = new Entity(sphereMesh1, glm::vec3(0.0f, 0.1f, 0.0f), 1.0f);
     Entity* sphereEntity2 = new Entity(sphereMesh2, glm::vec3(0.15f, 5.0f, 0.0f), 1.0f);
     Entity* groundEntity = new Entity(groundMesh, glm::vec3(0.0f, -0.1f, 0.0f), 0); // 质量 0 表示固定
+    // 从高处落下的球速度较大，开启连续碰撞检测
+    sphereEntity2->setCCDEnabled(true);
 
     // 添加到 XPBDSystem
     xpbdSystem.addObject(sphereEntity1);
@@ -90,8 +89,14 @@ int main()
     glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
     glm::vec3 viewPos(0.0f, 0.0f, 2.0f);
 
+    double lastTime = glfwGetTime();
     while (!glfwWindowShouldClose(window))
     {
+        // 按实际经过的时间推进物理，渲染帧率不再影响模拟速度
+        double currentTime = glfwGetTime();
+        xpbdSystem.step(static_cast<float>(currentTime - lastTime));
+        lastTime = currentTime;
+
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -108,12 +113,14 @@ int main()
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
             glUseProgram(0);
 
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), objects[i]->getPosition());
+            // 在上一步与当前步之间插值，避免物理步长与帧率不一致造成的抖动
+            glm::vec3 position = xpbdSystem.getInterpolatedPosition(objects[i]);
+            glm::quat rotation = xpbdSystem.getInterpolatedRotation(objects[i]);
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
             glm::mat4 mvp = projection * view * model;
-            renderer.render(objects[i]->getMesh(), mvp, lightPos, viewPos, objects[i]->getPosition(), objects[i]->getRotation());
+            renderer.render(objects[i]->getMesh(), mvp, lightPos, viewPos, position, rotation);
         }
 
-        xpbdSystem.run();
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
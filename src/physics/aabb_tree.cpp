@@ -0,0 +1,438 @@
+#include "physics/aabb_tree.h"
+#include "core/log.h"
+#include "core/profiler.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    // 并行重建时每个线程大约分到的子树数，子树越多负载越均衡
+    const size_t BuildTasksPerThread = 4;
+    // 小于该大小的树直接串行构建
+    const uint32_t MinParallelBuildSize = 4096;
+}
+
+AABBTree::AABBTree() : root(AABBNode::NullNode), freeList(AABBNode::NullNode), leafCount(0)
+{
+}
+
+uint32_t AABBTree::allocateNode()
+{
+    uint32_t node;
+    if (freeList != AABBNode::NullNode)
+    {
+        node = freeList;
+        freeList = nodes[node].parent;
+    }
+    else
+    {
+        // 注意：扩容会使已有的 AABBNode 引用失效，调用方分配节点后需重新取引用
+        node = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    AABBNode& allocated = nodes[node];
+    allocated.left = AABBNode::NullNode;
+    allocated.right = AABBNode::NullNode;
+    allocated.parent = AABBNode::NullNode;
+    allocated.height = 0;
+    return node;
+}
+
+void AABBTree::freeNode(uint32_t node)
+{
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+uint32_t AABBTree::createLeaf(const AABB& fatAABB, uint32_t userData)
+{
+    uint32_t leaf = allocateNode();
+    nodes[leaf].aabb = fatAABB;
+    nodes[leaf].right = userData;
+    ++leafCount;
+    return leaf;
+}
+
+void AABBTree::refitNode(uint32_t node)
+{
+    AABBNode& current = nodes[node];
+    const AABBNode& left = nodes[current.left];
+    const AABBNode& right = nodes[current.right];
+    current.aabb = mergeAABB(left.aabb, right.aabb);
+    current.height = 1 + std::max(left.height, right.height);
+}
+
+uint32_t AABBTree::findBestSibling(const AABB& aabb)
+{
+    // 以 S 为兄弟的代价 = area(S ∪ L) + 所有祖先因包含 L 而增加的面积（继承代价）
+    // S 子树中任何节点的代价下界为 area(L) + S 及其祖先的继承代价，超过当前最优即剪枝
+    const float leafArea = surfaceArea(aabb);
+    uint32_t best = root;
+    float bestCost = surfaceArea(mergeAABB(nodes[root].aabb, aabb));
+
+    siblingStack.clear();
+    siblingStack.emplace_back(root, 0.0f);
+    while (!siblingStack.empty())
+    {
+        uint32_t index = siblingStack.back().first;
+        float inheritedCost = siblingStack.back().second;
+        siblingStack.pop_back();
+        const AABBNode& current = nodes[index];
+
+        float mergedArea = surfaceArea(mergeAABB(current.aabb, aabb));
+        float cost = mergedArea + inheritedCost;
+        if (cost < bestCost)
+        {
+            best = index;
+            bestCost = cost;
+        }
+        if (current.isLeaf()) continue;
+
+        float childInheritedCost = inheritedCost + mergedArea - surfaceArea(current.aabb);
+        if (leafArea + childInheritedCost < bestCost)
+        {
+            siblingStack.emplace_back(current.left, childInheritedCost);
+            siblingStack.emplace_back(current.right, childInheritedCost);
+        }
+    }
+    return best;
+}
+
+void AABBTree::swapNodes(uint32_t a, uint32_t b)
+{
+    uint32_t parentA = nodes[a].parent;
+    uint32_t parentB = nodes[b].parent;
+    if (nodes[parentA].left == a) nodes[parentA].left = b; else nodes[parentA].right = b;
+    if (nodes[parentB].left == b) nodes[parentB].left = a; else nodes[parentB].right = a;
+    nodes[a].parent = parentB;
+    nodes[b].parent = parentA;
+}
+
+bool AABBTree::rotate(uint32_t node)
+{
+    // 节点 A 的子节点为 B、C，孙节点为 B 的 D、E 和 C 的 F、G
+    // 候选：子节点与对侧孙节点交换（B<->F/G，C<->D/E），或两侧孙节点交换（D<->F/G）
+    // A 的包围盒不变，只比较 B、C 两个内部节点表面积之和的变化
+    if (nodes[node].isLeaf()) return false;
+    const uint32_t b = nodes[node].left;
+    const uint32_t c = nodes[node].right;
+    const AABBNode& nodeB = nodes[b];
+    const AABBNode& nodeC = nodes[c];
+    if (nodeB.isLeaf() && nodeC.isLeaf()) return false;
+
+    const float areaB = surfaceArea(nodeB.aabb);
+    const float areaC = surfaceArea(nodeC.aabb);
+    float bestDelta = 0.0f;
+    uint32_t swapA = AABBNode::NullNode;
+    uint32_t swapB = AABBNode::NullNode;
+
+    auto consider = [&](float delta, uint32_t x, uint32_t y)
+    {
+        if (delta < bestDelta)
+        {
+            bestDelta = delta;
+            swapA = x;
+            swapB = y;
+        }
+    };
+
+    if (!nodeC.isLeaf())
+    {
+        // B 与 C 的某个子节点交换后，C 变为 B ∪ 另一个子节点
+        consider(surfaceArea(mergeAABB(nodeB.aabb, nodes[nodeC.right].aabb)) - areaC, b, nodeC.left);
+        consider(surfaceArea(mergeAABB(nodeB.aabb, nodes[nodeC.left].aabb)) - areaC, b, nodeC.right);
+    }
+    if (!nodeB.isLeaf())
+    {
+        consider(surfaceArea(mergeAABB(nodeC.aabb, nodes[nodeB.right].aabb)) - areaB, c, nodeB.left);
+        consider(surfaceArea(mergeAABB(nodeC.aabb, nodes[nodeB.left].aabb)) - areaB, c, nodeB.right);
+    }
+    if (!nodeB.isLeaf() && !nodeC.isLeaf())
+    {
+        const AABB& d = nodes[nodeB.left].aabb;
+        const AABB& e = nodes[nodeB.right].aabb;
+        const AABB& f = nodes[nodeC.left].aabb;
+        const AABB& g = nodes[nodeC.right].aabb;
+        // D<->F 后 B = F ∪ E，C = D ∪ G；D<->G 后 B = G ∪ E，C = F ∪ D
+        consider(surfaceArea(mergeAABB(f, e)) + surfaceArea(mergeAABB(d, g)) - areaB - areaC, nodeB.left, nodeC.left);
+        consider(surfaceArea(mergeAABB(g, e)) + surfaceArea(mergeAABB(f, d)) - areaB - areaC, nodeB.left, nodeC.right);
+    }
+
+    if (swapA == AABBNode::NullNode) return false;
+
+    swapNodes(swapA, swapB);
+    if (!nodes[b].isLeaf()) refitNode(b);
+    if (!nodes[c].isLeaf()) refitNode(c);
+    refitNode(node);
+    return true;
+}
+
+void AABBTree::insertLeaf(uint32_t leaf)
+{
+    if (root == AABBNode::NullNode)
+    {
+        root = leaf;
+        nodes[leaf].parent = AABBNode::NullNode;
+        return;
+    }
+
+    uint32_t sibling = findBestSibling(nodes[leaf].aabb);
+    uint32_t oldParent = nodes[sibling].parent;
+
+    uint32_t newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    if (oldParent != AABBNode::NullNode)
+    {
+        if (nodes[oldParent].left == sibling) nodes[oldParent].left = newParent; else nodes[oldParent].right = newParent;
+    }
+    else
+    {
+        root = newParent;
+    }
+
+    // 自底向上重新计算包围盒，并在每个祖先处尝试旋转
+    for (uint32_t current = newParent; current != AABBNode::NullNode; current = nodes[current].parent)
+    {
+        refitNode(current);
+        rotate(current);
+    }
+}
+
+void AABBTree::removeLeaf(uint32_t leaf)
+{
+    if (leaf == root)
+    {
+        root = AABBNode::NullNode;
+        return;
+    }
+
+    // 用兄弟节点顶替父节点，父节点归还节点池
+    uint32_t parent = nodes[leaf].parent;
+    uint32_t sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+    uint32_t grandParent = nodes[parent].parent;
+    nodes[sibling].parent = grandParent;
+    if (grandParent != AABBNode::NullNode)
+    {
+        if (nodes[grandParent].left == parent) nodes[grandParent].left = sibling; else nodes[grandParent].right = sibling;
+        for (uint32_t current = grandParent; current != AABBNode::NullNode; current = nodes[current].parent)
+        {
+            refitNode(current);
+            rotate(current);
+        }
+    }
+    else
+    {
+        root = sibling;
+    }
+    nodes[leaf].parent = AABBNode::NullNode;
+    freeNode(parent);
+}
+
+void AABBTree::rebuild(ThreadPool* threadPool)
+{
+    XPBD_PROFILE_ZONE("AABBTree::rebuild");
+
+    // 节点池整体重排：前 count 个为叶节点（保持原来的相对顺序），之后 count - 1 个为内部节点
+    // 区间 [b, e) 的子树占用从 firstSlot 开始的 e - b - 1 个内部节点：根为 firstSlot，
+    // 左子树 [b, m) 从 firstSlot + 1 开始，右子树 [m, e) 从 firstSlot + m - b 开始，各子树可以互不干扰地并行构建
+    std::vector<AABBNode> leaves;
+    leaves.reserve(leafCount);
+    for (const AABBNode& node : nodes)
+    {
+        if (node.height != 0 || !node.isLeaf()) continue;
+        leaves.push_back(node);
+        leaves.back().parent = AABBNode::NullNode;
+    }
+    const uint32_t count = static_cast<uint32_t>(leaves.size());
+    nodes.swap(leaves);
+    freeList = AABBNode::NullNode;
+    root = AABBNode::NullNode;
+    if (count == 0) return;
+    nodes.resize(2 * static_cast<size_t>(count) - 1);
+
+    buildLeaves.resize(count);
+    buildCenters.resize(count);
+    for (uint32_t leaf = 0; leaf < count; ++leaf)
+    {
+        buildLeaves[leaf] = leaf;
+        buildCenters[leaf] = 0.5f * (nodes[leaf].aabb.min + nodes[leaf].aabb.max);
+    }
+
+    // 上层串行划分，足够小的子树推迟到线程池上并行构建
+    uint32_t taskSize = 0;
+    if (threadPool && threadPool->getThreadCount() > 1 && count >= MinParallelBuildSize)
+    {
+        taskSize = std::max<uint32_t>(1, count / static_cast<uint32_t>(threadPool->getThreadCount() * BuildTasksPerThread));
+    }
+    buildTasks.clear();
+    buildTopNodes.clear();
+    root = buildRange(0, count, count, AABBNode::NullNode, taskSize);
+
+    if (!buildTasks.empty())
+    {
+        threadPool->parallelFor(buildTasks.size(), [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const BuildTask& task = buildTasks[i];
+                buildRange(task.begin, task.end, task.firstSlot, task.parent, 0);
+            }
+        }, 1);
+        // 子树完成后计算上层节点的包围盒，buildTopNodes 为后序，子节点总在父节点之前
+        for (uint32_t node : buildTopNodes)
+        {
+            refitNode(node);
+        }
+    }
+    XPBD_LOG_DEBUG(BroadPhase, "Rebuilt tree: %u leaves, height %d, %zu parallel subtrees", count, getHeight(), buildTasks.size());
+}
+
+uint32_t AABBTree::buildRange(uint32_t begin, uint32_t end, uint32_t firstSlot, uint32_t parent, uint32_t taskSize)
+{
+    if (end - begin == 1)
+    {
+        const uint32_t leaf = buildLeaves[begin];
+        nodes[leaf].parent = parent;
+        return leaf;
+    }
+
+    const uint32_t node = firstSlot;
+    if (taskSize > 0 && end - begin <= taskSize)
+    {
+        buildTasks.push_back(BuildTask{ begin, end, firstSlot, parent });
+        return node;
+    }
+
+    const uint32_t middle = splitRange(begin, end);
+    nodes[node].parent = parent;
+    nodes[node].left = buildRange(begin, middle, firstSlot + 1, node, taskSize);
+    nodes[node].right = buildRange(middle, end, firstSlot + (middle - begin), node, taskSize);
+    if (taskSize > 0)
+    {
+        // 子树可能尚未构建，包围盒留到并行阶段结束后计算
+        buildTopNodes.push_back(node);
+    }
+    else
+    {
+        refitNode(node);
+    }
+    return node;
+}
+
+uint32_t AABBTree::splitRange(uint32_t begin, uint32_t end)
+{
+    const uint32_t middle = begin + (end - begin) / 2;
+    glm::vec3 centerMin = buildCenters[buildLeaves[begin]];
+    glm::vec3 centerMax = centerMin;
+    for (uint32_t i = begin + 1; i < end; ++i)
+    {
+        centerMin = glm::min(centerMin, buildCenters[buildLeaves[i]]);
+        centerMax = glm::max(centerMax, buildCenters[buildLeaves[i]]);
+    }
+    const glm::vec3 extent = centerMax - centerMin;
+
+    // 按中心把叶节点分入每条轴上的 BinCount 个箱，统计每箱的数量和包围盒
+    struct Bin
+    {
+        AABB aabb;
+        uint32_t count;
+    };
+    Bin bins[3][BinCount];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (Bin& bin : bins[axis])
+        {
+            bin.aabb.min = glm::vec3(std::numeric_limits<float>::max());
+            bin.aabb.max = glm::vec3(-std::numeric_limits<float>::max());
+            bin.count = 0;
+        }
+    }
+    glm::vec3 binScale(0.0f);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (extent[axis] > 0.0f) binScale[axis] = BinCount * 0.9999f / extent[axis];
+    }
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const uint32_t leaf = buildLeaves[i];
+        const glm::vec3& center = buildCenters[leaf];
+        const AABB& aabb = nodes[leaf].aabb;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            Bin& bin = bins[axis][static_cast<int>((center[axis] - centerMin[axis]) * binScale[axis])];
+            bin.aabb = mergeAABB(bin.aabb, aabb);
+            ++bin.count;
+        }
+    }
+
+    // 在每个箱边界处划分的代价 = 左侧面积 × 左侧数量 + 右侧面积 × 右侧数量，先从右向左累积右侧
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (extent[axis] <= 0.0f) continue;
+        float rightCost[BinCount];
+        AABB accumulated = bins[axis][BinCount - 1].aabb;
+        uint32_t accumulatedCount = bins[axis][BinCount - 1].count;
+        for (int split = BinCount - 1; split > 0; --split)
+        {
+            accumulated = mergeAABB(accumulated, bins[axis][split].aabb);
+            if (split < BinCount - 1) accumulatedCount += bins[axis][split].count;
+            rightCost[split] = accumulatedCount > 0 ? surfaceArea(accumulated) * accumulatedCount : 0.0f;
+        }
+        accumulated = bins[axis][0].aabb;
+        accumulatedCount = 0;
+        for (int split = 1; split < BinCount; ++split)
+        {
+            accumulated = mergeAABB(accumulated, bins[axis][split - 1].aabb);
+            accumulatedCount += bins[axis][split - 1].count;
+            if (accumulatedCount == 0 || accumulatedCount == end - begin) continue;
+            float cost = surfaceArea(accumulated) * accumulatedCount + rightCost[split];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    // 所有中心重合时没有有效的划分，按下标平分
+    if (bestAxis < 0) return middle;
+
+    const float origin = centerMin[bestAxis];
+    const float scale = binScale[bestAxis];
+    auto first = buildLeaves.begin() + begin;
+    auto last = buildLeaves.begin() + end;
+    auto split = std::partition(first, last, [&](uint32_t leaf)
+    {
+        return static_cast<int>((buildCenters[leaf][bestAxis] - origin) * scale) < bestSplit;
+    });
+    return static_cast<uint32_t>(split - buildLeaves.begin());
+}
+
+void AABBTree::printNode(uint32_t node, int depth) const
+{
+    if (node == AABBNode::NullNode) return;
+
+    // 打印节点信息（按深度缩进）
+    const AABBNode& current = nodes[node];
+    XPBD_LOG_TRACE(BroadPhase, "%*sNode: %u, UserData: %d, isLeaf: %s, AABB: (%g, %g, %g) - (%g, %g, %g)",
+                   depth * 2, "", node, current.isLeaf() ? static_cast<int>(current.right) : -1, current.isLeaf() ? "true" : "false",
+                   current.aabb.min.x, current.aabb.min.y, current.aabb.min.z,
+                   current.aabb.max.x, current.aabb.max.y, current.aabb.max.z);
+
+    // 递归打印子节点
+    if (!current.isLeaf())
+    {
+        printNode(current.left, depth + 1);
+        printNode(current.right, depth + 1);
+    }
+}
@@ -0,0 +1,304 @@
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "physics/broad_phase.h"
+
+class ThreadPool;
+
+// 树节点存放在连续数组中，以 32 位下标互相引用；只保留遍历需要的字段（40 字节）
+struct AABBNode {
+    static constexpr uint32_t NullNode = 0xffffffffu;
+
+    AABB aabb;        // 叶节点为外扩后的胖包围盒，内部节点为子节点的并集
+    uint32_t left;    // 叶节点为 NullNode
+    uint32_t right;   // 叶节点存调用者的数据（如 proxy 下标）
+    uint32_t parent;  // 空闲节点复用为空闲链表的下一个节点
+    int32_t height;   // 叶节点为 0，空闲节点为 -1
+
+    bool isLeaf() const { return left == NullNode; }
+};
+
+// 包围盒层次树：增量插入时用 SAH 分支限界选择兄弟节点并沿途旋转，批量构建时按分箱 SAH 自顶向下划分
+// 只管理节点和包围盒，叶节点通过 userData 对应调用者的对象
+class AABBTree
+{
+    public:
+        AABBTree();
+
+        // 分配叶节点但不入树，返回叶节点下标
+        uint32_t createLeaf(const AABB& fatAABB, uint32_t userData);
+        void insertLeaf(uint32_t leaf);
+        void removeLeaf(uint32_t leaf);
+        bool isInTree(uint32_t leaf) const { return nodes[leaf].parent != AABBNode::NullNode || root == leaf; }
+        const AABB& getFatAABB(uint32_t leaf) const { return nodes[leaf].aabb; }
+        // 只能在叶节点不在树中时修改
+        void setFatAABB(uint32_t leaf, const AABB& aabb) { nodes[leaf].aabb = aabb; }
+        uint32_t getUserData(uint32_t leaf) const { return nodes[leaf].right; }
+
+        // 用所有叶节点（包括尚未入树的）重建整棵树，上层串行划分，子树在线程池上并行构建
+        // 叶节点按原下标顺序重新编号为 [0, getLeafCount())，调用者需用 getUserData 更新自己保存的下标
+        void rebuild(ThreadPool* threadPool);
+        uint32_t getLeafCount() const { return leafCount; }
+        int getHeight() const { return root != AABBNode::NullNode ? nodes[root].height : 0; }
+        bool isEmpty() const { return root == AABBNode::NullNode; }
+        // 分箱 SAH 每条轴的箱数
+        static constexpr int BinCount = 16;
+
+        // 对与 aabb 相交的每个叶节点调用 callback(leaf)
+        template <typename Callback>
+        void query(const AABB& aabb, Callback&& callback) const;
+        // 树内所有胖包围盒相交的叶节点对调用 callback(leafA, leafB)，每对只调用一次
+        template <typename Callback>
+        void querySelf(Callback&& callback) const;
+        // 与另一棵树之间所有胖包围盒相交的叶节点对调用 callback(本树叶节点, other 的叶节点)
+        template <typename Callback>
+        void queryTree(const AABBTree& other, Callback&& callback) const;
+
+        // 射线遍历的栈元素：节点及射线进入其包围盒的距离
+        struct RayStackEntry
+        {
+            uint32_t node;
+            float entry;
+        };
+        // 从 origin 沿单位向量 direction 在 [0, maxDistance] 内遍历，按板块法测试包围盒，先访问较近的子节点
+        // 对射线穿过的叶节点调用 callback(leaf, maxDistance)，返回值作为新的 maxDistance：
+        // 原样返回则继续查找全部叶节点，返回命中距离则只剩更近的叶节点，返回负值立即结束
+        // stack 由调用者提供，不同线程使用各自的栈时可以并发调用
+        template <typename Callback>
+        void rayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+            std::vector<RayStackEntry>& stack, Callback&& callback) const;
+        // 射线与包围盒相交时返回 true，entry 为进入距离（起点在盒内时为 0）
+        static bool rayAABB(const AABB& aabb, const glm::vec3& origin, const glm::vec3& invDirection,
+            float maxDistance, float& entry)
+        {
+            glm::vec3 t1 = (aabb.min - origin) * invDirection;
+            glm::vec3 t2 = (aabb.max - origin) * invDirection;
+            glm::vec3 tNear = glm::min(t1, t2);
+            glm::vec3 tFar = glm::max(t1, t2);
+            float tMin = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+            float tMax = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+            entry = tMin;
+            return tMin <= tMax;
+        }
+
+        static AABB mergeAABB(const AABB& aabb1, const AABB& aabb2)
+        {
+            AABB result;
+            result.min = glm::min(aabb1.min, aabb2.min);
+            result.max = glm::max(aabb1.max, aabb2.max);
+            return result;
+        }
+        // 表面积的一半，SAH 只比较相对大小
+        static float surfaceArea(const AABB& aabb)
+        {
+            glm::vec3 d = aabb.max - aabb.min;
+            return d.x * d.y + d.y * d.z + d.z * d.x;
+        }
+
+        void printTree() const { printNode(root, 0); }
+
+    private:
+        std::vector<AABBNode> nodes;              // 节点池，释放的节点进入空闲链表，不归还内存
+        uint32_t root;
+        uint32_t freeList;
+        uint32_t leafCount;
+        // 遍历时复用的栈，query 系列函数因此不可并发调用
+        mutable std::vector<uint32_t> queryStack;
+        mutable std::vector<std::pair<uint32_t, uint32_t>> pairStack;
+        // 插入时寻找兄弟节点的栈：节点下标及其继承代价
+        std::vector<std::pair<uint32_t, float>> siblingStack;
+
+        // 重建的临时数据：叶节点下标按划分结果排列，centers 按叶节点下标存放胖包围盒中心
+        struct BuildTask
+        {
+            uint32_t begin;
+            uint32_t end;
+            uint32_t firstSlot;
+            uint32_t parent;
+        };
+        std::vector<uint32_t> buildLeaves;
+        std::vector<glm::vec3> buildCenters;
+        std::vector<BuildTask> buildTasks;        // 推迟到线程池上并行构建的子树
+        std::vector<uint32_t> buildTopNodes;      // 串行阶段创建的内部节点，后序排列
+
+        uint32_t allocateNode();
+        void freeNode(uint32_t node);
+        // SAH 分支限界：返回使插入后树的总表面积增量最小的兄弟节点
+        uint32_t findBestSibling(const AABB& aabb);
+        // 在 node 的子节点与孙节点之间尝试交换，若能减小表面积则执行，返回是否旋转
+        bool rotate(uint32_t node);
+        void swapNodes(uint32_t a, uint32_t b);
+        void refitNode(uint32_t node);
+        // 用 firstSlot 起的内部节点构建 buildLeaves[begin, end) 的子树并返回根节点
+        // taskSize > 0 时不超过该大小的子树推迟到 buildTasks
+        uint32_t buildRange(uint32_t begin, uint32_t end, uint32_t firstSlot, uint32_t parent, uint32_t taskSize);
+        // 分箱 SAH 选择划分轴和位置，重排 buildLeaves[begin, end) 并返回右半部分的起点
+        uint32_t splitRange(uint32_t begin, uint32_t end);
+
+        void printNode(uint32_t node, int depth) const;
+};
+
+template <typename Callback>
+void AABBTree::query(const AABB& aabb, Callback&& callback) const
+{
+    if (root == AABBNode::NullNode) return;
+
+    queryStack.clear();
+    queryStack.push_back(root);
+    while (!queryStack.empty())
+    {
+        const AABBNode& node = nodes[queryStack.back()];
+        const uint32_t index = queryStack.back();
+        queryStack.pop_back();
+        if (!BroadPhase::checkAABBCollision(node.aabb, aabb)) continue;
+
+        if (node.isLeaf())
+        {
+            callback(index);
+            continue;
+        }
+        queryStack.push_back(node.left);
+        queryStack.push_back(node.right);
+    }
+}
+
+template <typename Callback>
+void AABBTree::querySelf(Callback&& callback) const
+{
+    if (root == AABBNode::NullNode) return;
+
+    // (A, A) 只展开为 (L, L)、(R, R)、(L, R)，不产生 (R, L)，因此每对叶节点只访问一次
+    pairStack.clear();
+    pairStack.emplace_back(root, root);
+    while (!pairStack.empty())
+    {
+        const uint32_t a = pairStack.back().first;
+        const uint32_t b = pairStack.back().second;
+        pairStack.pop_back();
+        const AABBNode& nodeA = nodes[a];
+        const AABBNode& nodeB = nodes[b];
+
+        if (a == b)
+        {
+            if (nodeA.isLeaf()) continue;
+            pairStack.emplace_back(nodeA.left, nodeA.left);
+            pairStack.emplace_back(nodeA.right, nodeA.right);
+            pairStack.emplace_back(nodeA.left, nodeA.right);
+            continue;
+        }
+        if (!BroadPhase::checkAABBCollision(nodeA.aabb, nodeB.aabb)) continue;
+
+        if (nodeA.isLeaf() && nodeB.isLeaf())
+        {
+            callback(a, b);
+        }
+        else if (nodeB.isLeaf() || (!nodeA.isLeaf() && surfaceArea(nodeA.aabb) >= surfaceArea(nodeB.aabb)))
+        {
+            // 展开较大的一侧
+            pairStack.emplace_back(nodeA.left, b);
+            pairStack.emplace_back(nodeA.right, b);
+        }
+        else
+        {
+            pairStack.emplace_back(a, nodeB.left);
+            pairStack.emplace_back(a, nodeB.right);
+        }
+    }
+}
+
+template <typename Callback>
+void AABBTree::queryTree(const AABBTree& other, Callback&& callback) const
+{
+    if (root == AABBNode::NullNode || other.root == AABBNode::NullNode) return;
+
+    // 两棵树的节点不同，pair 的两侧分别是本树和 other 的下标
+    pairStack.clear();
+    pairStack.emplace_back(root, other.root);
+    while (!pairStack.empty())
+    {
+        const uint32_t a = pairStack.back().first;
+        const uint32_t b = pairStack.back().second;
+        pairStack.pop_back();
+        const AABBNode& nodeA = nodes[a];
+        const AABBNode& nodeB = other.nodes[b];
+        if (!BroadPhase::checkAABBCollision(nodeA.aabb, nodeB.aabb)) continue;
+
+        if (nodeA.isLeaf() && nodeB.isLeaf())
+        {
+            callback(a, b);
+        }
+        else if (nodeB.isLeaf() || (!nodeA.isLeaf() && surfaceArea(nodeA.aabb) >= surfaceArea(nodeB.aabb)))
+        {
+            pairStack.emplace_back(nodeA.left, b);
+            pairStack.emplace_back(nodeA.right, b);
+        }
+        else
+        {
+            pairStack.emplace_back(a, nodeB.left);
+            pairStack.emplace_back(a, nodeB.right);
+        }
+    }
+}
+
+template <typename Callback>
+void AABBTree::rayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+    std::vector<RayStackEntry>& stack, Callback&& callback) const
+{
+    if (root == AABBNode::NullNode) return;
+
+    // 方向分量为 0 时倒数为无穷大，板块测试仍然成立
+    const glm::vec3 invDirection = 1.0f / direction;
+    float entry;
+    if (!rayAABB(nodes[root].aabb, origin, invDirection, maxDistance, entry)) return;
+
+    stack.clear();
+    stack.push_back({ root, entry });
+    while (!stack.empty())
+    {
+        const RayStackEntry top = stack.back();
+        stack.pop_back();
+        // maxDistance 可能在入栈后被回调缩短
+        if (top.entry > maxDistance) continue;
+
+        const AABBNode& node = nodes[top.node];
+        if (node.isLeaf())
+        {
+            maxDistance = callback(top.node, maxDistance);
+            if (maxDistance < 0.0f) return;
+            continue;
+        }
+
+        float entryLeft, entryRight;
+        const bool hitLeft = rayAABB(nodes[node.left].aabb, origin, invDirection, maxDistance, entryLeft);
+        const bool hitRight = rayAABB(nodes[node.right].aabb, origin, invDirection, maxDistance, entryRight);
+        // 较远的子节点先入栈，较近的先出栈
+        if (hitLeft && hitRight)
+        {
+            if (entryLeft <= entryRight)
+            {
+                stack.push_back({ node.right, entryRight });
+                stack.push_back({ node.left, entryLeft });
+            }
+            else
+            {
+                stack.push_back({ node.left, entryLeft });
+                stack.push_back({ node.right, entryRight });
+            }
+        }
+        else if (hitLeft)
+        {
+            stack.push_back({ node.left, entryLeft });
+        }
+        else if (hitRight)
+        {
+            stack.push_back({ node.right, entryRight });
+        }
+    }
+}
+
+#endif
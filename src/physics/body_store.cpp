@@ -0,0 +1,129 @@
+#include "physics/body_store.h"
+
+void BodyStore::reserve(uint32_t count)
+{
+    positions.reserve(count);
+    linearVelocities.reserve(count);
+    angularVelocities.reserve(count);
+    rotations.reserve(count);
+    inverseMasses.reserve(count);
+    inverseInertiaRefs.reserve(count);
+    masses.reserve(count);
+    inertiaRefs.reserve(count);
+    forces.reserve(count);
+    torques.reserve(count);
+    fixedFlags.reserve(count);
+    ccdFlags.reserve(count);
+    sleepingFlags.reserve(count);
+    sleepTimers.reserve(count);
+    awakeBodies.reserve(count);
+    awakeSlots.reserve(count);
+}
+
+uint32_t BodyStore::addBody(const glm::vec3& position, float mass)
+{
+    uint32_t index = size();
+    positions.push_back(position);
+    linearVelocities.push_back(glm::vec3(0.0f));
+    angularVelocities.push_back(glm::vec3(0.0f));
+    rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    inverseMasses.push_back(mass == 0.0f ? 0.0f : 1.0f / mass);
+    inverseInertiaRefs.push_back(glm::mat3(0.0f));
+    masses.push_back(mass);
+    inertiaRefs.push_back(glm::mat3(0.0f));
+    forces.push_back(glm::vec3(0.0f));
+    torques.push_back(glm::vec3(0.0f));
+    fixedFlags.push_back(0);
+    ccdFlags.push_back(0);
+    sleepingFlags.push_back(0);
+    sleepTimers.push_back(0.0f);
+    awakeSlots.push_back(static_cast<uint32_t>(awakeBodies.size()));
+    awakeBodies.push_back(index);
+    updateInverseMass(index);
+    return index;
+}
+
+uint32_t BodyStore::copyBody(const BodyStore& other, uint32_t index)
+{
+    uint32_t newIndex = size();
+    positions.push_back(other.positions[index]);
+    linearVelocities.push_back(other.linearVelocities[index]);
+    angularVelocities.push_back(other.angularVelocities[index]);
+    rotations.push_back(other.rotations[index]);
+    inverseMasses.push_back(other.inverseMasses[index]);
+    inverseInertiaRefs.push_back(other.inverseInertiaRefs[index]);
+    masses.push_back(other.masses[index]);
+    inertiaRefs.push_back(other.inertiaRefs[index]);
+    forces.push_back(other.forces[index]);
+    torques.push_back(other.torques[index]);
+    fixedFlags.push_back(other.fixedFlags[index]);
+    ccdFlags.push_back(other.ccdFlags[index]);
+    sleepingFlags.push_back(other.sleepingFlags[index]);
+    sleepTimers.push_back(other.sleepTimers[index]);
+    awakeSlots.push_back(static_cast<uint32_t>(awakeBodies.size()));
+    if (!isSleeping(newIndex)) awakeBodies.push_back(newIndex);
+    return newIndex;
+}
+
+void BodyStore::setMass(uint32_t index, float mass)
+{
+    masses[index] = mass;
+    updateInverseMass(index);
+}
+
+void BodyStore::setFixed(uint32_t index, bool fixed)
+{
+    fixedFlags[index] = fixed ? 1 : 0;
+    updateInverseMass(index);
+}
+
+void BodyStore::setInertiaRef(uint32_t index, const glm::mat3& inertia)
+{
+    inertiaRefs[index] = inertia;
+    updateInverseMass(index);
+}
+
+void BodyStore::sleep(uint32_t index)
+{
+    if (!isSleeping(index))
+    {
+        // 与末尾交换后弹出
+        uint32_t slot = awakeSlots[index];
+        uint32_t last = awakeBodies.back();
+        awakeBodies[slot] = last;
+        awakeSlots[last] = slot;
+        awakeBodies.pop_back();
+    }
+    sleepingFlags[index] = 1;
+    linearVelocities[index] = glm::vec3(0.0f);
+    angularVelocities[index] = glm::vec3(0.0f);
+}
+
+void BodyStore::wakeUp(uint32_t index)
+{
+    if (isSleeping(index))
+    {
+        awakeSlots[index] = static_cast<uint32_t>(awakeBodies.size());
+        awakeBodies.push_back(index);
+    }
+    sleepingFlags[index] = 0;
+    sleepTimers[index] = 0.0f;
+}
+
+void BodyStore::updateInverseMass(uint32_t index)
+{
+    // 固定物体和质量为 0 的物体（如地面）不参与动力学，逆质量和逆惯量都为 0
+    bool isStatic = fixedFlags[index] || masses[index] == 0.0f;
+    if (isStatic != (inverseMasses[index] == 0.0f)) ++staticVersion;
+    inverseMasses[index] = isStatic ? 0.0f : 1.0f / masses[index];
+
+    const glm::mat3& inertia = inertiaRefs[index];
+    float det = glm::determinant(inertia);
+    inverseInertiaRefs[index] = (isStatic || det == 0.0f) ? glm::mat3(0.0f) : glm::inverse(inertia);
+}
+
+glm::mat3 BodyStore::getWorldInverseInertia(uint32_t index) const
+{
+    glm::mat3 R = glm::mat3_cast(rotations[index]);
+    return R * inverseInertiaRefs[index] * glm::transpose(R);
+}
@@ -0,0 +1,64 @@
+#ifndef BODY_STORE_H
+#define BODY_STORE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+#include <cstdint>
+
+// 刚体状态的结构化数组（SoA）存储
+// 每个字段一条连续数组，积分、重力、阻尼等循环按下标线性扫描；
+// Entity 只保存指向这里的下标（见 entity.h）
+struct BodyStore
+{
+    // 热数据：每个子步都会读写
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> linearVelocities;
+    std::vector<glm::vec3> angularVelocities;
+    std::vector<glm::quat> rotations;
+    std::vector<float> inverseMasses;             // 固定物体和质量为 0 的物体为 0
+    std::vector<glm::mat3> inverseInertiaRefs;    // 局部坐标系下的惯量矩阵逆
+
+    // 冷数据：只在初始化或外部接口中访问
+    std::vector<float> masses;
+    std::vector<glm::mat3> inertiaRefs;           // 局部坐标系下的惯量矩阵
+    std::vector<glm::vec3> forces;
+    std::vector<glm::vec3> torques;
+    std::vector<uint8_t> fixedFlags;
+    std::vector<uint8_t> ccdFlags;                // 快速刚体：与其他刚体的接触按连续碰撞检测生成
+
+    // 休眠状态：睡眠中的刚体不积分、不更新包围盒、不做窄相检测
+    std::vector<uint8_t> sleepingFlags;
+    std::vector<float> sleepTimers;               // 速度持续低于阈值的时间（秒）
+    std::vector<uint32_t> awakeBodies;            // 未休眠刚体（含静态刚体）的下标，顺序不定，由 sleep/wakeUp 增量维护
+    std::vector<uint32_t> awakeSlots;             // 刚体在 awakeBodies 中的位置，休眠时无意义
+
+    // 已有刚体的逆质量在 0 与非 0 之间切换（固定/解除固定、质量设为 0 或从 0 改回）的次数；
+    // 约束着色不把静态刚体计入冲突，据此判断是否需要重新着色
+    uint32_t staticVersion = 0;
+
+    uint32_t size() const { return static_cast<uint32_t>(positions.size()); }
+    void reserve(uint32_t count);
+
+    // 添加一个静止刚体，返回其下标
+    uint32_t addBody(const glm::vec3& position, float mass);
+    // 从另一个存储中拷贝一个刚体的全部状态，返回新下标
+    uint32_t copyBody(const BodyStore& other, uint32_t index);
+
+    void setMass(uint32_t index, float mass);
+    void setFixed(uint32_t index, bool fixed);
+    void setInertiaRef(uint32_t index, const glm::mat3& inertia);
+
+    bool isSleeping(uint32_t index) const { return sleepingFlags[index] != 0; }
+    // 进入休眠时速度清零；唤醒时重新开始计时
+    void sleep(uint32_t index);
+    void wakeUp(uint32_t index);
+
+    // 世界坐标系下的惯量矩阵逆：R * I_ref^-1 * R^T
+    glm::mat3 getWorldInverseInertia(uint32_t index) const;
+
+    private:
+        void updateInverseMass(uint32_t index);
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include "physics/broad_phase.h"
+#include "core/log.h"
+
+AABB BroadPhase::computeAABB(const Entity* entity)
+{
+    AABB aabb;
+    const Mesh* mesh = entity->getMesh();
+    if (mesh->getPositions().empty())
+    {
+        // 如果没有顶点数据，返回一个默认的AABB（以position为中心，尺寸为0.1 * 0.1 * 0.1）
+        glm::vec3 defaultSize(0.05f, 0.05f, 0.05f);
+        aabb.min = entity->getPosition() - defaultSize;
+        aabb.max = entity->getPosition() + defaultSize;
+        return aabb;
+    }
+
+    // 由网格缓存的局部包围盒直接得到世界包围盒，与顶点数无关：
+    // 中心按位姿变换，半边长取旋转矩阵各元素的绝对值与局部半边长之积（包围旋转后的局部盒）
+    glm::vec3 localCenter = 0.5f * (mesh->getLocalBoundsMin() + mesh->getLocalBoundsMax());
+    glm::vec3 localExtent = 0.5f * (mesh->getLocalBoundsMax() - mesh->getLocalBoundsMin());
+    glm::mat3 R = glm::mat3_cast(entity->getRotation());
+    glm::vec3 center = R * localCenter + entity->getPosition();
+    glm::vec3 extent = glm::abs(R[0]) * localExtent.x + glm::abs(R[1]) * localExtent.y + glm::abs(R[2]) * localExtent.z;
+    aabb.min = center - extent;
+    aabb.max = center + extent;
+
+    XPBD_LOG_TRACE(BroadPhase, "Entity: %p, AABB: (%g, %g) - (%g, %g)", (const void*)entity, aabb.min.x, aabb.min.y, aabb.max.x, aabb.max.y);
+
+    return aabb;
+}
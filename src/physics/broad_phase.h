@@ -0,0 +1,42 @@
+#ifndef BROAD_PHASE_H
+#define BROAD_PHASE_H
+
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+#include "physics/entity.h"
+
+class ThreadPool;
+
+struct AABB
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// 宽相的公共接口，XPBDSystem 通过它使用不同的实现（AABB 树、扫掠剪枝等）
+class BroadPhase
+{
+    public:
+        virtual ~BroadPhase() {}
+
+        virtual void addObject(Entity* entity) = 0;
+        // predictionTime > 0 时，包围盒沿速度方向扩展以覆盖该时间内的运动（推测式接触）
+        // margin 为各方向额外的外扩量，用于覆盖重力等未计入速度的位移和接触余量
+        virtual void update(float predictionTime = 0.0f, float margin = 0.0f) = 0;
+        // 输出包围盒相交的实体对，每对只出现一次，插入较早的实体在前
+        virtual void collectCollisionPairs(std::vector<std::pair<Entity*, Entity*>>& pairs) = 0;
+        // 可并行的实现在该线程池上执行，nullptr 表示在调用线程上串行执行
+        virtual void setThreadPool(ThreadPool*) {}
+
+        // 实体网格在当前位姿下的世界包围盒，由网格的局部包围盒在 O(1) 内得到（旋转时比逐顶点变换略松）
+        static AABB computeAABB(const Entity* entity);
+        static bool checkAABBCollision(const AABB& aabb1, const AABB& aabb2)
+        {
+            return (aabb1.min.x <= aabb2.max.x && aabb1.max.x >= aabb2.min.x) &&
+                   (aabb1.min.y <= aabb2.max.y && aabb1.max.y >= aabb2.min.y) &&
+                   (aabb1.min.z <= aabb2.max.z && aabb1.max.z >= aabb2.min.z);
+        }
+};
+
+#endif
@@ -1,7 +1,17 @@
 #include "physics/collider.h"
+#include "geometry/geometry_util.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <new>
+#include <utility>
+
+namespace
+{
+    // 线性扫描时同时维护的最大值个数，各路互不依赖，编译器可将其映射到向量寄存器
+    const unsigned int SupportScanLanes = 8;
+}
 
 Collider::Collider() : type(COLLIDER_TYPE_SPHERE)
 {
@@ -17,39 +27,214 @@ Collider::Collider(float radius) : type(COLLIDER_TYPE_SPHERE)
 
 Collider::Collider(const std::vector<glm::vec3>& vertices, const std::vector<std::vector<unsigned int>>& faces) : type(COLLIDER_TYPE_CONVEX_HULL)
 {
+    // 联合体成员不会自动构造，需要显式构造凸包数据
+    new (&convexHull) ColliderConvexHull();
     convexHull.vertices = vertices;
     convexHull.faces = faces;
+    buildConvexHullAdjacency();
+}
+
+void Collider::buildConvexHullAdjacency()
+{
+    const std::vector<glm::vec3>& vertices = convexHull.vertices;
+    const unsigned int count = static_cast<unsigned int>(vertices.size());
+
+    convexHull.xs.resize(count);
+    convexHull.ys.resize(count);
+    convexHull.zs.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        convexHull.xs[i] = vertices[i].x;
+        convexHull.ys[i] = vertices[i].y;
+        convexHull.zs[i] = vertices[i].z;
+    }
+
+    convexHull.adjacencyOffsets.clear();
+    convexHull.adjacency.clear();
+    if (convexHull.faces.empty()) return;
+
+    // 网格在接缝和极点处会重复顶点，否则爬山会被接缝截断；距离小于包围盒尺寸 1e-5 倍的顶点归并为一个
+    glm::vec3 lower = vertices.empty() ? glm::vec3(0.0f) : vertices[0];
+    glm::vec3 upper = lower;
+    for (const auto& vertex : vertices)
+    {
+        lower = glm::min(lower, vertex);
+        upper = glm::max(upper, vertex);
+    }
+    const glm::vec3 extent = upper - lower;
+    const std::vector<unsigned int> canonical = weldVertices(vertices, 1e-5f * std::max(std::max(extent.x, extent.y), extent.z));
+
+    // 每个面的相邻顶点构成一条边
+    std::vector<std::pair<unsigned int, unsigned int>> edges;
+    for (const auto& face : convexHull.faces)
+    {
+        for (size_t k = 0; k < face.size(); ++k)
+        {
+            unsigned int u = face[k];
+            unsigned int v = face[(k + 1) % face.size()];
+            if (u >= count || v >= count) continue;
+            u = canonical[u];
+            v = canonical[v];
+            if (u == v) continue;
+            edges.emplace_back(u, v);
+            edges.emplace_back(v, u);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // 先按归并后的顶点建 CSR，再展开到每个顶点
+    std::vector<unsigned int> begin(count + 1, 0);
+    for (const auto& edge : edges) ++begin[edge.first + 1];
+    for (unsigned int i = 0; i < count; ++i) begin[i + 1] += begin[i];
+
+    convexHull.adjacencyOffsets.resize(count + 1);
+    convexHull.adjacencyOffsets[0] = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int c = canonical[i];
+        convexHull.adjacencyOffsets[i + 1] = convexHull.adjacencyOffsets[i] + (begin[c + 1] - begin[c]);
+    }
+    convexHull.adjacency.reserve(convexHull.adjacencyOffsets[count]);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int c = canonical[i];
+        for (unsigned int e = begin[c]; e < begin[c + 1]; ++e)
+        {
+            convexHull.adjacency.push_back(edges[e].second);
+        }
+    }
+}
+
+unsigned int Collider::linearSupportIndex(const glm::vec3& direction) const
+{
+    const unsigned int count = static_cast<unsigned int>(convexHull.xs.size());
+    const float* xs = convexHull.xs.data();
+    const float* ys = convexHull.ys.data();
+    const float* zs = convexHull.zs.data();
+
+    // 分 SupportScanLanes 路各自求最大值，最后再合并
+    float best[SupportScanLanes];
+    unsigned int bestIndex[SupportScanLanes];
+    for (unsigned int lane = 0; lane < SupportScanLanes; ++lane)
+    {
+        best[lane] = -std::numeric_limits<float>::infinity();
+        bestIndex[lane] = 0;
+    }
+
+    unsigned int i = 0;
+    for (; i + SupportScanLanes <= count; i += SupportScanLanes)
+    {
+        for (unsigned int lane = 0; lane < SupportScanLanes; ++lane)
+        {
+            float dot = xs[i + lane] * direction.x + ys[i + lane] * direction.y + zs[i + lane] * direction.z;
+            bool greater = dot > best[lane];
+            best[lane] = greater ? dot : best[lane];
+            bestIndex[lane] = greater ? i + lane : bestIndex[lane];
+        }
+    }
+    for (unsigned int lane = 0; i < count; ++i, ++lane)
+    {
+        float dot = xs[i] * direction.x + ys[i] * direction.y + zs[i] * direction.z;
+        if (dot > best[lane])
+        {
+            best[lane] = dot;
+            bestIndex[lane] = i;
+        }
+    }
+
+    // 点乘相等时取下标较小者，与逐个扫描的结果一致
+    unsigned int result = bestIndex[0];
+    float maxDot = best[0];
+    for (unsigned int lane = 1; lane < SupportScanLanes; ++lane)
+    {
+        if (best[lane] > maxDot || (best[lane] == maxDot && bestIndex[lane] < result))
+        {
+            maxDot = best[lane];
+            result = bestIndex[lane];
+        }
+    }
+    return result;
+}
+
+unsigned int Collider::hillClimbSupportIndex(const glm::vec3& direction, unsigned int start) const
+{
+    // 凸多面体上点乘的局部最大值就是全局最大值，每步移到点乘最大的邻居，严格增大时才移动，保证终止
+    const std::vector<glm::vec3>& vertices = convexHull.vertices;
+    const unsigned int* offsets = convexHull.adjacencyOffsets.data();
+    const unsigned int* adjacency = convexHull.adjacency.data();
+
+    unsigned int current = start;
+    float currentDot = glm::dot(vertices[current], direction);
+    for (;;)
+    {
+        unsigned int next = current;
+        for (unsigned int e = offsets[current]; e < offsets[current + 1]; ++e)
+        {
+            float dot = glm::dot(vertices[adjacency[e]], direction);
+            if (dot > currentDot)
+            {
+                currentDot = dot;
+                next = adjacency[e];
+            }
+        }
+        if (next == current) return current;
+        current = next;
+    }
 }
 
 Collider::~Collider()
 {
-    // 目前无需释放资源，因为 std::vector 自动管理内存
+    // 联合体成员不会自动析构，凸包的 std::vector 需要显式释放
+    if (type == COLLIDER_TYPE_CONVEX_HULL)
+    {
+        convexHull.~ColliderConvexHull();
+    }
 }
 
 glm::vec3 Collider::getSupportPoint(const glm::vec3& direction) const
+{
+    unsigned int hint = 0;
+    return getSupportPoint(direction, hint);
+}
+
+glm::vec3 Collider::getSupportPoint(const glm::vec3& direction, unsigned int& hint) const
 {
     if (type == COLLIDER_TYPE_SPHERE)
     {
-        // 球体的支撑点是球心加上沿 direction 方向缩放的半径
-        glm::vec3 normalizedDir = glm::normalize(direction);
+        // 球体的支撑点是球心加上沿 direction 方向缩放的半径；方向为 0 时任取球面上一点
+        float length = glm::length(direction);
+        glm::vec3 normalizedDir = length > 0.0f ? direction / length : glm::vec3(1.0f, 0.0f, 0.0f);
         return sphere.center + normalizedDir * sphere.radius;
     }
     else if (type == COLLIDER_TYPE_CONVEX_HULL)
     {
         // 凸包的支撑点是顶点中点乘 direction 最大的顶点
-        glm::vec3 maxPoint = convexHull.vertices[0];
-        float maxDot = glm::dot(convexHull.vertices[0], direction);
-
-        for (const auto& vertex : convexHull.vertices)
+        const unsigned int count = static_cast<unsigned int>(convexHull.vertices.size());
+        if (count >= HillClimbMinVertices && !convexHull.adjacency.empty())
         {
-            float dot = glm::dot(vertex, direction);
-            if (dot > maxDot)
-            {
-                maxDot = dot;
-                maxPoint = vertex;
-            }
+            hint = hillClimbSupportIndex(direction, hint < count ? hint : 0);
         }
-        return maxPoint;
+        else
+        {
+            hint = linearSupportIndex(direction);
+        }
+        return convexHull.vertices[hint];
     }
     return glm::vec3(0.0f); // 默认值，防止未定义行为
-}
\ No newline at end of file
+}
+
+glm::vec3 Collider::getCoreSupportPoint(const glm::vec3& direction) const
+{
+    unsigned int hint = 0;
+    return getCoreSupportPoint(direction, hint);
+}
+
+glm::vec3 Collider::getCoreSupportPoint(const glm::vec3& direction, unsigned int& hint) const
+{
+    if (type == COLLIDER_TYPE_SPHERE)
+    {
+        return sphere.center;
+    }
+    return getSupportPoint(direction, hint);
+}
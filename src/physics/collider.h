@@ -17,6 +17,15 @@ struct ColliderSphere {
 struct ColliderConvexHull {
     std::vector<glm::vec3> vertices;  // 顶点
     std::vector<std::vector<unsigned int>> faces;  // 面（每个面由顶点索引组成）
+
+    // 以下由构造函数根据 vertices 和 faces 预计算
+    // 顶点 i 的邻居为 adjacency[adjacencyOffsets[i], adjacencyOffsets[i + 1])，坐标相同的顶点共享同一组邻居
+    std::vector<unsigned int> adjacencyOffsets;
+    std::vector<unsigned int> adjacency;
+    // 顶点坐标按分量分开存放，线性扫描时可被编译器向量化
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> zs;
 };
 
 class Collider
@@ -40,8 +49,24 @@ class Collider
         Collider(const Collider&) = delete;
         Collider& operator=(const Collider&) = delete;
 
-        // GJK 所需的支撑函数
+        // GJK 所需的支撑函数，direction 不要求单位长度
         glm::vec3 getSupportPoint(const glm::vec3& direction) const;
+        // hint 为上次查询得到的支撑顶点下标（输入输出）：顶点较多且有面信息的凸包从它出发沿邻接顶点爬山，
+        // 方向变化不大时只需访问少量顶点；其余情况线性扫描全部顶点
+        glm::vec3 getSupportPoint(const glm::vec3& direction, unsigned int& hint) const;
+        // 形状 = 核心形状按 margin 向外膨胀：球的核心是球心，凸包的核心是凸包本身（margin 为 0）
+        // GJK 在核心上求距离再减去 margin，避免对曲面逐步逼近
+        glm::vec3 getCoreSupportPoint(const glm::vec3& direction) const;
+        glm::vec3 getCoreSupportPoint(const glm::vec3& direction, unsigned int& hint) const;
+        float getMargin() const { return type == COLLIDER_TYPE_SPHERE ? sphere.radius : 0.0f; }
+
+        // 顶点数不少于该值且有面信息时支撑函数改用爬山，更小的凸包线性扫描更快
+        static constexpr unsigned int HillClimbMinVertices = 32;
+
+    private:
+        void buildConvexHullAdjacency();
+        unsigned int linearSupportIndex(const glm::vec3& direction) const;
+        unsigned int hillClimbSupportIndex(const glm::vec3& direction, unsigned int start) const;
 };
 
 #endif
\ No newline at end of file
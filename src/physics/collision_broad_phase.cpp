@@ -1,192 +1,400 @@
+#define C_FEK_HASH_MAP_IMPLEMENT
 #include "physics/collision_broad_phase.h"
+#include "core/log.h"
+#include "core/profiler.h"
+#include "core/thread_pool.h"
+#include "geometry/signed_distance_grid.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 
-CollisionBroadPhase::CollisionBroadPhase() : root(nullptr)
+namespace
 {
-    std::cout << "CollisionBroadPhase Initialized" << std::endl;
+    int pairKeyCompare(const void* key1, const void* key2)
+    {
+        return *static_cast<const uint64_t*>(key1) == *static_cast<const uint64_t*>(key2);
+    }
+
+    unsigned int pairKeyHash(const void* key)
+    {
+        // 两个连续的 proxyId 只差低位，先混合再取低 32 位，避免线性探测时聚集
+        uint64_t h = *static_cast<const uint64_t*>(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return static_cast<unsigned int>(h);
+    }
+
+    // 移动的叶节点超过总数的 1/SelfQueryRatio 时，整棵树自查询比逐个查询更快
+    const size_t SelfQueryRatio = 4;
+    // 待入树的叶节点超过总数的 1/BulkBuildRatio 时，整棵树重建比逐个插入更快
+    const size_t BulkBuildRatio = 4;
+    // 批量射线检测时每个任务块的最少射线数
+    const size_t RayBatchSize = 64;
+
+    // 射线与实体网格的精确求交：射线变换到网格局部坐标系，先测包围球，再逐个三角形求交（双面）
+    // direction 为单位向量，命中时 distance 为最近交点的距离，normal 为世界坐标系下朝向起点一侧的面法线
+    bool rayCastMesh(const Entity* entity, const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+        float& distance, glm::vec3& normal)
+    {
+        const Mesh* mesh = entity->getMesh();
+        const glm::quat rotation = entity->getRotation();
+        const glm::quat inverseRotation = glm::conjugate(rotation);
+        const glm::vec3 o = inverseRotation * (origin - entity->getPosition());
+        const glm::vec3 d = inverseRotation * direction;
+
+        const glm::vec3 oc = o - mesh->getBoundingSphereCenter();
+        const float radius = mesh->getBoundingSphereRadius();
+        const float b = glm::dot(oc, d);
+        const float c = glm::dot(oc, oc) - radius * radius;
+        if (c > 0.0f && b > 0.0f) return false;
+        const float discriminant = b * b - c;
+        if (discriminant < 0.0f) return false;
+        const float sphereEntry = std::max(-b - std::sqrt(discriminant), 0.0f);
+        if (sphereEntry > maxDistance) return false;
+
+        const std::vector<glm::vec3>& vertices = mesh->getPositions();
+        const std::vector<unsigned int>& indices = mesh->getIndices();
+        if (indices.empty())
+        {
+            // 没有三角形时以包围球代替，起点在球内时法线取射线反方向
+            distance = sphereEntry;
+            glm::vec3 offset = o + d * sphereEntry - mesh->getBoundingSphereCenter();
+            normal = rotation * (glm::dot(offset, offset) > 0.0f && sphereEntry > 0.0f ? glm::normalize(offset) : -d);
+            return true;
+        }
+
+        // Möller–Trumbore
+        float best = maxDistance;
+        glm::vec3 bestNormal(0.0f);
+        bool found = false;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const glm::vec3& v0 = vertices[indices[i]];
+            const glm::vec3 edge1 = vertices[indices[i + 1]] - v0;
+            const glm::vec3 edge2 = vertices[indices[i + 2]] - v0;
+            const glm::vec3 p = glm::cross(d, edge2);
+            const float det = glm::dot(edge1, p);
+            if (std::fabs(det) < 1e-12f) continue;
+            const float invDet = 1.0f / det;
+            const glm::vec3 s = o - v0;
+            const float u = glm::dot(s, p) * invDet;
+            if (u < 0.0f || u > 1.0f) continue;
+            const glm::vec3 q = glm::cross(s, edge1);
+            const float v = glm::dot(d, q) * invDet;
+            if (v < 0.0f || u + v > 1.0f) continue;
+            const float t = glm::dot(edge2, q) * invDet;
+            if (t < 0.0f || t > best) continue;
+            best = t;
+            bestNormal = glm::cross(edge1, edge2);
+            found = true;
+        }
+        if (!found) return false;
+
+        distance = best;
+        bestNormal = glm::normalize(bestNormal);
+        if (glm::dot(bestNormal, d) > 0.0f) bestNormal = -bestNormal;
+        normal = rotation * bestNormal;
+        return true;
+    }
+
+    // 球与实体网格是否相交：球心到网格的有向距离不超过半径（球心在网格内部时距离为负）
+    // 精确距离和内外判断由网格的距离场给出，与窄相使用同一套伪法线
+    bool sphereOverlapsMesh(const Entity* entity, const glm::vec3& center, float radius)
+    {
+        const Mesh* mesh = entity->getMesh();
+        const glm::vec3 p = glm::conjugate(entity->getRotation()) * (center - entity->getPosition());
+        const float reach = radius + mesh->getBoundingSphereRadius();
+        const glm::vec3 offset = p - mesh->getBoundingSphereCenter();
+        if (glm::dot(offset, offset) > reach * reach) return false;
+
+        const std::shared_ptr<const SignedDistanceGrid> grid = mesh->getSignedDistanceGrid();
+        if (grid->empty()) return true;
+        return grid->exactDistance(p) <= radius;
+    }
 }
 
-CollisionBroadPhase::~CollisionBroadPhase()
+CollisionBroadPhase::CollisionBroadPhase()
+    : threadPool(nullptr), predictionTime(0.0f), aabbMargin(0.0f),
+      fatMargin(0.05f), lastMovedCount(0), rebuildRatio(1.0f), reinsertedSinceBuild(0), pairFrame(0)
 {
-    deleteTree(root);
+    if (hash_map_create(&pairSet, 1024, sizeof(uint64_t), sizeof(uint32_t), pairKeyCompare, pairKeyHash))
+    {
+        std::cerr << "Error: Failed to create broad phase pair set" << std::endl;
+    }
+    XPBD_LOG_DEBUG(BroadPhase, "CollisionBroadPhase initialized");
 }
 
-void CollisionBroadPhase::deleteTree(AABBNode* node)
+CollisionBroadPhase::~CollisionBroadPhase()
 {
-    if (!node) return;
-    deleteTree(node->left);
-    deleteTree(node->right);
-    delete node;
+    hash_map_destroy(&pairSet);
+}
+bool CollisionBroadPhase::containsAABB(const AABB& outer, const AABB& inner)
+{
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+           outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
 }
 
-AABB CollisionBroadPhase::computeAABB(const Entity* entity)
+void CollisionBroadPhase::markMoved(uint32_t proxyId)
 {
-    AABB aabb;
-    aabb.min = glm::vec3(std::numeric_limits<float>::max());
-    aabb.max = glm::vec3(-std::numeric_limits<float>::max());
+    BroadPhaseProxy& proxy = proxies[proxyId];
+    if (proxy.moved) return;
+    proxy.moved = true;
+    movedProxies.push_back(proxyId);
+}
 
-    // 使用Mesh的顶点数据计算AABB
-    const std::vector<glm::vec3>& vertices = entity->getMesh()->getPositions();
-    if (vertices.empty())
+void CollisionBroadPhase::computeFitAABB(BroadPhaseProxy& proxy)
+{
+    Entity* entity = proxy.entity;
+    // 位姿未变（静止或静态刚体）时不必重新计算网格包围盒
+    if (entity->getPosition() != proxy.lastPosition || entity->getRotation() != proxy.lastRotation)
     {
-        // 如果没有顶点数据，返回一个默认的AABB（以position为中心，尺寸为0.1 * 0.1 * 0.1）
-        glm::vec3 defaultSize(0.05f, 0.05f, 0.05f);
-        aabb.min = entity->getPosition() - defaultSize;
-        aabb.max = entity->getPosition() + defaultSize;
-        return aabb;
+        proxy.shapeAABB = computeAABB(entity);
+        proxy.lastPosition = entity->getPosition();
+        proxy.lastRotation = entity->getRotation();
     }
 
-    // 考虑位置和旋转
-    glm::mat4x4 transform = glm::mat4_cast(entity->getRotation());
-    glm::vec3 position = entity->getPosition();
-    for (const auto& vertex : vertices)
+    glm::vec3 displacement(0.0f);
+    if (predictionTime > 0.0f)
     {
-        // 将顶点局部坐标转换为世界坐标
-        glm::vec4 worldVertex = transform * glm::vec4(vertex, 1.0f);
-        worldVertex += glm::vec4(position, 0.0f);
-        glm::vec3 worldPos(worldVertex.x, worldVertex.y, worldVertex.z);
-        aabb.min = glm::min(aabb.min, worldPos);
-        aabb.max = glm::max(aabb.max, worldPos);
+        displacement = entity->getLinearVelocity() * predictionTime;
     }
-
-    std::cout << "Entity: " << entity << ", AABB: (" << aabb.min.x << ", " << aabb.min.y << ") - (" << aabb.max.x << ", " << aabb.max.y << ")" << std::endl;
-
-    return aabb;
+    proxy.fitAABB = proxy.shapeAABB;
+    proxy.fitAABB.min += glm::min(displacement, glm::vec3(0.0f)) - glm::vec3(aabbMargin);
+    proxy.fitAABB.max += glm::max(displacement, glm::vec3(0.0f)) + glm::vec3(aabbMargin);
 }
 
-bool CollisionBroadPhase::checkAABBCollision(const AABB& aabb1, const AABB& aabb2)
+AABB CollisionBroadPhase::computeFatAABB(const BroadPhaseProxy& proxy) const
 {
-    return (aabb1.min.x <= aabb2.max.x && aabb1.max.x >= aabb2.min.x) &&
-           (aabb1.min.y <= aabb2.max.y && aabb1.max.y >= aabb2.min.y) &&
-           (aabb1.min.z <= aabb2.max.z && aabb1.max.z >= aabb2.min.z);
+    // 按固定余量和若干帧的预测位移外扩
+    glm::vec3 prediction(0.0f);
+    if (predictionTime > 0.0f)
+    {
+        prediction = proxy.entity->getLinearVelocity() * (predictionTime * VelocityPredictionFactor);
+    }
+    AABB fatAABB;
+    fatAABB.min = proxy.fitAABB.min + glm::min(prediction, glm::vec3(0.0f)) - glm::vec3(fatMargin);
+    fatAABB.max = proxy.fitAABB.max + glm::max(prediction, glm::vec3(0.0f)) + glm::vec3(fatMargin);
+    return fatAABB;
 }
 
-AABB CollisionBroadPhase::mergeAABB(const AABB& aabb1, const AABB& aabb2)
+void CollisionBroadPhase::updateProxy(uint32_t proxyId)
 {
-    AABB result;
-    result.min = glm::min(aabb1.min, aabb2.min);
-    result.max = glm::max(aabb1.max, aabb2.max);
-    return result;
+    BroadPhaseProxy& proxy = proxies[proxyId];
+    // 休眠中的刚体没有移动，保留上次的包围盒
+    if (proxy.entity->isSleeping()) return;
+    computeFitAABB(proxy);
+
+    const uint32_t leaf = proxy.node;
+    const bool inTree = dynamicTree.isInTree(leaf);
+    if (inTree)
+    {
+        if (containsAABB(dynamicTree.getFatAABB(leaf), proxy.fitAABB)) return;
+        dynamicTree.removeLeaf(leaf);
+    }
+
+    // 越界后重新外扩并插入；尚未入树的叶节点留给 flushPending
+    dynamicTree.setFatAABB(leaf, computeFatAABB(proxy));
+    markMoved(proxyId);
+    if (!inTree) return;
+    dynamicTree.insertLeaf(leaf);
+    ++lastMovedCount;
 }
 
-void CollisionBroadPhase::insertAABBNode(AABBNode* node)
+void CollisionBroadPhase::update(float predictionTime, float margin)
 {
-    if (!root)
+    this->predictionTime = predictionTime;
+    this->aabbMargin = margin;
+    lastMovedCount = 0;
+    // 静态实体不移动，不参与刷新
+    for (uint32_t proxyId : dynamicProxies)
     {
-        root = node;
-        std::cout << "Inserted: " << node->entity << ", AABB min: " << node->aabb.min.y << std::endl;
-        return;
+        updateProxy(proxyId);
     }
+    flushPending();
 
-    std::vector<AABBNode*> stack;
-    stack.push_back(root);
+    // 增量插入和旋转只做局部优化，大量叶节点重新插入后整体质量下降，此时整棵重建
+    reinsertedSinceBuild += lastMovedCount;
+    if (rebuildRatio > 0.0f && reinsertedSinceBuild > rebuildRatio * dynamicProxies.size())
+    {
+        rebuild();
+    }
+}
+
+void CollisionBroadPhase::flushPending()
+{
+    if (pendingProxies.empty()) return;
 
-    while (!stack.empty())
+    size_t pendingDynamic = 0;
+    for (uint32_t proxyId : pendingProxies)
     {
-        AABBNode* current = stack.back();
-        stack.pop_back();
+        if (!proxies[proxyId].isStatic) ++pendingDynamic;
+    }
+    const size_t pendingStatic = pendingProxies.size() - pendingDynamic;
+    const bool rebuildDynamic = pendingDynamic * BulkBuildRatio > dynamicTree.getLeafCount();
+    const bool rebuildStatic = pendingStatic * BulkBuildRatio > staticTree.getLeafCount();
+    if (rebuildDynamic) rebuildTree(dynamicTree);
+    if (rebuildStatic) rebuildTree(staticTree);
 
-        if (current->isLeaf)
-        {
-            AABBNode* newParent = new AABBNode();
-            newParent->left = current;
-            newParent->right = node;
-            newParent->parent = current->parent;
-            newParent->isLeaf = false;
-            current->parent = newParent;
-            node->parent = newParent;
-
-            newParent->aabb = mergeAABB(current->aabb, node->aabb);
-            if (newParent->parent)
-            {
-                if (newParent->parent->left == current)
-                {
-                    newParent->parent->left = newParent;
-                }
-                else
-                {
-                    newParent->parent->right = newParent;
-                }
-                AABBNode* parent = newParent->parent;
-                while (parent)
-                {
-                    parent->aabb = mergeAABB(parent->left->aabb, parent->right->aabb);
-                    parent = parent->parent;
-                }
-            }
-            else
-            {
-                root = newParent;
-            }
-            break;
-        }
-        else
-        {
-            if (current->left) stack.push_back(current->left);
-            if (current->right) stack.push_back(current->right);
-        }
+    for (uint32_t proxyId : pendingProxies)
+    {
+        const BroadPhaseProxy& proxy = proxies[proxyId];
+        AABBTree& tree = treeOf(proxy);
+        if (!tree.isInTree(proxy.node)) tree.insertLeaf(proxy.node);
+    }
+    pendingProxies.clear();
+
+    // 整棵树的输出代价很高，只在开启 Trace 时生成
+    if (XPBD_LOG_ENABLED(LogLevel::Trace, LogCategory::BroadPhase))
+    {
+        XPBD_LOG_TRACE(BroadPhase, "Dynamic tree:");
+        dynamicTree.printTree();
+        XPBD_LOG_TRACE(BroadPhase, "Static tree:");
+        staticTree.printTree();
     }
-    std::cout << "Inserted: " << node->entity << ", AABB min: " << node->aabb.min.y << std::endl;
-    printTree(root);
 }
 
-void CollisionBroadPhase::updateAABBNode(AABBNode* node)
+void CollisionBroadPhase::rebuildTree(AABBTree& tree)
 {
-    if (!node) return;
-
-    if (node->isLeaf && node->entity)
+    tree.rebuild(threadPool);
+    for (uint32_t leaf = 0; leaf < tree.getLeafCount(); ++leaf)
     {
-        node->aabb = computeAABB(node->entity);
+        proxies[tree.getUserData(leaf)].node = leaf;
     }
-    else
+}
+
+void CollisionBroadPhase::rebuild()
+{
+    rebuildTree(dynamicTree);
+    reinsertedSinceBuild = 0;
+}
+
+void CollisionBroadPhase::updateStatics()
+{
+    for (uint32_t proxyId = 0; proxyId < proxies.size(); ++proxyId)
     {
-        updateAABBNode(node->left);
-        updateAABBNode(node->right);
-        node->aabb = mergeAABB(node->left->aabb, node->right->aabb);
+        BroadPhaseProxy& proxy = proxies[proxyId];
+        if (!proxy.isStatic) continue;
+        computeFitAABB(proxy);
+        // 随后整棵重建，不必先把叶节点移出树
+        staticTree.setFatAABB(proxy.node, computeFatAABB(proxy));
+        markMoved(proxyId);
     }
+    rebuildTree(staticTree);
+}
+
+void CollisionBroadPhase::addCandidatePair(uint32_t proxyA, uint32_t proxyB)
+{
+    if (proxies[proxyA].entity == proxies[proxyB].entity) return; // 过滤自碰撞
+    // 按插入顺序排列 pair（与内存地址无关），结果可复现
+    pairCache.emplace_back(std::min(proxyA, proxyB), std::max(proxyA, proxyB));
 }
 
-void CollisionBroadPhase::update()
+void CollisionBroadPhase::queryMovedProxy(uint32_t proxyId)
 {
-    updateAABBNode(root);
+    const BroadPhaseProxy& proxy = proxies[proxyId];
+    const AABB fatAABB = treeOf(proxy).getFatAABB(proxy.node);
+    auto visit = [&](const AABBTree& tree)
+    {
+        tree.query(fatAABB, [&](uint32_t leaf)
+        {
+            const uint32_t otherId = tree.getUserData(leaf);
+            if (otherId == proxyId) return;
+            // 两个叶节点都移动过时，由 proxyId 较小的一方负责输出，避免重复
+            if (proxies[otherId].moved && otherId < proxyId) return;
+            addCandidatePair(proxyId, otherId);
+        });
+    };
+    // 静态叶节点只与动态树求交
+    visit(dynamicTree);
+    if (!proxy.isStatic) visit(staticTree);
 }
 
-void CollisionBroadPhase::collectCollisionPairs(AABBNode* node1, AABBNode* node2, std::vector<std::pair<Entity*, Entity*>>& pairs)
+void CollisionBroadPhase::querySelf()
 {
-    if (!node1 || !node2) return;
+    dynamicTree.querySelf([this](uint32_t leafA, uint32_t leafB)
+    {
+        addCandidatePair(dynamicTree.getUserData(leafA), dynamicTree.getUserData(leafB));
+    });
+    dynamicTree.queryTree(staticTree, [this](uint32_t dynamicLeaf, uint32_t staticLeaf)
+    {
+        addCandidatePair(dynamicTree.getUserData(dynamicLeaf), staticTree.getUserData(staticLeaf));
+    });
+}
 
-    if (checkAABBCollision(node1->aabb, node2->aabb))
+void CollisionBroadPhase::updatePairSet(std::vector<std::pair<Entity*, Entity*>>& pairs)
+{
+    // 本次出现的碰撞对把槽位的帧号更新为当前帧；帧号没有更新的槽位即为 End
+    ++pairFrame;
+    pairEvents.clear();
+    addedPairs.clear();
+    removedPairs.clear();
+    pairs.clear();
+    for (const auto& pair : pairCache)
     {
-        if (node1->isLeaf && node2->isLeaf)
+        const BroadPhaseProxy& a = proxies[pair.first];
+        const BroadPhaseProxy& b = proxies[pair.second];
+        // 胖包围盒相交只是候选，再用本帧的 fitAABB 过滤，窄相的负载与不外扩时相同
+        if (!checkAABBCollision(a.fitAABB, b.fitAABB)) continue;
+
+        uint64_t key = makePairKey(pair.first, pair.second);
+        uint32_t slot = 0;
+        PairEventType type = PairEventType::Persist;
+        const uint32_t event = static_cast<uint32_t>(pairEvents.size());
+        if (hash_map_get(&pairSet, &key, &slot) == 0)
         {
-            if (node1->entity == node2->entity) return; // 过滤自碰撞
-            // 确保 pair 是按指针地址排序的，避免重复
-            Entity* first = std::min(node1->entity, node2->entity);
-            Entity* second = std::max(node1->entity, node2->entity);
-            pairs.emplace_back(first, second);
+            pairSlots[slot].frame = pairFrame;
+            pairSlots[slot].event = event;
         }
         else
         {
-            if (node1->isLeaf || (!node1->left && !node1->right))
+            slot = static_cast<uint32_t>(pairSlots.size());
+            PairSlot pairSlot;
+            pairSlot.key = key;
+            pairSlot.frame = pairFrame;
+            pairSlot.event = event;
+            pairSlot.data = PairCacheData();   // 值初始化为全零，朝向另设为单位四元数
+            pairSlot.data.rotationA = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+            pairSlot.data.rotationB = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+            pairSlots.push_back(pairSlot);
+            if (hash_map_put(&pairSet, &key, &slot))
             {
-                collectCollisionPairs(node1, node2->left, pairs);
-                collectCollisionPairs(node1, node2->right, pairs);
-            }
-            else if (node2->isLeaf || (!node2->left && !node2->right))
-            {
-                collectCollisionPairs(node1->left, node2, pairs);
-                collectCollisionPairs(node1->right, node2, pairs);
-            }
-            else
-            {
-                collectCollisionPairs(node1->left, node2->left, pairs);
-                collectCollisionPairs(node1->left, node2->right, pairs);
-                collectCollisionPairs(node1->right, node2->left, pairs);
-                collectCollisionPairs(node1->right, node2->right, pairs);
+                XPBD_LOG_ERROR(BroadPhase, "Failed to grow broad phase pair set");
             }
+            type = PairEventType::Begin;
+        }
+        pairs.emplace_back(a.entity, b.entity);
+        pairEvents.push_back(PairEvent{ a.entity, b.entity, key, type, slot });
+    }
+
+    // 结束的碰撞对从集合中删除，用最后一个槽位填补空位，并更新被移动槽位的事件
+    for (size_t i = 0; i < pairSlots.size();)
+    {
+        if (pairSlots[i].frame == pairFrame)
+        {
+            ++i;
+            continue;
         }
+        uint64_t key = pairSlots[i].key;
+        Entity* entityA = proxies[static_cast<uint32_t>(key >> 32)].entity;
+        Entity* entityB = proxies[static_cast<uint32_t>(key & 0xffffffffu)].entity;
+        pairEvents.push_back(PairEvent{ entityA, entityB, key, PairEventType::End, PairEvent::NullSlot });
+        removedPairs.push_back(pairEvents.back());
+        hash_map_delete(&pairSet, &key);
+
+        if (i + 1 != pairSlots.size())
+        {
+            pairSlots[i] = pairSlots.back();
+            uint32_t slot = static_cast<uint32_t>(i);
+            hash_map_put(&pairSet, &pairSlots[i].key, &slot);
+            if (pairSlots[i].frame == pairFrame) pairEvents[pairSlots[i].event].slot = slot;
+        }
+        pairSlots.pop_back();
+    }
+
+    for (const PairEvent& event : pairEvents)
+    {
+        if (event.type == PairEventType::Begin) addedPairs.push_back(event);
     }
 }
 
@@ -198,46 +406,187 @@ void CollisionBroadPhase::addObject(Entity* entity)
         return;
     }
 
-    AABBNode* node = new AABBNode();
-    node->entity = entity;
-    node->isLeaf = true;
-    node->aabb = computeAABB(entity);
-    insertAABBNode(node);
+    uint32_t proxyId = static_cast<uint32_t>(proxies.size());
+    BroadPhaseProxy proxy;
+    proxy.entity = entity;
+    proxy.isStatic = entity->getInverseMass() == 0.0f || entity->isFixed();
+    proxy.moved = false;
+    proxy.shapeAABB = computeAABB(entity);
+    proxy.lastPosition = entity->getPosition();
+    proxy.lastRotation = entity->getRotation();
+    computeFitAABB(proxy);
+    proxy.node = treeOf(proxy).createLeaf(computeFatAABB(proxy), proxyId);
+    proxies.push_back(proxy);
+    if (!proxy.isStatic) dynamicProxies.push_back(proxyId);
+    pendingProxies.push_back(proxyId);
+    markMoved(proxyId);
+
+    XPBD_LOG_DEBUG(BroadPhase, "Added: %p (%s), AABB min: %g", (const void*)entity, proxy.isStatic ? "static" : "dynamic", proxy.fitAABB.min.y);
 }
 
 void CollisionBroadPhase::collectCollisionPairs(std::vector<std::pair<Entity*, Entity*>>& pairs)
 {
-    pairs.clear();
-    if (root)
+    flushPending();
+    if (!movedProxies.empty())
     {
-        collectCollisionPairs(root, root, pairs);
+        if (movedProxies.size() * SelfQueryRatio > proxies.size())
+        {
+            pairCache.clear();
+            querySelf();
+        }
+        else
+        {
+            // 未移动的两个叶节点的胖包围盒都没变，它们之间的结果直接沿用
+            pairCache.erase(std::remove_if(pairCache.begin(), pairCache.end(),
+                                           [this](const std::pair<uint32_t, uint32_t>& pair)
+                                           { return proxies[pair.first].moved || proxies[pair.second].moved; }),
+                            pairCache.end());
+            for (uint32_t proxyId : movedProxies)
+            {
+                queryMovedProxy(proxyId);
+            }
+        }
+        for (uint32_t proxyId : movedProxies)
+        {
+            proxies[proxyId].moved = false;
+        }
+        movedProxies.clear();
     }
-    // 去重（确保唯一性）
-    std::sort(pairs.begin(), pairs.end());
-    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
-    std::cout << "Potential collisions: " << pairs.size() << std::endl;
-    for (const auto& pair : pairs)
+
+    updatePairSet(pairs);
+    XPBD_LOG_DEBUG(BroadPhase, "Potential collisions: %zu (cached %zu)", pairs.size(), pairCache.size());
+    if (XPBD_LOG_ENABLED(LogLevel::Trace, LogCategory::BroadPhase))
     {
-        std::cout << "Pair: (" << pair.first << ", " << pair.second << ")" << std::endl;
+        for (const auto& pair : pairs)
+        {
+            XPBD_LOG_TRACE(BroadPhase, "Pair: (%p, %p)", (const void*)pair.first, (const void*)pair.second);
+        }
     }
 }
 
-void CollisionBroadPhase::printTree(AABBNode* node, int depth)
+template <typename Callback>
+void CollisionBroadPhase::rayCastTrees(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+    std::vector<AABBTree::RayStackEntry>& stack, Callback&& callback) const
 {
-    if (!node) return;
+    // 动态树上缩短的 maxDistance 继续用于裁剪静态树
+    dynamicTree.rayCast(origin, direction, maxDistance, stack,
+                        [&](uint32_t leaf, float distance)
+                        {
+                            maxDistance = callback(dynamicTree.getUserData(leaf), distance);
+                            return maxDistance;
+                        });
+    if (maxDistance < 0.0f) return;
+    staticTree.rayCast(origin, direction, maxDistance, stack,
+                       [&](uint32_t leaf, float distance) { return callback(staticTree.getUserData(leaf), distance); });
+}
 
-    // 生成缩进
-    std::string indent(depth * 2, ' ');
+template <typename Callback>
+void CollisionBroadPhase::queryTrees(const AABB& aabb, Callback&& callback) const
+{
+    dynamicTree.query(aabb, [&](uint32_t leaf) { callback(dynamicTree.getUserData(leaf)); });
+    staticTree.query(aabb, [&](uint32_t leaf) { callback(staticTree.getUserData(leaf)); });
+}
+
+bool CollisionBroadPhase::rayCastClosest(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+    std::vector<AABBTree::RayStackEntry>& stack, RayCastHit& hit) const
+{
+    hit.entity = nullptr;
+    const float length = glm::length(direction);
+    if (length == 0.0f || !(maxDistance >= 0.0f)) return false;
+    const glm::vec3 unitDirection = direction / length;
 
-    // 打印节点信息
-    std::cout << indent << "Node: " << node
-              << ", Entity: " << (node->entity ? node->entity : nullptr)
-              << ", isLeaf: " << (node->isLeaf ? "true" : "false")
-              << ", AABB: (" << node->aabb.min.x << ", " << node->aabb.min.y << ", " << node->aabb.min.z
-              << ") - (" << node->aabb.max.x << ", " << node->aabb.max.y << ", " << node->aabb.max.z << ")"
-              << std::endl;
+    rayCastTrees(origin, unitDirection, maxDistance, stack,
+                 [&](uint32_t proxyId, float distance)
+                 {
+                     float t;
+                     glm::vec3 normal;
+                     Entity* entity = proxies[proxyId].entity;
+                     if (!rayCastMesh(entity, origin, unitDirection, distance, t, normal)) return distance;
+                     hit.entity = entity;
+                     hit.distance = t;
+                     hit.normal = normal;
+                     return t;
+                 });
+    if (!hit.entity) return false;
+    hit.point = origin + unitDirection * hit.distance;
+    return true;
+}
+
+bool CollisionBroadPhase::rayCastClosest(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayCastHit& hit)
+{
+    flushPending();
+    return rayCastClosest(origin, direction, maxDistance, rayStack, hit);
+}
+
+void CollisionBroadPhase::rayCastAll(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayCastHit>& hits)
+{
+    hits.clear();
+    flushPending();
+    const float length = glm::length(direction);
+    if (length == 0.0f || !(maxDistance >= 0.0f)) return;
+    const glm::vec3 unitDirection = direction / length;
+
+    rayCastTrees(origin, unitDirection, maxDistance, rayStack,
+                 [&](uint32_t proxyId, float distance)
+                 {
+                     RayCastHit hit;
+                     hit.entity = proxies[proxyId].entity;
+                     if (rayCastMesh(hit.entity, origin, unitDirection, distance, hit.distance, hit.normal))
+                     {
+                         hit.point = origin + unitDirection * hit.distance;
+                         hits.push_back(hit);
+                     }
+                     return distance;
+                 });
+    std::sort(hits.begin(), hits.end(),
+              [](const RayCastHit& a, const RayCastHit& b) { return a.distance < b.distance; });
+}
 
-    // 递归打印子节点
-    printTree(node->left, depth + 1);
-    printTree(node->right, depth + 1);
-}
\ No newline at end of file
+void CollisionBroadPhase::rayCastClosestBatch(const std::vector<RayCastQuery>& rays, std::vector<RayCastHit>& hits)
+{
+    XPBD_PROFILE_ZONE("BroadPhase::rayCastClosestBatch");
+    flushPending();
+    hits.resize(rays.size());
+    // 树在查询期间只读，每个任务块使用自己的遍历栈
+    auto task = [&](size_t begin, size_t end)
+    {
+        std::vector<AABBTree::RayStackEntry> stack;
+        for (size_t i = begin; i < end; ++i)
+        {
+            rayCastClosest(rays[i].origin, rays[i].direction, rays[i].maxDistance, stack, hits[i]);
+        }
+    };
+    if (threadPool)
+    {
+        threadPool->parallelFor(rays.size(), task, RayBatchSize);
+    }
+    else
+    {
+        task(0, rays.size());
+    }
+}
+
+void CollisionBroadPhase::overlapAABB(const AABB& aabb, std::vector<Entity*>& entities)
+{
+    entities.clear();
+    flushPending();
+    queryTrees(aabb, [&](uint32_t proxyId)
+               {
+                   Entity* entity = proxies[proxyId].entity;
+                   if (checkAABBCollision(computeAABB(entity), aabb)) entities.push_back(entity);
+               });
+}
+
+void CollisionBroadPhase::overlapSphere(const glm::vec3& center, float radius, std::vector<Entity*>& entities)
+{
+    entities.clear();
+    flushPending();
+    AABB bounds;
+    bounds.min = center - glm::vec3(radius);
+    bounds.max = center + glm::vec3(radius);
+    queryTrees(bounds, [&](uint32_t proxyId)
+               {
+                   Entity* entity = proxies[proxyId].entity;
+                   if (sphereOverlapsMesh(entity, center, radius)) entities.push_back(entity);
+               });
+}
@@ -2,48 +2,201 @@
 #define COLLISION_BROAD_PHASE_H
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
 #include <vector>
+#include "hash_map.h"
+#include "physics/aabb_tree.h"
+#include "physics/broad_phase.h"
 #include "physics/entity.h"
 
-struct AABB 
+// 叶节点的附加数据，按 proxyId（插入序号）存放在单独的数组中
+struct BroadPhaseProxy {
+    Entity* entity;
+    uint32_t node;           // 对应的叶节点在所属树中的下标
+    bool isStatic;           // 在静态树中
+    bool moved;              // 自上次收集碰撞对以来被重新插入过
+    AABB fitAABB;            // 本帧实际需要覆盖的范围（网格包围盒 + 速度扫掠 + 接触余量）
+    AABB shapeAABB;          // 网格在 lastPosition/lastRotation 下的包围盒，位姿不变时复用
+    glm::vec3 lastPosition;
+    glm::quat lastRotation;
+};
+
+// 碰撞对在相邻两次 collectCollisionPairs 之间的状态变化
+enum class PairEventType : uint8_t
+{
+    Begin,    // 本次新出现
+    Persist,  // 上次和本次都存在
+    End       // 上次存在，本次消失
+};
+
+struct PairEvent
 {
-    glm::vec3 min;
-    glm::vec3 max;
+    Entity* entityA;
+    Entity* entityB;
+    uint64_t key;            // 由两个 proxyId 组成，在碰撞对存续期间保持不变，可作为接触缓存的键
+    PairEventType type;
+    uint32_t slot;           // Begin/Persist 为 getPairData 的下标，到下次 collectCollisionPairs 前有效；End 为 NullSlot
+    static constexpr uint32_t NullSlot = 0xffffffffu;
 };
 
-struct AABBNode {
-    AABB aabb;
-    Entity* entity;  // 叶节点存储实体
-    AABBNode* left;
-    AABBNode* right;
-    AABBNode* parent;
-    bool isLeaf;
+// 碰撞对存续期间由宽相保存的窄相数据，Begin 时清零，End 时丢弃
+// 窄相可据此利用时间相关性：沿用上次的分离方向和最近特征，或在间隙足够大时跳过本次检测
+struct PairCacheData
+{
+    glm::vec3 separatingAxis;     // 上次窄相的接触法线或分离方向（entityA 指向 entityB），全零表示尚未计算
+    float separation;             // 上次窄相求得的间隙，<= 0 表示当时处于接触
+    glm::vec3 relativePosition;   // 计算间隙时 entityB 相对 entityA 的位置
+    glm::quat rotationA;          // 计算间隙时两侧的朝向
+    glm::quat rotationB;
+    uint32_t featureA;            // 上次的最近特征（如支撑顶点下标）
+    uint32_t featureB;
+};
+
+// 射线检测的结果，entity 为 nullptr 表示未命中
+struct RayCastHit
+{
+    Entity* entity;
+    float distance;          // 沿单位化方向的距离
+    glm::vec3 point;
+    glm::vec3 normal;        // 命中三角形的法线，朝向射线起点一侧
+};
 
-    AABBNode() : entity(nullptr), left(nullptr), right(nullptr), parent(nullptr), isLeaf(false) {}
+struct RayCastQuery
+{
+    glm::vec3 origin;
+    glm::vec3 direction;     // 不要求单位长度，为 0 时不命中
+    float maxDistance;
 };
 
-class CollisionBroadPhase
+// 基于 AABB 树的宽相
+// 静态实体（质量为 0 或 isFixed）放在单独的静态树中，update 不刷新它们，也不生成静态-静态碰撞对；
+// 动态叶节点同时查询动态树和静态树
+// addObject 只登记叶节点，在下一次 update 或 collectCollisionPairs 时统一入树：
+// 新增数量相对已有的叶节点较少时逐个 SAH 插入，批量加载时整棵树按分箱 SAH 自顶向下重建
+class CollisionBroadPhase : public BroadPhase
 {
     public:
         CollisionBroadPhase();
         ~CollisionBroadPhase();
+        CollisionBroadPhase(const CollisionBroadPhase&) = delete;
+        CollisionBroadPhase& operator=(const CollisionBroadPhase&) = delete;
+
+        void addObject(Entity* entity) override;
+        void setThreadPool(ThreadPool* pool) override { threadPool = pool; }
+        // 只有 fitAABB 越出胖包围盒的叶节点才会被移除并重新插入，其余叶节点和内部节点保持不变
+        void update(float predictionTime = 0.0f, float margin = 0.0f) override;
+        // 只对移动过的叶节点查询树，与上次结果合并；移动的叶节点较多时改为整棵树的自查询
+        // 输出的每一对的 fitAABB 都相交
+        void collectCollisionPairs(std::vector<std::pair<Entity*, Entity*>>& pairs) override;
+        // 上次 collectCollisionPairs 相对于再上一次的 Begin/Persist/End 事件
+        // Begin/Persist 与输出的碰撞对一一对应、顺序相同，End 排在最后
+        const std::vector<PairEvent>& getPairEvents() const { return pairEvents; }
+        // 只含 Begin 或 End 的增量，碰撞对多而变化少时比遍历全部事件更省
+        const std::vector<PairEvent>& getAddedPairs() const { return addedPairs; }
+        const std::vector<PairEvent>& getRemovedPairs() const { return removedPairs; }
+        // 当前碰撞对的缓存数据，slot 取自 PairEvent::slot
+        PairCacheData& getPairData(uint32_t slot) { return pairSlots[slot].data; }
+        const PairCacheData& getPairData(uint32_t slot) const { return pairSlots[slot].data; }
+        size_t getPairCount() const { return pairSlots.size(); }
+        static uint64_t makePairKey(uint32_t proxyA, uint32_t proxyB)
+        {
+            return proxyA < proxyB ? (static_cast<uint64_t>(proxyA) << 32) | proxyB
+                                   : (static_cast<uint64_t>(proxyB) << 32) | proxyA;
+        }
+        // 动态树的高度，不含尚未入树的叶节点
+        int getTreeHeight() const { return dynamicTree.getHeight(); }
+        int getStaticTreeHeight() const { return staticTree.getHeight(); }
+        size_t getStaticCount() const { return staticTree.getLeafCount(); }
+
+        // 用所有动态叶节点的胖包围盒按分箱 SAH 重建动态树，叶节点的胖包围盒不变，碰撞对缓存继续有效
+        void rebuild();
+        // 累计重新插入的叶节点数超过动态叶节点总数的 ratio 倍时，在 update 末尾自动重建；0 表示关闭
+        void setRebuildRatio(float ratio) { rebuildRatio = ratio > 0.0f ? ratio : 0.0f; }
+        float getRebuildRatio() const { return rebuildRatio; }
+        // 静态实体被移动（如编辑关卡）后调用：重新计算所有静态包围盒并重建静态树
+        void updateStatics();
+
+        // 场景查询：先用两棵树的胖包围盒筛选，再按实体当前位姿对网格精确判断
+        // 未入树的实体会先入树；结果基于实体当前的位姿，但只有上次 update 时的胖包围盒覆盖到的实体才会被找到
+        // 最近的命中，未命中时返回 false
+        bool rayCastClosest(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayCastHit& hit);
+        // 所有被射线穿过的实体，每个实体取最近的命中点，按距离从近到远排列
+        void rayCastAll(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayCastHit>& hits);
+        // 批量最近命中检测，hits[i] 对应 rays[i]；设置了线程池时分批并行
+        void rayCastClosestBatch(const std::vector<RayCastQuery>& rays, std::vector<RayCastHit>& hits);
+        // 当前包围盒与 aabb 相交的实体
+        void overlapAABB(const AABB& aabb, std::vector<Entity*>& entities);
+        // 网格表面或内部与球相交的实体
+        void overlapSphere(const glm::vec3& center, float radius, std::vector<Entity*>& entities);
 
-        void addObject(Entity* entity);
-        void update();
-        void collectCollisionPairs(std::vector<std::pair<Entity*, Entity*>>& pairs);
-        AABB computeAABB(const Entity* entity);
+        // 胖包围盒在各方向额外外扩的距离，越大重新插入越少，但树的重叠越多
+        void setFatMargin(float margin) { fatMargin = margin > 0.0f ? margin : 0.0f; }
+        float getFatMargin() const { return fatMargin; }
+        // 胖包围盒沿速度方向按 VelocityPredictionFactor 个预测时长外扩
+        static constexpr float VelocityPredictionFactor = 4.0f;
+        // 上次 update 中被重新插入的叶节点数
+        size_t getMovedCount() const { return lastMovedCount; }
 
     private:
-        AABBNode* root;
-        
-        void insertAABBNode(AABBNode* node);
-        void updateAABBNode(AABBNode* node);
-        void collectCollisionPairs(AABBNode* node1, AABBNode* node2, std::vector<std::pair<Entity*, Entity*>>& pairs);
-        bool checkAABBCollision(const AABB& aabb1, const AABB& aabb2);
-        AABB mergeAABB(const AABB& aabb1, const AABB& aabb2);
-        void deleteTree(AABBNode* node);
-
-        void printTree(AABBNode* node, int depth = 0);
+        AABBTree dynamicTree;
+        AABBTree staticTree;
+        std::vector<BroadPhaseProxy> proxies;
+        std::vector<uint32_t> dynamicProxies;     // 每次 update 需要刷新的 proxy
+        std::vector<uint32_t> pendingProxies;     // 已添加但尚未入树
+        ThreadPool* threadPool;
+        float predictionTime;
+        float aabbMargin;
+        float fatMargin;
+        size_t lastMovedCount;
+        float rebuildRatio;
+        size_t reinsertedSinceBuild;              // 上次重建以来重新插入的叶节点数
+
+        std::vector<uint32_t> movedProxies;                        // 等待在 collectCollisionPairs 中重新查询
+        std::vector<std::pair<uint32_t, uint32_t>> pairCache;      // 胖包围盒相交的 proxy 对，较小的 proxyId 在前
+
+        // 上次输出的碰撞对集合：哈希表的键为 makePairKey，值为 pairSlots 中的下标
+        struct PairSlot
+        {
+            uint64_t key;
+            uint32_t frame;          // 最后一次出现时的 pairFrame
+            uint32_t event;          // 本次在 pairEvents 中的下标，槽位被移动时用于更新事件中的 slot
+            PairCacheData data;
+        };
+        Hash_Map pairSet;
+        std::vector<PairSlot> pairSlots;
+        uint32_t pairFrame;
+        std::vector<PairEvent> pairEvents;
+        std::vector<PairEvent> addedPairs;
+        std::vector<PairEvent> removedPairs;
+
+        std::vector<AABBTree::RayStackEntry> rayStack;   // 单条射线查询复用的栈
+
+        AABBTree& treeOf(const BroadPhaseProxy& proxy) { return proxy.isStatic ? staticTree : dynamicTree; }
+        // 把 pendingProxies 放入各自的树中
+        void flushPending();
+        // 重建后叶节点重新编号，按叶节点的 userData 更新 proxy 保存的下标
+        void rebuildTree(AABBTree& tree);
+        void markMoved(uint32_t proxyId);
+        void queryMovedProxy(uint32_t proxyId);
+        // 动态树自查询加动态树与静态树互查，重新生成全部候选对
+        void querySelf();
+        void addCandidatePair(uint32_t proxyA, uint32_t proxyB);
+        void updatePairSet(std::vector<std::pair<Entity*, Entity*>>& pairs);
+        static bool containsAABB(const AABB& outer, const AABB& inner);
+        // 网格包围盒 + 速度扫掠 + 接触余量
+        void computeFitAABB(BroadPhaseProxy& proxy);
+        AABB computeFatAABB(const BroadPhaseProxy& proxy) const;
+        void updateProxy(uint32_t proxyId);
+        // 依次遍历动态树和静态树，callback(proxyId, maxDistance) 的返回值含义同 AABBTree::rayCast
+        template <typename Callback>
+        void rayCastTrees(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+            std::vector<AABBTree::RayStackEntry>& stack, Callback&& callback) const;
+        // 在两棵树中查询与 aabb 相交的 proxy
+        template <typename Callback>
+        void queryTrees(const AABB& aabb, Callback&& callback) const;
+        bool rayCastClosest(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+            std::vector<AABBTree::RayStackEntry>& stack, RayCastHit& hit) const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,137 +1,174 @@
 #include "physics/collision_narrow_phase.h"
+#include "physics/collider.h"
+#include "physics/gjk.h"
+#include "geometry/signed_distance_grid.h"
+#include "core/log.h"
+#include "core/profiler.h"
+#include <algorithm>
 #include <cmath>
-#include <iostream>
 #include <limits>
 
 CollisionNarrowPhase::CollisionNarrowPhase() {}
 
 CollisionNarrowPhase::~CollisionNarrowPhase() {}
 
-float CollisionNarrowPhase::computeSDF(const Entity* entity, const glm::vec3& point) 
+float CollisionNarrowPhase::computeSDF(const Entity* entity, const SignedDistanceGrid& grid, const glm::vec3& origin,
+                                       const glm::vec3& worldPoint, glm::vec3* gradient)
 {
-    // 获取实体的网格和位置
-    const Mesh* mesh = entity->getMesh();
-    glm::vec3 entityPos = entity->getPosition();
-    const std::vector<glm::vec3>& vertices = mesh->getPositions();
-    const std::vector<unsigned int>& indices = mesh->getIndices();
+    XPBD_PROFILE_ZONE("computeSDF");
+    // 把查询点变换到网格局部坐标系，在网格预先烘焙的距离场上插值
+    const glm::quat rotation = entity->getRotation();
+    glm::vec3 point = glm::inverse(rotation) * (worldPoint - origin);
 
-    if (vertices.empty() || indices.empty())
+    if (grid.empty())
     {
         // 默认球形 SDF（以中心为原点，半径 0.1）
-        float distance = glm::length(point - entityPos) - 0.1f;
-        return distance;
+        float distance = glm::length(point);
+        if (gradient) *gradient = distance > 0.0f ? rotation * (point / distance) : glm::vec3(0.0f);
+        return distance - 0.1f;
     }
 
-    // 计算点到网格表面的最小距离（局部坐标转换为世界坐标）
-    float minDistance = std::numeric_limits<float>::max();
-    glm::vec3 closestPoint;
-
-    // 遍历所有三角形（假设 indices 每 3 个为一组）
-    for (size_t i = 0; i < indices.size(); i += 3) {
-        // 获取三角形顶点（世界坐标）
-        glm::vec3 v0 = entityPos + vertices[indices[i]];
-        glm::vec3 v1 = entityPos + vertices[indices[i + 1]];
-        glm::vec3 v2 = entityPos + vertices[indices[i + 2]];
-
-        // 计算点到三角形的最近点
-        glm::vec3 edge0 = v1 - v0;
-        glm::vec3 edge1 = v2 - v0;
-        glm::vec3 v0p = point - v0;
-
-        float a = glm::dot(edge0, edge0);
-        float b = glm::dot(edge0, edge1);
-        float c = glm::dot(edge1, edge1);
-        float d = glm::dot(edge0, v0p);
-        float e = glm::dot(edge1, v0p);
-        float det = a * c - b * b;
-
-        float s = (c * d - b * e) / det;
-        float t = (a * e - b * d) / det;
-
-        // 限制 s 和 t 到三角形内
-        s = glm::clamp(s, 0.0f, 1.0f);
-        t = glm::clamp(t, 0.0f, 1.0f);
-        if (s + t > 1.0f) {
-            s = glm::clamp(s, 0.0f, 1.0f - t);
-            t = glm::clamp(t, 0.0f, 1.0f - s);
-        }
-
-        // 计算最近点
-        glm::vec3 closest = v0 + s * edge0 + t * edge1;
-        float distance = glm::length(point - closest);
-        if (distance < minDistance) {
-            minDistance = distance;
-            closestPoint = closest;
-        }
-    }
-
-    // 判断内外（使用最近点的法线方向）
-    glm::vec3 direction = point - closestPoint;
-    // 假设网格有法线数据（这里简化为从中心指向外部）
-    glm::vec3 avgNormal(0.0f);
-    for (size_t i = 0; i < indices.size(); i += 3) {
-        glm::vec3 v0 = vertices[indices[i]];
-        glm::vec3 v1 = vertices[indices[i + 1]];
-        glm::vec3 v2 = vertices[indices[i + 2]];
-        avgNormal += glm::normalize(glm::cross(v1 - v0, v2 - v0));
-    }
-    avgNormal = glm::normalize(avgNormal);
-
-    // 若 direction 与法线反向，则点在内部
-    float sign = (glm::dot(direction, avgNormal) >= 0.0f) ? 1.0f : -1.0f;
-    return sign * minDistance;
+    glm::vec3 localGradient(0.0f);
+    float distance = grid.sample(point, gradient ? &localGradient : nullptr);
+    if (gradient) *gradient = rotation * localGradient;
+    return distance;
 }
 
 bool CollisionNarrowPhase::resolveSDFCollision(const Entity* entityA, const glm::vec3& posA,
                                                const Entity* entityB, const glm::vec3& posB,
-                                               float& penetration, glm::vec3& normal) 
+                                               float& penetration, glm::vec3& normal, float& separation) 
 {
-    // 计算两实体中心的 SDF
-    float sdfAatB = computeSDF(entityA, posB); // B 中心相对于 A 的 SDF
-    float sdfBatA = computeSDF(entityB, posA); // A 中心相对于 B 的 SDF
+    // 计算两实体中心的 SDF；整个查询期间持有两侧的距离场
+    const std::shared_ptr<const SignedDistanceGrid> gridA = entityA->getMesh()->getSignedDistanceGrid();
+    const std::shared_ptr<const SignedDistanceGrid> gridB = entityB->getMesh()->getSignedDistanceGrid();
+    glm::vec3 gradientA(0.0f), gradientB(0.0f);
+    float sdfAatB = computeSDF(entityA, *gridA, posA, posB, &gradientA); // B 中心相对于 A 的 SDF
+    float sdfBatA = computeSDF(entityB, *gridB, posB, posA, &gradientB); // A 中心相对于 B 的 SDF
 
     // 计算两中心间的距离
     glm::vec3 direction = posB - posA;
     float distance = glm::length(direction);
 
+    // 由 A 指向 B 的方向：取中心离对方表面更近的一侧的 SDF 梯度（B 中心处 A 的梯度，或 A 中心处 B 的梯度取反），
+    // 它是该侧表面在最近点处的法线；梯度退化时退回两中心的连线
+    glm::vec3 towardB = sdfAatB <= sdfBatA ? gradientA : -gradientB;
+    float towardLength = glm::length(towardB);
+    if (towardLength > 1e-6f) {
+        direction = towardB / towardLength;
+    } else {
+        direction = (distance > 0.0001f) ? direction / distance : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+
     // 检查是否碰撞
     if (sdfAatB < 0.0f || sdfBatA < 0.0f) {
         // 至少一个中心在另一个物体内部，确认碰撞
         penetration = std::max(std::abs(sdfAatB), std::abs(sdfBatA));
 
         // 法线方向：从深入较深的物体指向另一个
-        normal = (distance > 0.0001f) ? direction / distance : glm::vec3(0.0f, 1.0f, 0.0f);
+        normal = direction;
         if (sdfAatB < sdfBatA) {
             normal = -normal; // B 更深入 A，法线从 B 指向 A
         }
 
+        separation = -penetration;
         return true;
     }
 
-    // 若中心间距离小于 SDF 和（正值情况），仍可能碰撞
+    // 两中心都在对方外部：sdfAatB = distance - rA，sdfBatA = distance - rB（rA、rB 为沿中心连线的表面距离）
+    // 穿透深度 = rA + rB - distance = distance - (sdfAatB + sdfBatA)
     float threshold = sdfAatB + sdfBatA;
-    if (distance < threshold && threshold > 0.0f) {
-        penetration = threshold - distance;
-        normal = (distance > 0.0001f) ? direction / distance : glm::vec3(0.0f, 1.0f, 0.0f);
+    if (distance > threshold && threshold > 0.0f) {
+        penetration = distance - threshold;
+        normal = direction;
         if (sdfAatB < sdfBatA) {
             normal = -normal;
         }
+        separation = -penetration;
         return true;
     }
 
+    // 未碰撞时同样给出法线（分离方向），供连续碰撞检测在接近接触时使用
+    normal = direction;
+    if (sdfAatB < sdfBatA) {
+        normal = -normal;
+    }
+    separation = std::max(threshold - distance, 0.0f);
     return false;
 }
 
+bool CollisionNarrowPhase::resolveConvexCollision(const Entity* entityA, const glm::vec3& posA,
+                                                  const Entity* entityB, const glm::vec3& posB,
+                                                  float& penetration, glm::vec3& normal, float& separation,
+                                                  unsigned int* supportHintA, unsigned int* supportHintB,
+                                                  glm::vec3* separatingAxis)
+{
+    XPBD_PROFILE_ZONE("resolveConvexCollision");
+    ConvexShape shapeA{ entityA->getCollider(), posA, entityA->getRotation(), supportHintA };
+    ConvexShape shapeB{ entityB->getCollider(), posB, entityB->getRotation(), supportHintB };
+
+    // 上一帧的分离轴通常仍然有效，布尔 GJK 几次支撑查询即可确认分离，不必求精确距离
+    if (separatingAxis && !gjkIntersect(shapeA, shapeB, *separatingAxis, &separation))
+    {
+        normal = *separatingAxis;
+        penetration = 0.0f;
+        return false;
+    }
+
+    ConvexContact contact;
+    bool collided = computeConvexContact(shapeA, shapeB, contact);
+    separation = contact.separation;
+    normal = contact.normal;
+    penetration = collided ? -contact.separation : 0.0f;
+    if (separatingAxis) *separatingAxis = contact.normal;
+    return collided;
+}
+
 bool CollisionNarrowPhase::detectCollision(const Entity* entityA, const glm::vec3& posA,
                                            const Entity* entityB, const glm::vec3& posB,
                                            float& penetration, glm::vec3& normal) 
 {
-    // 调用 SDF 碰撞解析
-    bool collided = resolveSDFCollision(entityA, posA, entityB, posB, penetration, normal);
+    float separation;
+    return detectCollision(entityA, posA, entityB, posB, penetration, normal, separation);
+}
+
+bool CollisionNarrowPhase::detectCollision(const Entity* entityA, const glm::vec3& posA,
+                                           const Entity* entityB, const glm::vec3& posB,
+                                           float& penetration, glm::vec3& normal, float& separation)
+{
+    return detectCollision(entityA, posA, entityB, posB, penetration, normal, separation, nullptr, nullptr);
+}
+
+bool CollisionNarrowPhase::detectCollision(const Entity* entityA, const glm::vec3& posA,
+                                           const Entity* entityB, const glm::vec3& posB,
+                                           float& penetration, glm::vec3& normal, float& separation,
+                                           unsigned int* supportHintA, unsigned int* supportHintB,
+                                           glm::vec3* separatingAxis)
+{
+    // 两侧都有凸碰撞体时用 GJK/EPA，代价与支撑函数的调用次数成正比；否则用网格 SDF
+    bool collided;
+    if (entityA->getCollider() && entityB->getCollider())
+    {
+        collided = resolveConvexCollision(entityA, posA, entityB, posB, penetration, normal, separation,
+                                          supportHintA, supportHintB, separatingAxis);
+    }
+    else
+    {
+        collided = resolveSDFCollision(entityA, posA, entityB, posB, penetration, normal, separation);
+        if (separatingAxis)
+        {
+            // SDF 的法线可能由 B 指向 A，统一为由 A 指向 B；未碰撞时取两中心的连线
+            glm::vec3 direction = posB - posA;
+            float distance = glm::length(direction);
+            if (collided)
+                *separatingAxis = glm::dot(normal, direction) < 0.0f ? -normal : normal;
+            else
+                *separatingAxis = distance > 0.0f ? direction / distance : glm::vec3(0.0f);
+        }
+    }
 
     if (collided) {
-        std::cout << "Collision detected: Penetration = " << penetration
-                  << ", Normal = (" << normal.x << ", " << normal.y << ", " << normal.z << ")\n";
+        XPBD_LOG_TRACE(NarrowPhase, "Collision detected: Penetration = %g, Normal = (%g, %g, %g)",
+                       penetration, normal.x, normal.y, normal.z);
     }
     return collided;
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <vector>
 #include "physics/entity.h"
 
+class SignedDistanceGrid;
+
 class CollisionNarrowPhase
 {
     public:
@@ -16,15 +18,36 @@ class CollisionNarrowPhase
         bool detectCollision(const Entity* entityA, const glm::vec3& posA,
             const Entity* entityB, const glm::vec3& posB,
             float& penetration, glm::vec3& normal);
+        // 同时给出间隙 separation：未碰撞时为两表面沿中心连线的距离，碰撞时为 -penetration
+        // 间隙随两实体的相对位移和转角连续变化，调用者可据此判断下次检测前能否直接判为不碰撞
+        bool detectCollision(const Entity* entityA, const glm::vec3& posA,
+            const Entity* entityB, const glm::vec3& posB,
+            float& penetration, glm::vec3& normal, float& separation);
+        // supportHintA/B 为调用者跨帧保存的支撑顶点下标（如 PairCacheData::featureA/B），只对凸碰撞体有效
+        // separatingAxis 为调用者跨帧保存的由 A 指向 B 的方向（如 PairCacheData::separatingAxis），返回时更新为本次的
+        // 接触法线或分离方向；凸碰撞体先沿它做布尔 GJK，找到分离轴即跳过距离 GJK/EPA，separation 为沿轴的间隙（真实距离的下界）
+        bool detectCollision(const Entity* entityA, const glm::vec3& posA,
+            const Entity* entityB, const glm::vec3& posB,
+            float& penetration, glm::vec3& normal, float& separation,
+            unsigned int* supportHintA, unsigned int* supportHintB, glm::vec3* separatingAxis = nullptr);
 
     private:
-        // 计算实体在给定位置的 SDF 值
-        float computeSDF(const Entity* entity, const glm::vec3& point);
+        // 计算实体（质心位于 origin，朝向取实体当前朝向）在给定世界坐标点处的 SDF 值，grid 为实体网格的距离场
+        // gradient 非空时给出世界坐标系下的 SDF 梯度（未归一化），指向距离增大的方向
+        float computeSDF(const Entity* entity, const SignedDistanceGrid& grid, const glm::vec3& origin,
+                         const glm::vec3& worldPoint, glm::vec3* gradient = nullptr);
+
+        // 两个凸碰撞体：GJK 求距离，核心相交时 EPA 求穿透深度和法线
+        bool resolveConvexCollision(const Entity* entityA, const glm::vec3& posA,
+                                    const Entity* entityB, const glm::vec3& posB,
+                                    float& penetration, glm::vec3& normal, float& separation,
+                                    unsigned int* supportHintA, unsigned int* supportHintB,
+                                    glm::vec3* separatingAxis);
 
         // 根据两个实体的 SDF 计算碰撞信息
         bool resolveSDFCollision(const Entity* entityA, const glm::vec3& posA,
                                 const Entity* entityB, const glm::vec3& posB,
-                                float& penetration, glm::vec3& normal);
+                                float& penetration, glm::vec3& normal, float& separation);
 };
 
 #endif
\ No newline at end of file
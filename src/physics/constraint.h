@@ -2,20 +2,150 @@
 #define CONSTRAINT_H
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
 #include "physics/entity.h"
 
+// Jacobi 模式下约束对单个刚体的修正量
+// 位置阶段 linear 为 Δx、angular 为旋转向量 Δθ；速度阶段分别为 Δv 和 Δω
+struct BodyDelta
+{
+    glm::vec3 linear = glm::vec3(0.0f);
+    glm::vec3 angular = glm::vec3(0.0f);
+};
+
 class Constraint
 {
 public:
     virtual ~Constraint() = default;
+    // 位置投影，timeStep 为子步长；iteration == 0 时重置累积的拉格朗日乘子
     virtual void solve(float timeStep, int iteration) = 0; // 求解约束
+    // 速度修正（反弹、摩擦等），在每个子步由位置差分出速度之后调用
+    virtual void solveVelocity(float /*timeStep*/) {}
     virtual float getCompliance() const { return compliance; } // 返回顺应性
     virtual void setCompliance(float c) { compliance = c; } // 设置顺应性
+    float getLambda() const { return lambda; } // 当前子步累积的拉格朗日乘子
+    const std::vector<Entity*>& getEntities() const { return entities; }
+
+    // Jacobi 模式：修正量累加到 deltas[k]（对应 entities[k]），不直接修改刚体
+    // constraintCounts 按刚体下标给出每个刚体参与的约束数，用于质量分裂；deltas 为空时恢复 Gauss-Seidel 模式
+    void setJacobiOutput(BodyDelta* deltas, const uint32_t* constraintCounts)
+    {
+        jacobiDeltas = deltas;
+        jacobiCounts = constraintCounts;
+    }
 
 protected:
-    float compliance; // 顺应性 (1/stiffness)，单位为 dt^2
+    float compliance = 0.0f; // 顺应性 (1/stiffness)，单位为 dt^2
+    float lambda = 0.0f; // 累积的拉格朗日乘子
     std::vector<Entity*> entities; // 参与约束的实体
+    BodyDelta* jacobiDeltas = nullptr;       // Jacobi 模式下的输出槽位
+    const uint32_t* jacobiCounts = nullptr;  // Jacobi 模式下各刚体参与的约束数
+
+    // 质量分裂：刚体被 n 个约束共享时，每个约束只看到 1/n 的质量（逆质量乘 n）
+    float massSplit(const Entity* e) const
+    {
+        if (jacobiCounts == nullptr) return 1.0f;
+        uint32_t count = jacobiCounts[e->getBodyIndex()];
+        return (count > 1) ? static_cast<float>(count) : 1.0f;
+    }
+
+    // 两个刚体沿 n 方向的 XPBD 位置修正（约束对 e1 的梯度为 n，对 e2 为 -n）
+    // e1、e2 须为 entities[0]、entities[1]；r1、r2 为约束点相对各自质心的世界坐标偏移，C 为当前约束值
+    void applyPositionalCorrection(Entity* e1, Entity* e2, const glm::vec3& r1, const glm::vec3& r2,
+                                   const glm::vec3& n, float C, float timeStep)
+    {
+        glm::vec3 rn1 = glm::cross(r1, n);
+        glm::vec3 rn2 = glm::cross(r2, n);
+        glm::mat3 I_inv1 = e1->getWorldInverseInertia();
+        glm::mat3 I_inv2 = e2->getWorldInverseInertia();
+        float w1 = massSplit(e1) * (e1->getInverseMass() + glm::dot(rn1, I_inv1 * rn1));
+        float w2 = massSplit(e2) * (e2->getInverseMass() + glm::dot(rn2, I_inv2 * rn2));
+        float alpha = compliance / (timeStep * timeStep);
+        float denominator = w1 + w2 + alpha;
+        if (denominator <= 0.0f) return;
+
+        float deltaLambda = (-C - alpha * lambda) / denominator;
+        lambda += deltaLambda;
+
+        glm::vec3 p = n * deltaLambda;
+        if (jacobiDeltas != nullptr)
+        {
+            // 各子刚体的修正取平均后恰好是按原质量施加冲量 p，由系统统一累加并松弛
+            jacobiDeltas[0].linear += p * e1->getInverseMass();
+            jacobiDeltas[0].angular += I_inv1 * glm::cross(r1, p);
+            jacobiDeltas[1].linear -= p * e2->getInverseMass();
+            jacobiDeltas[1].angular -= I_inv2 * glm::cross(r2, p);
+            return;
+        }
+
+        // 静态刚体不写入，着色时它们不参与冲突判断，并行求解时不能产生写操作
+        if (e1->getInverseMass() > 0.0f)
+        {
+            e1->setPosition(e1->getPosition() + p * e1->getInverseMass());
+            rotate(e1, I_inv1 * glm::cross(r1, p));
+        }
+        if (e2->getInverseMass() > 0.0f)
+        {
+            e2->setPosition(e2->getPosition() - p * e2->getInverseMass());
+            rotate(e2, -(I_inv2 * glm::cross(r2, p)));
+        }
+    }
+
+    // 约束点处的速度修正：把相对速度改变 deltaV（e1 相对 e2）换算为冲量施加到两个刚体
+    // e1、e2 须为 entities[0]、entities[1]
+    void applyVelocityCorrection(Entity* e1, Entity* e2, const glm::vec3& r1, const glm::vec3& r2,
+                                 const glm::vec3& deltaV)
+    {
+        float magnitude = glm::length(deltaV);
+        if (magnitude < 1e-9f) return;
+        glm::vec3 n = deltaV / magnitude;
+
+        glm::vec3 rn1 = glm::cross(r1, n);
+        glm::vec3 rn2 = glm::cross(r2, n);
+        glm::mat3 I_inv1 = e1->getWorldInverseInertia();
+        glm::mat3 I_inv2 = e2->getWorldInverseInertia();
+        float w1 = massSplit(e1) * (e1->getInverseMass() + glm::dot(rn1, I_inv1 * rn1));
+        float w2 = massSplit(e2) * (e2->getInverseMass() + glm::dot(rn2, I_inv2 * rn2));
+        if (w1 + w2 <= 0.0f) return;
+
+        glm::vec3 p = n * (magnitude / (w1 + w2));
+        if (jacobiDeltas != nullptr)
+        {
+            jacobiDeltas[0].linear += p * e1->getInverseMass();
+            jacobiDeltas[0].angular += I_inv1 * glm::cross(r1, p);
+            jacobiDeltas[1].linear -= p * e2->getInverseMass();
+            jacobiDeltas[1].angular -= I_inv2 * glm::cross(r2, p);
+            return;
+        }
+
+        if (e1->getInverseMass() > 0.0f)
+        {
+            e1->setLinearVelocity(e1->getLinearVelocity() + p * e1->getInverseMass());
+            e1->setAngularVelocity(e1->getAngularVelocity() + I_inv1 * glm::cross(r1, p));
+        }
+        if (e2->getInverseMass() > 0.0f)
+        {
+            e2->setLinearVelocity(e2->getLinearVelocity() - p * e2->getInverseMass());
+            e2->setAngularVelocity(e2->getAngularVelocity() - I_inv2 * glm::cross(r2, p));
+        }
+    }
+
+    // 按旋转向量 dTheta 更新朝向：q += 0.5 * [dTheta, 0] * q
+    static void rotate(Entity* e, const glm::vec3& dTheta)
+    {
+        if (e->getInverseMass() == 0.0f) return;
+        glm::quat q = e->getRotation();
+        glm::quat dq = glm::quat(0.0f, dTheta.x, dTheta.y, dTheta.z) * q;
+        q.x += 0.5f * dq.x;
+        q.y += 0.5f * dq.y;
+        q.z += 0.5f * dq.z;
+        q.w += 0.5f * dq.w;
+        e->setRotation(glm::normalize(q));
+    }
 };
 
 class DistanceConstraint : public Constraint
@@ -31,39 +161,40 @@ public:
 
     void solve(float timeStep, int iteration) override
     {
+        if (iteration == 0) lambda = 0.0f;
+
         Entity* e1 = entities[0];
         Entity* e2 = entities[1];
-        glm::vec3 p1 = e1->getPosition();
-        glm::vec3 p2 = e2->getPosition();
-        glm::vec3 delta = p2 - p1;
+        glm::vec3 delta = e1->getPosition() - e2->getPosition();
         float currentDistance = glm::length(delta);
-        if (currentDistance < 0.0001f) currentDistance = 0.0001f; // 避免除零
+        if (currentDistance < 0.0001f) return; // 避免除零
 
         float constraint = currentDistance - restLength;
         glm::vec3 gradient = delta / currentDistance;
-        float w1 = 1.0f / e1->getMass();
-        float w2 = 1.0f / e2->getMass();
-        float denominator = w1 + w2 + compliance / (timeStep * timeStep);
-        float lambda = -constraint / denominator;
-
-        glm::vec3 correction = gradient * (lambda / (w1 + w2));
-        e1->setPosition(p1 - correction * w1);
-        e2->setPosition(p2 + correction * w2);
+        applyPositionalCorrection(e1, e2, glm::vec3(0.0f), glm::vec3(0.0f), gradient, constraint, timeStep);
     }
 
 private:
     float restLength; // 目标距离
 };
 
+// 接触约束：法线 normal 从 e1 指向 e2，约束点以局部坐标保存，每个子步按当前姿态重新计算穿透深度
+// 仅在穿透时生效（不等式约束），因此可以在预测位置上提前生成（推测式接触）
 class CollisionConstraint : public Constraint
 {
 public:
-    CollisionConstraint(Entity* e1, Entity* e2, float penetration, const glm::vec3& normal)
+    // r1、r2 为接触点相对各自质心的世界坐标偏移，gravity 为求解器的重力加速度大小，决定反弹的速度阈值
+    CollisionConstraint(Entity* e1, Entity* e2, const glm::vec3& r1, const glm::vec3& r2, const glm::vec3& normal,
+                        float gravity, float restitution = 0.5f, float friction = 0.2f)
     {
         entities.push_back(e1);
         entities.push_back(e2);
-        this->penetration = penetration;
+        localAnchor1 = glm::inverse(e1->getRotation()) * r1;
+        localAnchor2 = glm::inverse(e2->getRotation()) * r2;
         this->normal = normal;
+        this->gravity = gravity;
+        this->restitution = restitution;
+        this->friction = friction;
         compliance = 0.0f; // 刚性碰撞
     }
 
@@ -71,38 +202,72 @@ public:
     {
         Entity* e1 = entities[0];
         Entity* e2 = entities[1];
-        glm::vec3 p1 = e1->getPosition();
-        glm::vec3 p2 = e2->getPosition();
-
-        float constraint = penetration;
-        glm::vec3 gradient = normal;
-        float w1 = 1.0f / e1->getMass();
-        float w2 = 1.0f / e2->getMass();
-        float denominator = w1 + w2 + compliance / (timeStep * timeStep);
-        float lambda = -constraint / denominator;
-
-        glm::vec3 correction = gradient * (lambda / (w1 + w2));
-        e1->setPosition(p1 - correction * w1);
-        e2->setPosition(p2 + correction * w2);
-
-        // 速度更新（反弹）
-        glm::vec3 v1 = e1->getVelocity();
-        glm::vec3 v2 = e2->getVelocity();
-        glm::vec3 relativeVelocity = v1 - v2;
-        float velocityAlongNormal = glm::dot(relativeVelocity, normal);
-        if (velocityAlongNormal > 0) return;
-
-        float restitution = 0.8f;
-        float impulse = -(1.0f + restitution) * velocityAlongNormal;
-        impulse /= (w1 + w2);
-        glm::vec3 impulseVector = normal * impulse;
-        e1->setVelocity(v1 - impulseVector * w1);
-        e2->setVelocity(v2 + impulseVector * w2);
+        glm::vec3 r1 = e1->getRotation() * localAnchor1;
+        glm::vec3 r2 = e2->getRotation() * localAnchor2;
+
+        if (iteration == 0)
+        {
+            lambda = 0.0f;
+            // 记录位置求解前的法向相对速度，用于速度阶段计算反弹
+            preSolveNormalVelocity = glm::dot(relativeVelocity(r1, r2), normal);
+        }
+
+        float penetration = glm::dot((e1->getPosition() + r1) - (e2->getPosition() + r2), normal);
+        if (penetration <= 0.0f) return;
+
+        applyPositionalCorrection(e1, e2, r1, r2, normal, penetration, timeStep);
     }
 
+    void solveVelocity(float timeStep) override
+    {
+        // 本子步位置阶段未产生接触力，则不做速度修正
+        if (lambda == 0.0f) return;
+
+        Entity* e1 = entities[0];
+        Entity* e2 = entities[1];
+        glm::vec3 r1 = e1->getRotation() * localAnchor1;
+        glm::vec3 r2 = e2->getRotation() * localAnchor2;
+
+        glm::vec3 v = relativeVelocity(r1, r2);
+        float vn = glm::dot(v, normal);
+        glm::vec3 vt = v - normal * vn;
+        glm::vec3 deltaV(0.0f);
+
+        // 动摩擦：切向速度的减少量不超过 μ * |f_n| * h
+        float vtLength = glm::length(vt);
+        if (vtLength > 1e-6f)
+        {
+            float normalForce = std::fabs(lambda) / (timeStep * timeStep);
+            deltaV -= vt / vtLength * std::min(timeStep * friction * normalForce, vtLength);
+        }
+
+        // 反弹：低速接触不反弹，避免静止物体抖动；阈值为重力在两个子步内产生的速度
+        float e = (preSolveNormalVelocity > 2.0f * gravity * timeStep) ? restitution : 0.0f;
+        float targetVn = -e * std::max(preSolveNormalVelocity, 0.0f);
+        deltaV += normal * std::min(targetVn - vn, 0.0f);
+
+        applyVelocityCorrection(e1, e2, r1, r2, deltaV);
+    }
+
+    glm::vec3 getNormal() const { return normal; }
+
 private:
-    float penetration;
+    glm::vec3 localAnchor1;  // e1 上的接触点（局部坐标）
+    glm::vec3 localAnchor2;  // e2 上的接触点（局部坐标）
     glm::vec3 normal;
+    float gravity;       // 重力加速度大小
+    float restitution;
+    float friction;
+    float preSolveNormalVelocity = 0.0f; // 正值表示相互接近
+
+    glm::vec3 relativeVelocity(const glm::vec3& r1, const glm::vec3& r2) const
+    {
+        const Entity* e1 = entities[0];
+        const Entity* e2 = entities[1];
+        glm::vec3 v1 = e1->getLinearVelocity() + glm::cross(e1->getAngularVelocity(), r1);
+        glm::vec3 v2 = e2->getLinearVelocity() + glm::cross(e2->getAngularVelocity(), r2);
+        return v1 - v2;
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,84 @@
+#include "physics/constraint_graph.h"
+#include <algorithm>
+
+uint64_t& ConstraintGraph::bodyMask(uint32_t bodyIndex)
+{
+    if (bodyIndex >= bodyColorMasks.size())
+    {
+        bodyColorMasks.resize(bodyIndex + 1, 0);
+    }
+    return bodyColorMasks[bodyIndex];
+}
+
+void ConstraintGraph::addConstraint(Constraint* constraint)
+{
+    if (constraint == nullptr || constraintColors.count(constraint)) return;
+
+    // 汇总所有动态刚体已占用的颜色
+    uint64_t used = 0;
+    for (const Entity* entity : constraint->getEntities())
+    {
+        if (entity->getInverseMass() == 0.0f) continue;
+        used |= bodyMask(entity->getBodyIndex());
+    }
+
+    int color = MaxParallelColors;
+    if (~used != 0)
+    {
+        // 最低位的 0 即为可用的最小颜色
+        uint64_t freeBits = ~used;
+        color = 0;
+        while ((freeBits & 1) == 0)
+        {
+            freeBits >>= 1;
+            ++color;
+        }
+        for (const Entity* entity : constraint->getEntities())
+        {
+            if (entity->getInverseMass() == 0.0f) continue;
+            bodyMask(entity->getBodyIndex()) |= (uint64_t(1) << color);
+        }
+    }
+
+    if (color >= static_cast<int>(colors.size()))
+    {
+        colors.resize(color + 1);
+    }
+    colors[color].push_back(constraint);
+    constraintColors[constraint] = color;
+}
+
+void ConstraintGraph::removeConstraint(Constraint* constraint)
+{
+    auto it = constraintColors.find(constraint);
+    if (it == constraintColors.end()) return;
+
+    int color = it->second;
+    constraintColors.erase(it);
+
+    std::vector<Constraint*>& list = colors[color];
+    list.erase(std::remove(list.begin(), list.end(), constraint), list.end());
+
+    // 同一颜色内每个刚体至多出现一次，因此可以直接清除对应位
+    if (color < MaxParallelColors)
+    {
+        for (const Entity* entity : constraint->getEntities())
+        {
+            if (entity->getInverseMass() == 0.0f) continue;
+            bodyMask(entity->getBodyIndex()) &= ~(uint64_t(1) << color);
+        }
+    }
+
+    // 去掉末尾的空颜色
+    while (!colors.empty() && colors.back().empty())
+    {
+        colors.pop_back();
+    }
+}
+
+void ConstraintGraph::clear()
+{
+    colors.clear();
+    std::fill(bodyColorMasks.begin(), bodyColorMasks.end(), 0);
+    constraintColors.clear();
+}
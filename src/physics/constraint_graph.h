@@ -0,0 +1,37 @@
+#ifndef CONSTRAINT_GRAPH_H
+#define CONSTRAINT_GRAPH_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "physics/constraint.h"
+
+// 约束图着色：同一颜色内的约束不共享任何动态刚体，可以无锁并行求解
+// 静态刚体（逆质量为 0）不会被约束写入，因此不参与冲突判断
+// 着色是增量维护的：添加约束时贪心地选取两端刚体都未使用的最小颜色，删除时只从所在颜色中移除
+class ConstraintGraph
+{
+    public:
+        // 位掩码能区分的颜色数，超出的约束放入最后一个“溢出”颜色，该颜色只能串行求解
+        static const int MaxParallelColors = 64;
+
+        void addConstraint(Constraint* constraint);
+        void removeConstraint(Constraint* constraint);
+        void clear();
+
+        // 颜色数量（包含可能存在的溢出颜色）
+        int getColorCount() const { return static_cast<int>(colors.size()); }
+        const std::vector<Constraint*>& getColor(int color) const { return colors[color]; }
+        // 溢出颜色内的约束可能共享刚体，必须串行求解
+        bool isSerialColor(int color) const { return color >= MaxParallelColors; }
+        size_t getConstraintCount() const { return constraintColors.size(); }
+
+    private:
+        std::vector<std::vector<Constraint*>> colors;             // 每种颜色的约束列表
+        std::vector<uint64_t> bodyColorMasks;                     // 每个刚体已被哪些颜色占用
+        std::unordered_map<Constraint*, int> constraintColors;    // 约束 -> 颜色
+
+        uint64_t& bodyMask(uint32_t bodyIndex);
+};
+
+#endif
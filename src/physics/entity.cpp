@@ -2,8 +2,10 @@
 #include <iostream>
 
 Entity::Entity(Mesh* m, const glm::vec3& pos, float mas)
-    : mesh(m), position(pos), linear_velocity(0.0f), angular_velocity(0.0f), rotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f)), mass(mas), inverse_mass((mas != 0.0f) ? 1.0f / mas : 0.0f), force(0.0f), torque(0.0f), fixed(false)
+    : mesh(m), collider(nullptr), store(nullptr), bodyIndex(0), localStore(new BodyStore())
 {
+    store = localStore.get();
+    bodyIndex = store->addBody(pos, mas);
     if (mesh == nullptr) {
         std::cerr << "Error: Entity created with null Mesh pointer" << std::endl;
     }
@@ -12,4 +14,15 @@ Entity::Entity(Mesh* m, const glm::vec3& pos, float mas)
 Entity::~Entity()
 {
     // 其他资源（如 mesh）由调用者管理，避免双重删除
-}
\ No newline at end of file
+}
+
+void Entity::attachToStore(BodyStore* target)
+{
+    if (target == nullptr || target == store)
+    {
+        return;
+    }
+    bodyIndex = target->copyBody(*store, bodyIndex);
+    store = target;
+    localStore.reset();
+}
@@ -3,61 +3,81 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
-#include "render/mesh.h"
+#include <cstdint>
+#include <memory>
+#include "geometry/mesh.h"
+#include "physics/body_store.h"
 
+class Collider;
+
+// 刚体句柄：物理状态存放在 BodyStore 的结构化数组中，Entity 只保存网格和下标
+// 加入 XPBDSystem 之前，状态暂存在实体自己的单元素 BodyStore 中
 class Entity
 {
     public:
         Entity(Mesh* mesh, const glm::vec3& position, float mass = 1.0f);
         ~Entity();
 
+        // 将状态迁移到共享的 BodyStore，之后所有读写都直接作用于该存储
+        void attachToStore(BodyStore* target);
+        BodyStore* getStore() const { return store; }
+        uint32_t getBodyIndex() const { return bodyIndex; }
+
         // 获取和设置物理属性
         Mesh* getMesh() const { return mesh; }
+        // 凸碰撞体（局部坐标系，原点为质心），由调用者管理；两侧都设置时窄相使用 GJK/EPA，否则使用网格 SDF
+        const Collider* getCollider() const { return collider; }
+        void setCollider(const Collider* c) { collider = c; }
+
+        glm::vec3 getPosition() const { return store->positions[bodyIndex]; }
+        void setPosition(const glm::vec3& pos) { store->positions[bodyIndex] = pos; }
+
+        glm::vec3 getLinearVelocity() const { return store->linearVelocities[bodyIndex]; }
+        void setLinearVelocity(const glm::vec3& vel) { store->linearVelocities[bodyIndex] = vel; }
+
+        glm::vec3 getAngularVelocity() const { return store->angularVelocities[bodyIndex]; }
+        void setAngularVelocity(const glm::vec3& ang_vel) { store->angularVelocities[bodyIndex] = ang_vel; }
+
+        glm::quat getRotation() const { return store->rotations[bodyIndex]; }
+        void setRotation(const glm::quat& rot) { store->rotations[bodyIndex] = rot; }
+
+        float getMass() const { return store->masses[bodyIndex]; }
+        void setMass(const float m) { store->setMass(bodyIndex, m); }
+
+        float getInverseMass() const { return store->inverseMasses[bodyIndex]; }
 
-        glm::vec3 getPosition() const { return position; }
-        void setPosition(const glm::vec3& pos) { position = pos; }
+        glm::mat4x4 getIRef() const { return glm::mat4x4(store->inertiaRefs[bodyIndex]); }
+        void setIRef(const glm::mat4x4& ref) { store->setInertiaRef(bodyIndex, glm::mat3(ref)); }
 
-        glm::vec3 getLinearVelocity() const { return linear_velocity; }
-        void setLinearVelocity(const glm::vec3& vel) { linear_velocity = vel; }
+        // 世界坐标系下的惯量矩阵逆
+        glm::mat3 getWorldInverseInertia() const { return store->getWorldInverseInertia(bodyIndex); }
 
-        glm::vec3 getAngularVelocity() const { return angular_velocity; }
-        void setAngularVelocity(const glm::vec3& ang_vel) { angular_velocity = ang_vel; }
+        // 施加外力/力矩会唤醒休眠中的刚体
+        glm::vec3 getForce() const { return store->forces[bodyIndex]; }
+        void addForce(const glm::vec3& f) { store->forces[bodyIndex] += f; store->wakeUp(bodyIndex); }
 
-        glm::quat getRotation() const { return rotation; }
-        void setRotation(const glm::quat& rot) { rotation = rot; }
+        glm::vec3 getTorque() const { return store->torques[bodyIndex]; }
+        void addTorque(const glm::vec3& t) { store->torques[bodyIndex] += t; store->wakeUp(bodyIndex); }
 
-        float getMass() const { return mass; }
-        void setMass(const float m) { mass = m; }
+        void clearForces() { store->forces[bodyIndex] = glm::vec3(0.0f); store->torques[bodyIndex] = glm::vec3(0.0f); }
 
-        float getInverseMass() const { return (mass != 0.0f) ? 1.0f / mass : 0.0f; }
+        bool isFixed() const { return store->fixedFlags[bodyIndex] != 0; }
+        void setFixed(bool f) { store->setFixed(bodyIndex, f); }
 
-        glm::mat4x4 getIRef() const { return I_ref; }
+        // 快速运动的刚体（如子弹）开启后，每个时间步沿运动路径求碰撞时间，避免穿过其他刚体
+        bool isCCDEnabled() const { return store->ccdFlags[bodyIndex] != 0; }
+        void setCCDEnabled(bool enabled) { store->ccdFlags[bodyIndex] = enabled ? 1 : 0; }
 
-        glm::vec3 getForce() const { return force; }
-        void addForce(const glm::vec3& f) { force += f; }
-        
-        glm::vec3 getTorque() const { return torque; }
-        void addTorque(const glm::vec3& t) { torque += t; }
-        
-        void setIRef(const glm::mat4x4& ref) { I_ref = ref; }
-        
-        void clearForces() { force = glm::vec3(0.0f); torque = glm::vec3(0.0f); }
-        
-        bool isFixed() const { return fixed; }
-        void setFixed(bool f) { fixed = f; }
+        bool isSleeping() const { return store->isSleeping(bodyIndex); }
+        // 直接修改位置或速度后应调用，保证休眠中的刚体重新参与仿真
+        void wakeUp() { store->wakeUp(bodyIndex); }
 
     private:
         Mesh* mesh;
-        glm::vec3 position; // 世界位置
-        glm::vec3 linear_velocity;
-        glm::vec3 angular_velocity;
-        glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f); // 四元数表示旋转
-        float mass;
-        float inverse_mass;
-        glm::mat4x4 I_ref;
-        glm::vec3 force;
-        glm::vec3 torque;
-        bool fixed;
+        const Collider* collider;
+        BodyStore* store;                       // 当前状态所在的存储
+        uint32_t bodyIndex;                     // 在 store 中的下标
+        std::unique_ptr<BodyStore> localStore;  // 加入系统前使用的私有存储
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,454 @@
+#include "physics/gjk.h"
+#include "geometry/geometry_util.h"
+#include "core/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    const int MaxGJKIterations = 64;
+    const int MaxEPAIterations = 64;
+    // 距离平方低于该值时认为原点在单纯形上（核心相交或接触）
+    const float TouchToleranceSq = 1e-12f;
+    // GJK 的相对收敛阈值：|v|^2 - v·w <= 阈值 * |v|^2 时 v 已是最近点
+    const float GJKRelativeTolerance = 1e-6f;
+    // EPA 新支撑点比最近面远出不到该距离时停止扩展
+    const float EPATolerance = 1e-5f;
+
+    // Minkowski 差 A - B 上的点及其来源，用于由重心坐标还原两侧的最近点
+    struct SupportPoint
+    {
+        glm::vec3 w;
+        glm::vec3 a;
+        glm::vec3 b;
+    };
+
+    struct Simplex
+    {
+        SupportPoint points[4];
+        float lambdas[4];    // 最近点的重心坐标
+        int count;
+    };
+
+    // 调用者没有提供支撑顶点下标时换用临时下标，单次查询内相邻的支撑方向同样接近
+    ConvexShape withSupportHint(const ConvexShape& shape, unsigned int& localHint)
+    {
+        ConvexShape result = shape;
+        if (!result.supportHint)
+        {
+            localHint = 0;
+            result.supportHint = &localHint;
+        }
+        return result;
+    }
+
+    SupportPoint supportCore(const ConvexShape& a, const ConvexShape& b, const glm::vec3& direction)
+    {
+        SupportPoint p;
+        p.a = a.coreSupport(direction);
+        p.b = b.coreSupport(-direction);
+        p.w = p.a - p.b;
+        return p;
+    }
+
+    SupportPoint supportFull(const ConvexShape& a, const ConvexShape& b, const glm::vec3& direction)
+    {
+        SupportPoint p;
+        p.a = a.support(direction);
+        p.b = b.support(-direction);
+        p.w = p.a - p.b;
+        return p;
+    }
+
+    void setSimplex1(Simplex& s, const SupportPoint& a)
+    {
+        s.points[0] = a;
+        s.lambdas[0] = 1.0f;
+        s.count = 1;
+    }
+
+    void setSimplex2(Simplex& s, const SupportPoint& a, const SupportPoint& b, float t)
+    {
+        s.points[0] = a;
+        s.points[1] = b;
+        s.lambdas[0] = 1.0f - t;
+        s.lambdas[1] = t;
+        s.count = 2;
+    }
+
+    // 三角形上离原点最近的点（按 Voronoi 区域分类），结果写入 out 并缩减为所在的子单纯形
+    void closestOnTriangle(const SupportPoint& A, const SupportPoint& B, const SupportPoint& C, Simplex& out)
+    {
+        TriangleFeature feature;
+        glm::vec3 barycentric;
+        closestPointOnTriangle(glm::vec3(0.0f), A.w, B.w, C.w, feature, barycentric);
+        switch (feature)
+        {
+            case TriangleFeatureVertexA: setSimplex1(out, A); break;
+            case TriangleFeatureVertexB: setSimplex1(out, B); break;
+            case TriangleFeatureVertexC: setSimplex1(out, C); break;
+            case TriangleFeatureEdgeAB: setSimplex2(out, A, B, barycentric.y); break;
+            case TriangleFeatureEdgeBC: setSimplex2(out, B, C, barycentric.z); break;
+            case TriangleFeatureEdgeCA: setSimplex2(out, A, C, barycentric.z); break;
+            default:
+                out.points[0] = A;
+                out.points[1] = B;
+                out.points[2] = C;
+                out.lambdas[0] = barycentric.x;
+                out.lambdas[1] = barycentric.y;
+                out.lambdas[2] = barycentric.z;
+                out.count = 3;
+                break;
+        }
+    }
+
+    glm::vec3 simplexPoint(const Simplex& s)
+    {
+        glm::vec3 v(0.0f);
+        for (int i = 0; i < s.count; ++i) v += s.lambdas[i] * s.points[i].w;
+        return v;
+    }
+
+    // 求单纯形上离原点最近的点 v，并把单纯形缩减为包含 v 的最小子单纯形
+    // 原点在四面体内部时返回 true
+    bool closestOnSimplex(Simplex& s, glm::vec3& v)
+    {
+        if (s.count == 1)
+        {
+            s.lambdas[0] = 1.0f;
+        }
+        else if (s.count == 2)
+        {
+            const glm::vec3 ab = s.points[1].w - s.points[0].w;
+            const float lengthSq = glm::dot(ab, ab);
+            const float t = lengthSq > 0.0f ? glm::dot(-s.points[0].w, ab) / lengthSq : 0.0f;
+            if (t <= 0.0f) setSimplex1(s, s.points[0]);
+            else if (t >= 1.0f) setSimplex1(s, s.points[1]);
+            else setSimplex2(s, s.points[0], s.points[1], t);
+        }
+        else if (s.count == 3)
+        {
+            const Simplex copy = s;
+            closestOnTriangle(copy.points[0], copy.points[1], copy.points[2], s);
+        }
+        else
+        {
+            // 原点在某个面的外侧（与对面顶点分处两侧）时，最近点在该面上；所有面都不在外侧时原点在内部
+            static const int faces[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 } };
+            const Simplex copy = s;
+            float bestSq = std::numeric_limits<float>::max();
+            bool outside = false;
+            for (const auto& face : faces)
+            {
+                const glm::vec3& a = copy.points[face[0]].w;
+                const glm::vec3 n = glm::cross(copy.points[face[1]].w - a, copy.points[face[2]].w - a);
+                if (glm::dot(n, -a) * glm::dot(n, copy.points[face[3]].w - a) > 0.0f) continue;
+                outside = true;
+                Simplex candidate;
+                closestOnTriangle(copy.points[face[0]], copy.points[face[1]], copy.points[face[2]], candidate);
+                glm::vec3 p = simplexPoint(candidate);
+                float distanceSq = glm::dot(p, p);
+                if (distanceSq < bestSq)
+                {
+                    bestSq = distanceSq;
+                    s = candidate;
+                }
+            }
+            if (!outside)
+            {
+                v = glm::vec3(0.0f);
+                return true;
+            }
+        }
+        v = simplexPoint(s);
+        return false;
+    }
+
+    bool containsPoint(const Simplex& s, const glm::vec3& w)
+    {
+        for (int i = 0; i < s.count; ++i)
+        {
+            glm::vec3 d = s.points[i].w - w;
+            if (glm::dot(d, d) <= TouchToleranceSq) return true;
+        }
+        return false;
+    }
+
+    glm::vec3 initialDirection(const ConvexShape& a, const ConvexShape& b)
+    {
+        glm::vec3 direction = b.position - a.position;
+        return glm::dot(direction, direction) > 0.0f ? direction : glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+
+    // 把 GJK 结束时的单纯形补成包含它的四面体，作为 EPA 的初始多面体；退化时返回 false
+    bool blowUpSimplex(const ConvexShape& a, const ConvexShape& b, Simplex& s, int& supportCount)
+    {
+        static const glm::vec3 axes[6] = {
+            glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+            glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+        };
+        if (s.count == 1)
+        {
+            for (const glm::vec3& axis : axes)
+            {
+                SupportPoint p = supportCore(a, b, axis);
+                ++supportCount;
+                if (!containsPoint(s, p.w))
+                {
+                    s.points[s.count++] = p;
+                    break;
+                }
+            }
+            if (s.count < 2) return false;
+        }
+        if (s.count == 2)
+        {
+            const glm::vec3 d = s.points[1].w - s.points[0].w;
+            const glm::vec3 absD = glm::abs(d);
+            glm::vec3 axis(0.0f);
+            if (absD.x <= absD.y && absD.x <= absD.z) axis.x = 1.0f;
+            else if (absD.y <= absD.z) axis.y = 1.0f;
+            else axis.z = 1.0f;
+            const glm::vec3 e1 = glm::normalize(glm::cross(d, axis));
+            const glm::vec3 e2 = glm::normalize(glm::cross(d, e1));
+            const glm::vec3 directions[4] = { e1, -e1, e2, -e2 };
+            for (const glm::vec3& direction : directions)
+            {
+                SupportPoint p = supportCore(a, b, direction);
+                ++supportCount;
+                const glm::vec3 offset = glm::cross(p.w - s.points[0].w, d);
+                if (glm::dot(offset, offset) > TouchToleranceSq * glm::dot(d, d))
+                {
+                    s.points[s.count++] = p;
+                    break;
+                }
+            }
+            if (s.count < 3) return false;
+        }
+        if (s.count == 3)
+        {
+            const glm::vec3 n = glm::cross(s.points[1].w - s.points[0].w, s.points[2].w - s.points[0].w);
+            const float length = glm::length(n);
+            if (length <= 0.0f) return false;
+            SupportPoint p = supportCore(a, b, n);
+            ++supportCount;
+            if (std::fabs(glm::dot(p.w - s.points[0].w, n)) <= EPATolerance * length)
+            {
+                p = supportCore(a, b, -n);
+                ++supportCount;
+            }
+            if (std::fabs(glm::dot(p.w - s.points[0].w, n)) <= EPATolerance * length) return false;
+            s.points[s.count++] = p;
+        }
+        return true;
+    }
+
+    struct EPAFace
+    {
+        int vertices[3];
+        glm::vec3 normal;    // 背向多面体内部
+        float distance;      // 原点到面所在平面的距离
+    };
+
+    EPAFace makeFace(const std::vector<SupportPoint>& vertices, int i0, int i1, int i2, const glm::vec3& interior)
+    {
+        EPAFace face;
+        const glm::vec3& a = vertices[i0].w;
+        glm::vec3 n = glm::cross(vertices[i1].w - a, vertices[i2].w - a);
+        float length = glm::length(n);
+        n = length > 0.0f ? n / length : glm::normalize(a - interior);
+        if (glm::dot(n, a - interior) < 0.0f)
+        {
+            n = -n;
+            std::swap(i1, i2);
+        }
+        face.vertices[0] = i0;
+        face.vertices[1] = i1;
+        face.vertices[2] = i2;
+        face.normal = n;
+        face.distance = glm::dot(n, a);
+        return face;
+    }
+
+    // 点 p 相对三角形 abc 的重心坐标
+    glm::vec3 barycentric(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        const glm::vec3 v0 = b - a, v1 = c - a, v2 = p - a;
+        const float d00 = glm::dot(v0, v0);
+        const float d01 = glm::dot(v0, v1);
+        const float d11 = glm::dot(v1, v1);
+        const float d20 = glm::dot(v2, v0);
+        const float d21 = glm::dot(v2, v1);
+        const float denom = d00 * d11 - d01 * d01;
+        if (denom == 0.0f) return glm::vec3(1.0f, 0.0f, 0.0f);
+        const float v = (d11 * d20 - d01 * d21) / denom;
+        const float w = (d00 * d21 - d01 * d20) / denom;
+        return glm::vec3(1.0f - v - w, v, w);
+    }
+
+    // EPA：从包含原点的四面体出发，不断沿最近面的法线扩展多面体，直到最近面就在核心 Minkowski 差的表面上
+    // 完整形状的 Minkowski 差是核心的 Minkowski 差膨胀 margin 之和，穿透深度相应加上两侧 margin
+    void expandPolytope(const ConvexShape& a, const ConvexShape& b, const Simplex& simplex, ConvexContact& contact)
+    {
+        std::vector<SupportPoint> vertices(simplex.points, simplex.points + 4);
+        const glm::vec3 interior = 0.25f * (vertices[0].w + vertices[1].w + vertices[2].w + vertices[3].w);
+        std::vector<EPAFace> faces;
+        faces.push_back(makeFace(vertices, 0, 1, 2, interior));
+        faces.push_back(makeFace(vertices, 0, 3, 1, interior));
+        faces.push_back(makeFace(vertices, 0, 2, 3, interior));
+        faces.push_back(makeFace(vertices, 1, 3, 2, interior));
+        std::vector<std::pair<int, int>> horizon;
+
+        size_t closest = 0;
+        for (int iteration = 0; iteration < MaxEPAIterations; ++iteration)
+        {
+            closest = 0;
+            for (size_t i = 1; i < faces.size(); ++i)
+            {
+                if (faces[i].distance < faces[closest].distance) closest = i;
+            }
+            const EPAFace face = faces[closest];
+            SupportPoint p = supportCore(a, b, face.normal);
+            ++contact.supportCount;
+            if (glm::dot(p.w, face.normal) - face.distance <= EPATolerance) break;
+
+            // 删除新点能看到的面，它们的边中只出现一次的构成地平线，与新点连成新面
+            const int index = static_cast<int>(vertices.size());
+            vertices.push_back(p);
+            horizon.clear();
+            for (size_t i = 0; i < faces.size();)
+            {
+                if (glm::dot(faces[i].normal, p.w - vertices[faces[i].vertices[0]].w) <= 0.0f)
+                {
+                    ++i;
+                    continue;
+                }
+                for (int e = 0; e < 3; ++e)
+                {
+                    std::pair<int, int> edge(faces[i].vertices[e], faces[i].vertices[(e + 1) % 3]);
+                    auto reversed = std::find(horizon.begin(), horizon.end(), std::make_pair(edge.second, edge.first));
+                    if (reversed != horizon.end()) horizon.erase(reversed);
+                    else horizon.push_back(edge);
+                }
+                faces[i] = faces.back();
+                faces.pop_back();
+            }
+            if (horizon.empty()) break;
+            for (const auto& edge : horizon)
+            {
+                faces.push_back(makeFace(vertices, edge.first, edge.second, index, interior));
+            }
+        }
+
+        closest = 0;
+        for (size_t i = 1; i < faces.size(); ++i)
+        {
+            if (faces[i].distance < faces[closest].distance) closest = i;
+        }
+        const EPAFace& face = faces[closest];
+        const float depth = std::max(face.distance, 0.0f) + a.margin() + b.margin();
+        const SupportPoint& p0 = vertices[face.vertices[0]];
+        const SupportPoint& p1 = vertices[face.vertices[1]];
+        const SupportPoint& p2 = vertices[face.vertices[2]];
+        const glm::vec3 lambda = barycentric(face.normal * face.distance, p0.w, p1.w, p2.w);
+        contact.separation = -depth;
+        contact.normal = face.normal;
+        contact.pointA = lambda.x * p0.a + lambda.y * p1.a + lambda.z * p2.a + face.normal * a.margin();
+        contact.pointB = lambda.x * p0.b + lambda.y * p1.b + lambda.z * p2.b - face.normal * b.margin();
+    }
+}
+
+bool gjkIntersect(const ConvexShape& shapeA, const ConvexShape& shapeB, glm::vec3& separatingAxis,
+                  float* separationBound)
+{
+    XPBD_PROFILE_ZONE("gjkIntersect");
+    unsigned int hintA, hintB;
+    const ConvexShape a = withSupportHint(shapeA, hintA);
+    const ConvexShape b = withSupportHint(shapeB, hintB);
+    // v 是对 A - B 上离原点最近点的估计，分离轴与它反向
+    glm::vec3 v = glm::dot(separatingAxis, separatingAxis) > 0.0f ? -separatingAxis : -initialDirection(a, b);
+    Simplex s;
+    s.count = 0;
+    for (int iteration = 0; iteration < MaxGJKIterations; ++iteration)
+    {
+        SupportPoint w = supportFull(a, b, -v);
+        // A - B 整体位于过 w、法线为 -v 的平面之外，原点不在其中
+        if (glm::dot(w.w, v) > 0.0f)
+        {
+            separatingAxis = glm::normalize(-v);
+            if (separationBound) *separationBound = -glm::dot(w.w, separatingAxis);
+            return false;
+        }
+        if (containsPoint(s, w.w)) return true;
+        s.points[s.count++] = w;
+        if (closestOnSimplex(s, v) || glm::dot(v, v) <= TouchToleranceSq) return true;
+    }
+    return true;
+}
+
+bool computeConvexContact(const ConvexShape& shapeA, const ConvexShape& shapeB, ConvexContact& contact)
+{
+    XPBD_PROFILE_ZONE("computeConvexContact");
+    unsigned int hintA, hintB;
+    const ConvexShape a = withSupportHint(shapeA, hintA);
+    const ConvexShape b = withSupportHint(shapeB, hintB);
+    contact.supportCount = 0;
+    Simplex s;
+    setSimplex1(s, supportCore(a, b, -initialDirection(a, b)));
+    ++contact.supportCount;
+    glm::vec3 v = s.points[0].w;
+
+    bool coresIntersect = false;
+    for (int iteration = 0; iteration < MaxGJKIterations; ++iteration)
+    {
+        const float vv = glm::dot(v, v);
+        if (vv <= TouchToleranceSq)
+        {
+            coresIntersect = true;
+            break;
+        }
+        SupportPoint w = supportCore(a, b, -v);
+        ++contact.supportCount;
+        // w 不能让最近点更近，v 即为核心之间的最近点
+        if (vv - glm::dot(v, w.w) <= GJKRelativeTolerance * vv || containsPoint(s, w.w)) break;
+        s.points[s.count++] = w;
+        if (closestOnSimplex(s, v))
+        {
+            coresIntersect = true;
+            break;
+        }
+    }
+
+    if (!coresIntersect)
+    {
+        // 核心分离：沿最近点连线各向外膨胀 margin
+        const float distance = glm::length(v);
+        contact.normal = -v / distance;
+        glm::vec3 coreA(0.0f), coreB(0.0f);
+        for (int i = 0; i < s.count; ++i)
+        {
+            coreA += s.lambdas[i] * s.points[i].a;
+            coreB += s.lambdas[i] * s.points[i].b;
+        }
+        contact.separation = distance - a.margin() - b.margin();
+        contact.pointA = coreA + contact.normal * a.margin();
+        contact.pointB = coreB - contact.normal * b.margin();
+        return contact.separation < 0.0f;
+    }
+
+    // 核心相交（或刚好接触）时在核心上做 EPA
+    if (!blowUpSimplex(a, b, s, contact.supportCount))
+    {
+        // 核心的 Minkowski 差退化（如两个球心重合），核心穿透深度取 0，法线取两中心的连线
+        contact.normal = glm::normalize(initialDirection(a, b));
+        contact.separation = -(a.margin() + b.margin());
+        contact.pointA = s.points[0].a + contact.normal * a.margin();
+        contact.pointB = s.points[0].b - contact.normal * b.margin();
+        return contact.separation < 0.0f;
+    }
+    expandPolytope(a, b, s, contact);
+    return contact.separation < 0.0f;
+}
@@ -0,0 +1,56 @@
+#ifndef GJK_H
+#define GJK_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "physics/collider.h"
+
+// 世界坐标系下的凸形状：局部坐标系中的 Collider 加上位置和朝向
+// 支撑函数把方向变换到局部坐标系查询，再把结果变换回世界坐标系，不需要变换顶点
+// supportHint 指向上次的支撑顶点下标（可为空），由调用者跨帧保存，凸包据此从上次的顶点开始爬山；
+// 为空时 GJK/EPA 在单次查询内部使用临时的下标
+struct ConvexShape
+{
+    const Collider* collider;
+    glm::vec3 position;
+    glm::quat rotation;
+    unsigned int* supportHint = nullptr;
+
+    glm::vec3 support(const glm::vec3& direction) const
+    {
+        glm::vec3 localDirection = glm::conjugate(rotation) * direction;
+        glm::vec3 local = supportHint ? collider->getSupportPoint(localDirection, *supportHint)
+                                      : collider->getSupportPoint(localDirection);
+        return position + rotation * local;
+    }
+    glm::vec3 coreSupport(const glm::vec3& direction) const
+    {
+        glm::vec3 localDirection = glm::conjugate(rotation) * direction;
+        glm::vec3 local = supportHint ? collider->getCoreSupportPoint(localDirection, *supportHint)
+                                      : collider->getCoreSupportPoint(localDirection);
+        return position + rotation * local;
+    }
+    float margin() const { return collider->getMargin(); }
+};
+
+// 两个凸形状之间的接触信息
+struct ConvexContact
+{
+    float separation;        // 分离时为两形状的距离，相交时为负的穿透深度
+    glm::vec3 normal;        // 由 A 指向 B 的单位向量，B 沿它平移 -separation 后两形状恰好接触
+    glm::vec3 pointA;        // A 上离 B 最近的点，相交时为 A 最深入 B 的点
+    glm::vec3 pointB;
+    int supportCount;        // 调用支撑函数的次数
+};
+
+// GJK 布尔检测：只判断是否相交，找到分离轴即提前返回
+// separatingAxis 为初始搜索方向（由 A 指向 B，可传入上一帧的结果，为 0 时取两中心的连线），
+// 返回 false 时为新的分离轴，separationBound 非空时给出两形状沿该轴的间隙，即距离的下界
+bool gjkIntersect(const ConvexShape& a, const ConvexShape& b, glm::vec3& separatingAxis,
+                  float* separationBound = nullptr);
+
+// GJK 求两核心形状的距离和最近点，再减去两侧的 margin；核心相交时用 EPA 在完整形状上求穿透深度和法线
+// 返回两形状是否相交（separation < 0）
+bool computeConvexContact(const ConvexShape& a, const ConvexShape& b, ConvexContact& contact);
+
+#endif
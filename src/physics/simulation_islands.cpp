@@ -0,0 +1,117 @@
+#include "physics/simulation_islands.h"
+#include <cstddef>
+#include <utility>
+
+void SimulationIslands::reset(uint32_t bodyCount)
+{
+    // 只扩容不初始化，加入的刚体在 addBody 中初始化，代价与参与构建的刚体数成正比
+    parents.resize(bodyCount);
+    ranks.resize(bodyCount);
+    rootToIsland.resize(bodyCount);
+    if (sleepingIslandOf.size() < bodyCount) sleepingIslandOf.resize(bodyCount, NoIsland);
+    members.clear();
+}
+
+void SimulationIslands::addBody(uint32_t body)
+{
+    parents[body] = body;
+    ranks[body] = 0;
+    members.push_back(body);
+}
+
+uint32_t SimulationIslands::find(uint32_t body)
+{
+    // 路径减半：查找的同时把经过的节点挂到祖父节点上
+    while (parents[body] != body)
+    {
+        parents[body] = parents[parents[body]];
+        body = parents[body];
+    }
+    return body;
+}
+
+void SimulationIslands::connect(uint32_t a, uint32_t b)
+{
+    uint32_t rootA = find(a);
+    uint32_t rootB = find(b);
+    if (rootA == rootB) return;
+
+    // 按秩合并
+    if (ranks[rootA] < ranks[rootB]) std::swap(rootA, rootB);
+    parents[rootB] = rootA;
+    if (ranks[rootA] == ranks[rootB]) ranks[rootA]++;
+}
+
+void SimulationIslands::build()
+{
+    // 根一定是加入的刚体，只需重置它们的岛编号
+    for (uint32_t body : members)
+    {
+        rootToIsland[body] = NoIsland;
+    }
+
+    // 先给每个根分配岛编号并统计大小
+    islandOffsets.assign(1, 0);
+    for (uint32_t body : members)
+    {
+        uint32_t root = find(body);
+        if (rootToIsland[root] == NoIsland)
+        {
+            rootToIsland[root] = static_cast<uint32_t>(islandOffsets.size()) - 1;
+            islandOffsets.push_back(0);
+        }
+        islandOffsets[rootToIsland[root] + 1]++;
+    }
+
+    // 前缀和后按岛填入刚体下标
+    for (size_t i = 1; i < islandOffsets.size(); ++i)
+    {
+        islandOffsets[i] += islandOffsets[i - 1];
+    }
+    islandBodies.resize(islandOffsets.back());
+    std::vector<uint32_t> fill(islandOffsets.begin(), islandOffsets.end() - 1);
+    for (uint32_t body : members)
+    {
+        islandBodies[fill[rootToIsland[find(body)]]++] = body;
+    }
+}
+
+void SimulationIslands::addSleepingIsland(const uint32_t* begin, const uint32_t* end)
+{
+    uint32_t island;
+    if (freeSleepingIslands.empty())
+    {
+        island = static_cast<uint32_t>(sleepingIslands.size());
+        sleepingIslands.emplace_back();
+    }
+    else
+    {
+        island = freeSleepingIslands.back();
+        freeSleepingIslands.pop_back();
+    }
+    sleepingIslands[island].assign(begin, end);
+    for (const uint32_t* body = begin; body != end; ++body)
+    {
+        sleepingIslandOf[*body] = island;
+    }
+}
+
+const std::vector<uint32_t>& SimulationIslands::removeSleepingIsland(uint32_t island)
+{
+    // 交换出刚体列表，两个 vector 的容量都留着复用
+    wokenBodies.swap(sleepingIslands[island]);
+    sleepingIslands[island].clear();
+    freeSleepingIslands.push_back(island);
+    for (uint32_t body : wokenBodies)
+    {
+        sleepingIslandOf[body] = NoIsland;
+    }
+    return wokenBodies;
+}
+
+void SimulationIslands::clearSleepingIslands()
+{
+    sleepingIslands.clear();
+    freeSleepingIslands.clear();
+    sleepingIslandOf.assign(sleepingIslandOf.size(), NoIsland);
+}
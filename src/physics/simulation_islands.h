@@ -0,0 +1,60 @@
+#ifndef SIMULATION_ISLANDS_H
+#define SIMULATION_ISLANDS_H
+
+#include <cstdint>
+#include <vector>
+
+// 仿真岛：通过接触和约束相连的动态刚体集合，用并查集构建
+// 静态刚体（地面等）不传递连通性，否则所有落在地面上的物体会连成一个岛
+// 每个时间步只在未休眠的刚体上重建；整岛休眠时保存其刚体列表，直到被唤醒前不再参与重建
+class SimulationIslands
+{
+    public:
+        static constexpr uint32_t NoIsland = UINT32_MAX;
+
+        // 为下标小于 bodyCount 的刚体开始新一次构建，之后用 addBody 加入参与构建的刚体
+        void reset(uint32_t bodyCount);
+        // 加入一个刚体，自成一个集合
+        void addBody(uint32_t body);
+        // 合并 a、b 所在的集合，两者都必须已经加入
+        void connect(uint32_t a, uint32_t b);
+        uint32_t find(uint32_t body);
+
+        // 所有 connect 完成后调用：按岛整理加入的刚体下标（CSR）
+        void build();
+
+        uint32_t getIslandCount() const { return static_cast<uint32_t>(islandOffsets.size()) - 1; }
+        // 第 island 个岛的刚体下标为 [getIslandBegin(island), getIslandEnd(island))
+        const uint32_t* getIslandBegin(uint32_t island) const { return islandBodies.data() + islandOffsets[island]; }
+        const uint32_t* getIslandEnd(uint32_t island) const { return islandBodies.data() + islandOffsets[island + 1]; }
+
+        // 保存一个整体进入休眠的岛
+        void addSleepingIsland(const uint32_t* begin, const uint32_t* end);
+        // body 所在的休眠岛，不在任何休眠岛中时为 NoIsland
+        uint32_t getSleepingIsland(uint32_t body) const
+        {
+            return body < sleepingIslandOf.size() ? sleepingIslandOf[body] : NoIsland;
+        }
+        // 取出一个休眠岛（整岛唤醒时调用），返回的刚体列表在下次调用前有效
+        const std::vector<uint32_t>& removeSleepingIsland(uint32_t island);
+        void clearSleepingIslands();
+        uint32_t getSleepingIslandCount() const
+        {
+            return static_cast<uint32_t>(sleepingIslands.size() - freeSleepingIslands.size());
+        }
+
+    private:
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> ranks;
+        std::vector<uint32_t> members;          // 本次构建加入的刚体
+        std::vector<uint32_t> islandOffsets = std::vector<uint32_t>(1, 0);
+        std::vector<uint32_t> islandBodies;
+        std::vector<uint32_t> rootToIsland;
+
+        std::vector<std::vector<uint32_t>> sleepingIslands;
+        std::vector<uint32_t> freeSleepingIslands;   // sleepingIslands 中已取出、可复用的位置
+        std::vector<uint32_t> sleepingIslandOf;      // 每个刚体所在的休眠岛
+        std::vector<uint32_t> wokenBodies;
+};
+
+#endif
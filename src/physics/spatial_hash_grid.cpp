@@ -0,0 +1,359 @@
+#include "physics/spatial_hash_grid.h"
+#include "core/log.h"
+#include "core/profiler.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+SpatialHashGrid::SpatialHashGrid()
+    : threadPool(nullptr), pointCount(0), cellSize(1.0f), invCellSize(1.0f), bucketCount(0),
+      bucketCapacity(0), fixedCellSize(0.0f), predictionTime(0.0f), aabbMargin(0.0f)
+{
+    XPBD_LOG_DEBUG(BroadPhase, "SpatialHashGrid initialized");
+}
+
+void SpatialHashGrid::parallelFor(size_t count, const std::function<void(size_t, size_t)>& task, size_t minBatchSize)
+{
+    if (threadPool)
+    {
+        threadPool->parallelFor(count, task, minBatchSize);
+    }
+    else if (count > 0)
+    {
+        task(0, count);
+    }
+}
+
+glm::ivec3 SpatialHashGrid::cellOf(const glm::vec3& position) const
+{
+    return glm::ivec3(static_cast<int>(std::floor(position.x * invCellSize)),
+                      static_cast<int>(std::floor(position.y * invCellSize)),
+                      static_cast<int>(std::floor(position.z * invCellSize)));
+}
+
+uint32_t SpatialHashGrid::hashCell(const glm::ivec3& cell) const
+{
+    // Teschner 等人的空间哈希：三个大素数异或
+    uint32_t h = (static_cast<uint32_t>(cell.x) * 73856093u) ^
+                 (static_cast<uint32_t>(cell.y) * 19349663u) ^
+                 (static_cast<uint32_t>(cell.z) * 83492791u);
+    return h & static_cast<uint32_t>(bucketCount - 1);
+}
+
+int SpatialHashGrid::neighbourBuckets(const glm::ivec3& cell, uint32_t* buckets) const
+{
+    int count = 0;
+    for (int dz = -1; dz <= 1; ++dz)
+    {
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                uint32_t bucket = hashCell(cell + glm::ivec3(dx, dy, dz));
+                if (bucketStarts[bucket] == bucketStarts[bucket + 1]) continue;
+                if (std::find(buckets, buckets + count, bucket) == buckets + count)
+                {
+                    buckets[count++] = bucket;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+void SpatialHashGrid::build(const glm::vec3* positions, size_t count, float size)
+{
+    XPBD_PROFILE_ZONE("SpatialHashGrid::build");
+    pointCount = count;
+    cellSize = size > 0.0f ? size : 1.0f;
+    invCellSize = 1.0f / cellSize;
+
+    bucketCount = 64;
+    while (bucketCount < 2 * count) bucketCount <<= 1;
+    if (bucketCapacity < bucketCount)
+    {
+        bucketCursors.reset(new std::atomic<uint32_t>[bucketCount]);
+        bucketCapacity = bucketCount;
+    }
+    pointBuckets.resize(count);
+    bucketStarts.resize(bucketCount + 1);
+    sortedIndices.resize(count);
+    sortedPositions.resize(count);
+
+    std::atomic<uint32_t>* cursors = bucketCursors.get();
+    parallelFor(bucketCount, [&](size_t begin, size_t end)
+    {
+        for (size_t b = begin; b < end; ++b) cursors[b].store(0, std::memory_order_relaxed);
+    }, 4096);
+
+    // 1. 计算哈希桶并计数
+    parallelFor(count, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint32_t bucket = hashCell(cellOf(positions[i]));
+            pointBuckets[i] = bucket;
+            cursors[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // 2. 前缀和，同时把计数器改为写入游标
+    uint32_t offset = 0;
+    for (size_t b = 0; b < bucketCount; ++b)
+    {
+        bucketStarts[b] = offset;
+        uint32_t n = cursors[b].load(std::memory_order_relaxed);
+        cursors[b].store(offset, std::memory_order_relaxed);
+        offset += n;
+    }
+    bucketStarts[bucketCount] = offset;
+
+    // 3. 分散写入；同一个桶内的顺序取决于线程调度，查询结果在输出前另行排序
+    parallelFor(count, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint32_t slot = cursors[pointBuckets[i]].fetch_add(1, std::memory_order_relaxed);
+            sortedIndices[slot] = static_cast<uint32_t>(i);
+            sortedPositions[slot] = positions[i];
+        }
+    });
+}
+
+template <typename Accept>
+void SpatialHashGrid::collectPairs(const Accept& accept, std::vector<std::pair<uint32_t, uint32_t>>& pairs)
+{
+    pairCounts.resize(pointCount + 1);
+
+    // 按哈希桶顺序遍历粒子：同一单元的粒子相邻，相邻单元的桶列表只需计算一次，粒子数据也是连续访问
+    auto forEachNeighbour = [&](size_t begin, size_t end, auto&& visit)
+    {
+        uint32_t buckets[27];
+        int bucketNum = 0;
+        glm::ivec3 lastCell(0);
+        bool hasLastCell = false;
+        for (size_t k = begin; k < end; ++k)
+        {
+            uint32_t i = sortedIndices[k];
+            const glm::vec3& position = sortedPositions[k];
+            glm::ivec3 cell = cellOf(position);
+            if (!hasLastCell || cell != lastCell)
+            {
+                bucketNum = neighbourBuckets(cell, buckets);
+                lastCell = cell;
+                hasLastCell = true;
+            }
+            visit(i, position, buckets, bucketNum);
+        }
+    };
+
+    // 第一遍：每个粒子 i 统计满足 j > i 的邻居数
+    parallelFor(pointCount, [&](size_t begin, size_t end)
+    {
+        forEachNeighbour(begin, end, [&](uint32_t i, const glm::vec3& position, const uint32_t* buckets, int bucketNum)
+        {
+            uint32_t found = 0;
+            for (int b = 0; b < bucketNum; ++b)
+            {
+                for (uint32_t k = bucketStarts[buckets[b]]; k < bucketStarts[buckets[b] + 1]; ++k)
+                {
+                    uint32_t j = sortedIndices[k];
+                    if (j > i && accept(i, position, j, sortedPositions[k])) ++found;
+                }
+            }
+            pairCounts[i] = found;
+        });
+    });
+
+    uint32_t total = 0;
+    for (size_t i = 0; i < pointCount; ++i)
+    {
+        uint32_t n = pairCounts[i];
+        pairCounts[i] = total;
+        total += n;
+    }
+    pairCounts[pointCount] = total;
+    pairs.resize(total);
+
+    // 第二遍：写入各自的区间，再按 j 排序使输出与遍历顺序、线程调度无关
+    parallelFor(pointCount, [&](size_t begin, size_t end)
+    {
+        forEachNeighbour(begin, end, [&](uint32_t i, const glm::vec3& position, const uint32_t* buckets, int bucketNum)
+        {
+            uint32_t out = pairCounts[i];
+            for (int b = 0; b < bucketNum; ++b)
+            {
+                for (uint32_t k = bucketStarts[buckets[b]]; k < bucketStarts[buckets[b] + 1]; ++k)
+                {
+                    uint32_t j = sortedIndices[k];
+                    if (j > i && accept(i, position, j, sortedPositions[k])) pairs[out++] = std::make_pair(i, j);
+                }
+            }
+            std::sort(pairs.begin() + pairCounts[i], pairs.begin() + out);
+        });
+    });
+}
+
+void SpatialHashGrid::collectNeighbourPairs(float radius, std::vector<std::pair<uint32_t, uint32_t>>& pairs)
+{
+    XPBD_PROFILE_ZONE("SpatialHashGrid::collectNeighbourPairs");
+    if (radius > cellSize)
+    {
+        XPBD_LOG_WARN(BroadPhase, "Neighbour radius %g exceeds cell size %g, pairs may be missed", radius, cellSize);
+    }
+    const float radiusSquared = radius * radius;
+    collectPairs([radiusSquared](uint32_t, const glm::vec3& a, uint32_t, const glm::vec3& b)
+    {
+        glm::vec3 d = b - a;
+        return glm::dot(d, d) <= radiusSquared;
+    }, pairs);
+}
+
+void SpatialHashGrid::queryNeighbours(const glm::vec3& point, float radius, std::vector<uint32_t>& result) const
+{
+    result.clear();
+    if (pointCount == 0) return;
+
+    // 半径可能跨越多个单元，先收集覆盖范围内所有单元的哈希桶并去重
+    glm::ivec3 low = cellOf(point - glm::vec3(radius));
+    glm::ivec3 high = cellOf(point + glm::vec3(radius));
+    std::vector<uint32_t> buckets;
+    for (int z = low.z; z <= high.z; ++z)
+    {
+        for (int y = low.y; y <= high.y; ++y)
+        {
+            for (int x = low.x; x <= high.x; ++x)
+            {
+                buckets.push_back(hashCell(glm::ivec3(x, y, z)));
+            }
+        }
+    }
+    std::sort(buckets.begin(), buckets.end());
+    buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+
+    const float radiusSquared = radius * radius;
+    for (uint32_t bucket : buckets)
+    {
+        for (uint32_t k = bucketStarts[bucket]; k < bucketStarts[bucket + 1]; ++k)
+        {
+            glm::vec3 d = sortedPositions[k] - point;
+            if (glm::dot(d, d) <= radiusSquared) result.push_back(sortedIndices[k]);
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+void SpatialHashGrid::addObject(Entity* entity)
+{
+    if (!entity)
+    {
+        std::cerr << "Error: Cannot add entity to SpatialHashGrid without collider" << std::endl;
+        return;
+    }
+    entities.push_back(entity);
+    fitAABBs.push_back(computeAABB(entity));
+}
+
+void SpatialHashGrid::update(float predictionTime, float margin)
+{
+    XPBD_PROFILE_ZONE("SpatialHashGrid::update");
+    this->predictionTime = predictionTime;
+    this->aabbMargin = margin;
+
+    // 每个实体的包围盒互不相关，可并行计算
+    parallelFor(entities.size(), [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Entity* entity = entities[i];
+            // 休眠中的刚体没有移动，保留上次的包围盒
+            if (entity->isSleeping()) continue;
+            glm::vec3 displacement(0.0f);
+            if (predictionTime > 0.0f)
+            {
+                displacement = entity->getLinearVelocity() * predictionTime;
+            }
+            AABB aabb = computeAABB(entity);
+            aabb.min += glm::min(displacement, glm::vec3(0.0f)) - glm::vec3(margin);
+            aabb.max += glm::max(displacement, glm::vec3(0.0f)) + glm::vec3(margin);
+            fitAABBs[i] = aabb;
+        }
+    }, 16);
+
+    // 单元尺寸：包围盒最大边长的中位数的两倍，同尺寸元素的包围盒都不超过单元
+    float size = fixedCellSize;
+    if (size <= 0.0f && !entities.empty())
+    {
+        std::vector<float> extents(entities.size());
+        for (size_t i = 0; i < entities.size(); ++i)
+        {
+            glm::vec3 e = fitAABBs[i].max - fitAABBs[i].min;
+            extents[i] = std::max(e.x, std::max(e.y, e.z));
+        }
+        std::nth_element(extents.begin(), extents.begin() + extents.size() / 2, extents.end());
+        size = 2.0f * extents[extents.size() / 2];
+    }
+
+    // 包围盒边长不超过单元尺寸时，两个相交的包围盒中心在各轴上的距离都不超过一个单元，只需查相邻单元
+    centers.clear();
+    gridEntities.clear();
+    largeEntities.clear();
+    for (uint32_t i = 0; i < entities.size(); ++i)
+    {
+        glm::vec3 e = fitAABBs[i].max - fitAABBs[i].min;
+        if (std::max(e.x, std::max(e.y, e.z)) > size)
+        {
+            largeEntities.push_back(i);
+        }
+        else
+        {
+            centers.push_back(0.5f * (fitAABBs[i].min + fitAABBs[i].max));
+            gridEntities.push_back(i);
+        }
+    }
+    build(centers, size);
+}
+
+void SpatialHashGrid::collectCollisionPairs(std::vector<std::pair<Entity*, Entity*>>& pairs)
+{
+    XPBD_PROFILE_ZONE("SpatialHashGrid::collectCollisionPairs");
+    // 新加入的实体尚未放入网格
+    if (gridEntities.size() + largeEntities.size() != entities.size()) update(predictionTime, aabbMargin);
+    const std::vector<AABB>& boxes = fitAABBs;
+    const std::vector<uint32_t>& ids = gridEntities;
+    collectPairs([&boxes, &ids](uint32_t i, const glm::vec3&, uint32_t j, const glm::vec3&)
+    {
+        return checkAABBCollision(boxes[ids[i]], boxes[ids[j]]);
+    }, entityPairs);
+
+    pairs.clear();
+    for (const auto& pair : entityPairs)
+    {
+        // 网格下标按实体下标递增排列，较小的在前即插入较早的实体在前
+        Entity* a = entities[gridEntities[pair.first]];
+        Entity* b = entities[gridEntities[pair.second]];
+        if (a != b) pairs.emplace_back(a, b);
+    }
+
+    // 大实体与其余所有实体逐一检查
+    for (uint32_t large : largeEntities)
+    {
+        for (uint32_t i = 0; i < entities.size(); ++i)
+        {
+            if (i == large || entities[i] == entities[large]) continue;
+            // 两个大实体之间只输出一次
+            bool otherLarge = std::binary_search(largeEntities.begin(), largeEntities.end(), i);
+            if (otherLarge && i < large) continue;
+            if (!checkAABBCollision(fitAABBs[large], fitAABBs[i])) continue;
+            if (i < large)
+            {
+                pairs.emplace_back(entities[i], entities[large]);
+            }
+            else
+            {
+                pairs.emplace_back(entities[large], entities[i]);
+            }
+        }
+    }
+    XPBD_LOG_DEBUG(BroadPhase, "Potential collisions: %zu", pairs.size());
+}
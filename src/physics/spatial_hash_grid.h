@@ -0,0 +1,83 @@
+#ifndef SPATIAL_HASH_GRID_H
+#define SPATIAL_HASH_GRID_H
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "core/thread_pool.h"
+#include "physics/broad_phase.h"
+#include "physics/entity.h"
+
+// 均匀网格 + 空间哈希，面向大量同尺寸元素（颗粒、流体粒子、布料顶点）
+// 每次 build 都从头重建：计算单元哈希 -> 计数 -> 前缀和 -> 分散写入（计数排序），结果是按哈希桶连续存放的扁平数组
+// 计数和分散写入使用原子操作，可在线程池上并行；没有跨帧状态，适合每个子步重建
+// 邻居查询只访问相邻的 27 个单元，总代价与粒子数成线性
+class SpatialHashGrid : public BroadPhase
+{
+    public:
+        SpatialHashGrid();
+
+        void setThreadPool(ThreadPool* pool) override { threadPool = pool; }
+
+        // 粒子接口：按 cellSize 划分网格并重建，位置会复制到网格内部
+        void build(const glm::vec3* positions, size_t count, float cellSize);
+        void build(const std::vector<glm::vec3>& positions, float cellSize) { build(positions.data(), positions.size(), cellSize); }
+        // 距离不超过 radius（<= cellSize）的所有粒子对 (i, j)，i < j，按 i、j 升序
+        void collectNeighbourPairs(float radius, std::vector<std::pair<uint32_t, uint32_t>>& pairs);
+        // 距离 point 不超过 radius 的粒子下标，升序
+        void queryNeighbours(const glm::vec3& point, float radius, std::vector<uint32_t>& result) const;
+
+        // BroadPhase 接口：按包围盒中心建网格，单元尺寸取包围盒最大边长中位数的两倍（或 setCellSize 指定）
+        // 边长超过单元尺寸的实体（如地面）单独与所有实体逐一检查
+        void addObject(Entity* entity) override;
+        void update(float predictionTime = 0.0f, float margin = 0.0f) override;
+        void collectCollisionPairs(std::vector<std::pair<Entity*, Entity*>>& pairs) override;
+
+        // 0 表示自动选取
+        void setCellSize(float size) { fixedCellSize = size > 0.0f ? size : 0.0f; }
+        float getCellSize() const { return cellSize; }
+        size_t getBucketCount() const { return bucketCount; }
+
+    private:
+        ThreadPool* threadPool;
+
+        // 网格数据
+        size_t pointCount;
+        float cellSize;
+        float invCellSize;
+        size_t bucketCount;                               // 2 的幂，不少于粒子数的两倍
+        std::vector<uint32_t> pointBuckets;               // 每个粒子所在的哈希桶
+        std::unique_ptr<std::atomic<uint32_t>[]> bucketCursors;
+        size_t bucketCapacity;
+        std::vector<uint32_t> bucketStarts;               // bucketCount + 1 个前缀和
+        std::vector<uint32_t> sortedIndices;              // 按哈希桶排列的粒子下标
+        std::vector<glm::vec3> sortedPositions;           // 与 sortedIndices 对应，遍历时连续访问
+        std::vector<uint32_t> pairCounts;                 // 每个粒子的邻居数，前缀和后为输出偏移
+
+        // 实体数据
+        std::vector<Entity*> entities;
+        std::vector<AABB> fitAABBs;
+        std::vector<glm::vec3> centers;                   // 普通实体的包围盒中心，作为网格的粒子
+        std::vector<uint32_t> gridEntities;               // 网格粒子下标 -> 实体下标
+        std::vector<uint32_t> largeEntities;              // 不放入网格的大实体
+        std::vector<std::pair<uint32_t, uint32_t>> entityPairs;
+        float fixedCellSize;
+        float predictionTime;
+        float aabbMargin;
+
+        uint32_t hashCell(const glm::ivec3& cell) const;
+        glm::ivec3 cellOf(const glm::vec3& position) const;
+        // 收集 cell 周围 27 个单元对应的哈希桶（去重，不同单元可能哈希到同一个桶），返回桶数
+        int neighbourBuckets(const glm::ivec3& cell, uint32_t* buckets) const;
+        void parallelFor(size_t count, const std::function<void(size_t, size_t)>& task, size_t minBatchSize = 256);
+
+        // 两遍生成粒子对：先并行统计每个粒子的邻居数并做前缀和，再并行写入各自的区间，输出顺序确定
+        template <typename Accept>
+        void collectPairs(const Accept& accept, std::vector<std::pair<uint32_t, uint32_t>>& pairs);
+};
+
+#endif
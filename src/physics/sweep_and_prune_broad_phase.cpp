@@ -0,0 +1,189 @@
+#include "physics/sweep_and_prune_broad_phase.h"
+#include "core/log.h"
+#include <iostream>
+#include <algorithm>
+
+namespace
+{
+    // 另一条轴的方差超过当前轴的该倍数才切换，避免在方差接近的轴之间来回重排
+    const float AxisSwitchRatio = 1.5f;
+}
+
+SweepAndPruneBroadPhase::SweepAndPruneBroadPhase()
+    : axis(0), unsorted(false), lastSwapCount(0), predictionTime(0.0f), aabbMargin(0.0f)
+{
+    XPBD_LOG_DEBUG(BroadPhase, "SweepAndPruneBroadPhase initialized");
+}
+
+void SweepAndPruneBroadPhase::addObject(Entity* entity)
+{
+    if (!entity)
+    {
+        std::cerr << "Error: Cannot add entity to SweepAndPruneBroadPhase without collider" << std::endl;
+        return;
+    }
+
+    Proxy proxy;
+    proxy.entity = entity;
+    proxy.shapeAABB = computeAABB(entity);
+    proxy.lastPosition = entity->getPosition();
+    proxy.lastRotation = entity->getRotation();
+    proxy.activeIndex = 0;
+    proxies.push_back(proxy);
+    updateProxy(proxies.back());
+
+    // 新端点追加在末尾，批量添加后在下一次 update 或 collectCollisionPairs 中整体排序一次
+    uint32_t proxyId = static_cast<uint32_t>(proxies.size() - 1);
+    endpoints.push_back(Endpoint{ proxies.back().fitAABB.min[axis], proxyId << 1 });
+    endpoints.push_back(Endpoint{ proxies.back().fitAABB.max[axis], (proxyId << 1) | 1u });
+    unsorted = true;
+}
+
+void SweepAndPruneBroadPhase::sortEndpoints()
+{
+    refreshEndpoints();
+    if (unsorted)
+    {
+        std::sort(endpoints.begin(), endpoints.end());
+        unsorted = false;
+        lastSwapCount = 0;
+    }
+    else
+    {
+        insertionSort();
+    }
+}
+
+void SweepAndPruneBroadPhase::updateProxy(Proxy& proxy)
+{
+    Entity* entity = proxy.entity;
+    // 休眠中的刚体没有移动，保留上次的包围盒
+    if (entity->isSleeping()) return;
+
+    if (entity->getPosition() != proxy.lastPosition || entity->getRotation() != proxy.lastRotation)
+    {
+        proxy.shapeAABB = computeAABB(entity);
+        proxy.lastPosition = entity->getPosition();
+        proxy.lastRotation = entity->getRotation();
+    }
+
+    glm::vec3 displacement(0.0f);
+    if (predictionTime > 0.0f)
+    {
+        displacement = entity->getLinearVelocity() * predictionTime;
+    }
+    proxy.fitAABB = proxy.shapeAABB;
+    proxy.fitAABB.min += glm::min(displacement, glm::vec3(0.0f)) - glm::vec3(aabbMargin);
+    proxy.fitAABB.max += glm::max(displacement, glm::vec3(0.0f)) + glm::vec3(aabbMargin);
+}
+
+void SweepAndPruneBroadPhase::chooseAxis()
+{
+    if (proxies.size() < 2) return;
+
+    glm::vec3 sum(0.0f);
+    glm::vec3 sumSquared(0.0f);
+    for (const Proxy& proxy : proxies)
+    {
+        glm::vec3 center = 0.5f * (proxy.fitAABB.min + proxy.fitAABB.max);
+        sum += center;
+        sumSquared += center * center;
+    }
+    float invCount = 1.0f / static_cast<float>(proxies.size());
+    glm::vec3 variance = sumSquared * invCount - (sum * invCount) * (sum * invCount);
+
+    int best = axis;
+    for (int i = 0; i < 3; ++i)
+    {
+        if (variance[i] > variance[best]) best = i;
+    }
+    if (best != axis && variance[best] > AxisSwitchRatio * variance[axis])
+    {
+        XPBD_LOG_DEBUG(BroadPhase, "Sweep axis %d -> %d", axis, best);
+        axis = best;
+        refreshEndpoints();
+        std::sort(endpoints.begin(), endpoints.end());
+    }
+}
+
+void SweepAndPruneBroadPhase::refreshEndpoints()
+{
+    for (Endpoint& endpoint : endpoints)
+    {
+        const AABB& aabb = proxies[endpoint.proxy()].fitAABB;
+        endpoint.value = endpoint.isMax() ? aabb.max[axis] : aabb.min[axis];
+    }
+}
+
+void SweepAndPruneBroadPhase::insertionSort()
+{
+    // 上一帧的顺序几乎仍然有序，交换次数与端点越过彼此的次数成正比
+    size_t swaps = 0;
+    for (size_t i = 1; i < endpoints.size(); ++i)
+    {
+        Endpoint key = endpoints[i];
+        size_t j = i;
+        while (j > 0 && key < endpoints[j - 1])
+        {
+            endpoints[j] = endpoints[j - 1];
+            --j;
+        }
+        endpoints[j] = key;
+        swaps += i - j;
+    }
+    lastSwapCount = swaps;
+}
+
+void SweepAndPruneBroadPhase::update(float predictionTime, float margin)
+{
+    this->predictionTime = predictionTime;
+    this->aabbMargin = margin;
+    for (Proxy& proxy : proxies)
+    {
+        updateProxy(proxy);
+    }
+    sortEndpoints();
+    chooseAxis();
+}
+
+void SweepAndPruneBroadPhase::collectCollisionPairs(std::vector<std::pair<Entity*, Entity*>>& pairs)
+{
+    if (unsorted) sortEndpoints();
+
+    pairs.clear();
+    active.clear();
+    for (const Endpoint& endpoint : endpoints)
+    {
+        uint32_t proxyId = endpoint.proxy();
+        Proxy& proxy = proxies[proxyId];
+        if (endpoint.isMax())
+        {
+            // 从活动集合中移除（与末尾交换）
+            uint32_t last = active.back();
+            active[proxy.activeIndex] = last;
+            proxies[last].activeIndex = proxy.activeIndex;
+            active.pop_back();
+            continue;
+        }
+
+        // 活动集合中的区间在排序轴上都与当前区间重叠，只需再检查另外两条轴
+        for (uint32_t otherId : active)
+        {
+            const Proxy& other = proxies[otherId];
+            if (other.entity == proxy.entity) continue; // 过滤自碰撞
+            if (!checkAABBCollision(proxy.fitAABB, other.fitAABB)) continue;
+            // 按插入顺序排列 pair（与内存地址无关），结果可复现
+            if (otherId < proxyId)
+            {
+                pairs.emplace_back(other.entity, proxy.entity);
+            }
+            else
+            {
+                pairs.emplace_back(proxy.entity, other.entity);
+            }
+        }
+        proxy.activeIndex = static_cast<uint32_t>(active.size());
+        active.push_back(proxyId);
+    }
+    XPBD_LOG_DEBUG(BroadPhase, "Potential collisions: %zu", pairs.size());
+}
@@ -0,0 +1,72 @@
+#ifndef SWEEP_AND_PRUNE_BROAD_PHASE_H
+#define SWEEP_AND_PRUNE_BROAD_PHASE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <vector>
+#include "physics/broad_phase.h"
+#include "physics/entity.h"
+
+// 扫掠剪枝（sweep and prune）
+// 所有包围盒在一条轴上的端点保存在一个数组中，跨帧保持有序：运动连贯时每帧只需少量相邻交换（插入排序）
+// 轴取包围盒中心方差最大的方向，使投影区间尽量分散；数量多、尺寸相近、整体平移的场景通常比树更快
+class SweepAndPruneBroadPhase : public BroadPhase
+{
+    public:
+        SweepAndPruneBroadPhase();
+
+        void addObject(Entity* entity) override;
+        void update(float predictionTime = 0.0f, float margin = 0.0f) override;
+        // 沿轴扫描端点，维护当前区间重叠的活动集合，只对其中的实体检查另外两条轴
+        void collectCollisionPairs(std::vector<std::pair<Entity*, Entity*>>& pairs) override;
+
+        int getSortAxis() const { return axis; }
+        // 上次 update 中插入排序执行的交换次数，反映运动的连贯程度
+        size_t getSwapCount() const { return lastSwapCount; }
+
+    private:
+        struct Proxy
+        {
+            Entity* entity;
+            AABB fitAABB;            // 网格包围盒 + 速度扫掠 + 接触余量
+            AABB shapeAABB;          // 网格在 lastPosition/lastRotation 下的包围盒，位姿不变时复用
+            glm::vec3 lastPosition;
+            glm::quat lastRotation;
+            uint32_t activeIndex;    // 在扫描的活动集合中的位置
+        };
+
+        // 端点：data 的最低位为 1 表示区间终点，其余位为 proxy 下标
+        struct Endpoint
+        {
+            float value;
+            uint32_t data;
+
+            uint32_t proxy() const { return data >> 1; }
+            bool isMax() const { return (data & 1u) != 0; }
+            // 值相同时起点排在终点之前，使相接触的区间也算重叠
+            bool operator<(const Endpoint& other) const
+            {
+                return value < other.value || (value == other.value && (data & 1u) < (other.data & 1u));
+            }
+        };
+
+        std::vector<Proxy> proxies;
+        std::vector<Endpoint> endpoints;
+        std::vector<uint32_t> active;
+        int axis;
+        bool unsorted;                 // 添加了新端点，尚未排序
+        size_t lastSwapCount;
+        float predictionTime;
+        float aabbMargin;
+
+        void updateProxy(Proxy& proxy);
+        // 方差最大的轴明显优于当前轴时切换，并对端点整体重新排序
+        void chooseAxis();
+        void refreshEndpoints();
+        void insertionSort();
+        // 用最新的包围盒刷新端点值并恢复有序
+        void sortEndpoints();
+};
+
+#endif
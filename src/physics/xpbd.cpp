@@ -1,13 +1,69 @@
 #include "physics/xpbd.h"
 #include "physics/collision_narrow_phase.h"
 #include "physics/physics_util.h"
-#include <GL/glew.h>
+#include "core/log.h"
+#include "core/profiler.h"
 #include <iostream>
 #include <cmath>
 #include <vector>
 #include <limits>
+#include <algorithm>
 
-XPBDSystem::XPBDSystem() : gravity(-9.81f), timeStep(1.0f / 120.0f) {}
+XPBDSystem::XPBDSystem() : gravity(-9.81f), timeStep(1.0f / 120.0f), accumulator(0.0f), maxStepsPerFrame(8), substepCount(4), iterationCount(1), contactMargin(0.01f),
+      solverMode(SolverMode::GaussSeidel), relaxation(1.0f),
+      sleepEnabled(true), sleepLinearThreshold(0.05f), sleepAngularThreshold(0.5f), timeToSleep(0.5f),
+      broadPhaseType(BroadPhaseType::AABBTree), broadPhase(new CollisionBroadPhase()), skippedNarrowPhaseCount(0), coloredStaticVersion(0),
+      threadPool(&ThreadPool::shared())
+{
+    broadPhase->setThreadPool(threadPool);
+}
+
+void XPBDSystem::setBroadPhaseType(BroadPhaseType type)
+{
+    if (type == broadPhaseType) return;
+    broadPhaseType = type;
+    if (type == BroadPhaseType::SweepAndPrune)
+    {
+        broadPhase.reset(new SweepAndPruneBroadPhase());
+    }
+    else if (type == BroadPhaseType::SpatialHash)
+    {
+        broadPhase.reset(new SpatialHashGrid());
+    }
+    else
+    {
+        broadPhase.reset(new CollisionBroadPhase());
+    }
+    broadPhase->setThreadPool(threadPool);
+    for (Entity* entity : objects)
+    {
+        broadPhase->addObject(entity);
+    }
+}
+
+void XPBDSystem::setSleepEnabled(bool enabled)
+{
+    sleepEnabled = enabled;
+    if (!enabled)
+    {
+        for (uint32_t i = 0; i < bodies.size(); ++i) bodies.wakeUp(i);
+        islands.clearSleepingIslands();
+    }
+}
+
+void XPBDSystem::setThreadCount(size_t count)
+{
+    ownedThreadPool.reset(new ThreadPool(count));
+    threadPool = ownedThreadPool.get();
+    broadPhase->setThreadPool(threadPool);
+}
+
+void XPBDSystem::setThreadPool(ThreadPool* pool)
+{
+    threadPool = pool ? pool : &ThreadPool::shared();
+    broadPhase->setThreadPool(threadPool);
+    if (ownedThreadPool.get() != threadPool) ownedThreadPool.reset();
+}
 
 void XPBDSystem::initialize()
 {
@@ -18,9 +74,9 @@ void XPBDSystem::initialize()
 
         float m = 1.0f;
         float mass = 0;
-        std::vector<glm::vec3> vertices = obj->getMesh()->getPositions();
+        const std::vector<glm::vec3>& vertices = obj->getMesh()->getPositions();
         glm::mat4x4 I_ref = glm::mat4x4(0.0f);
-        for (int i = 0; i < vertices.size(); ++i)
+        for (size_t i = 0; i < vertices.size(); ++i)
         {
             mass += m;
             float diag = m * get_sqr_magnitude(vertices[i]);
@@ -40,9 +96,9 @@ void XPBDSystem::initialize()
         I_ref[3][3] = 1.0f;
         obj->setMass(mass);
         obj->setIRef(I_ref);
-        std::cout << " 物体惯量矩阵计算完成" << obj << "：mass：" << mass << "I_ref：" << I_ref[0][0] << std::endl;
+        XPBD_LOG_INFO(Solver, "物体惯量矩阵计算完成 %p：mass：%g I_ref：%g", (const void*)obj, mass, I_ref[0][0]);
     }
-    std::cout << "XPBD System Initialized" << std::endl;
+    XPBD_LOG_INFO(Solver, "XPBD System Initialized");
 }
 
 void XPBDSystem::addObject(Entity* entity)
@@ -57,226 +113,696 @@ void XPBDSystem::addObject(Entity* entity)
         std::cerr << "Error: Entity has null Mesh" << std::endl;
         return;
     }
-    if (entity->getMesh()->getVAO() == 0)
+    entity->attachToStore(&bodies);
+    objects.push_back(entity);
+    broadPhase->addObject(entity);
+}
+
+void XPBDSystem::addConstraint(Constraint* constraint)
+{
+    if (constraint == nullptr)
     {
-        entity->getMesh()->initialize();
+        std::cerr << "Error: Attempt to add null Constraint to XPBDSystem" << std::endl;
+        return;
     }
-    objects.push_back(entity);
-    broadPhase.addObject(entity);
+    constraints.push_back(constraint);
+    // 着色依赖刚体在 BodyStore 中的下标，推迟到下一次 run() 时进行（届时实体都已加入系统）
+    pendingConstraints.push_back(constraint);
+}
+
+void XPBDSystem::removeConstraint(Constraint* constraint)
+{
+    constraints.erase(std::remove(constraints.begin(), constraints.end(), constraint), constraints.end());
+    pendingConstraints.erase(std::remove(pendingConstraints.begin(), pendingConstraints.end(), constraint), pendingConstraints.end());
+    constraintGraph.removeConstraint(constraint);
 }
 
 void XPBDSystem::run()
 {
-    for (auto& obj : objects)
+    XPBD_PROFILE_ZONE("XPBDSystem::run");
+    // 有刚体在静态与动态之间切换时，原着色可能让同一颜色的两个约束写同一个刚体，整体重新着色
+    if (coloredStaticVersion != bodies.staticVersion)
     {
-        // 排除地面
-        if (obj->getMass() == 0) continue;
-        // 应用重力和阻尼
-        obj->setLinearVelocity(obj->getLinearVelocity() + glm::vec3(0.0f, gravity * timeStep, 0.0f));
-        obj->setLinearVelocity(obj->getLinearVelocity() * 0.99f);
-        obj->setAngularVelocity(obj->getAngularVelocity() * 0.99f);
+        coloredStaticVersion = bodies.staticVersion;
+        constraintGraph.clear();
+        pendingConstraints = constraints;
+    }
+    // 新增的用户约束增量着色
+    for (Constraint* constraint : pendingConstraints)
+    {
+        constraintGraph.addConstraint(constraint);
+    }
+    pendingConstraints.clear();
+
+    // 宽相 + 窄相：每个时间步只做一次，按预测位置生成接触约束
+    collectContacts();
+    buildIslands();
+    if (solverMode == SolverMode::Jacobi)
+    {
+        prepareJacobi();
+    }
+
+    const float h = timeStep / substepCount;
+    for (int substep = 0; substep < substepCount; ++substep)
+    {
+        integrate(h);
+        solvePositions(h);
+        updateVelocities(h);
+        solveVelocities(h);
+    }
+
+    if (solverMode == SolverMode::Jacobi)
+    {
+        releaseJacobi();
+    }
+    updateSleeping();
+
+    for (uint32_t i = 0; i < bodies.size(); ++i)
+    {
+        bodies.forces[i] = glm::vec3(0.0f);
+        bodies.torques[i] = glm::vec3(0.0f);
     }
+}
 
-    // 宽相检测
-    broadPhase.update();
-    std::vector<std::pair<Entity*, Entity*>> potentialCollisions;
-    broadPhase.collectCollisionPairs(potentialCollisions);
+int XPBDSystem::step(float elapsedSeconds)
+{
+    accumulator += std::max(elapsedSeconds, 0.0f);
+
+    int steps = 0;
+    while (accumulator >= timeStep && steps < maxStepsPerFrame)
+    {
+        stepStartPositions = bodies.positions;
+        stepStartRotations = bodies.rotations;
+        run();
+        accumulator -= timeStep;
+        ++steps;
+    }
+
+    // 达到步数上限时丢弃积压的整步，只保留不足一步的部分用于插值
+    if (accumulator >= timeStep)
+    {
+        accumulator = std::fmod(accumulator, timeStep);
+    }
+    return steps;
+}
+
+glm::vec3 XPBDSystem::getInterpolatedPosition(const Entity* entity) const
+{
+    uint32_t i = entity->getBodyIndex();
+    if (entity->getStore() != &bodies || i >= stepStartPositions.size()) return entity->getPosition();
+    return glm::mix(stepStartPositions[i], bodies.positions[i], getInterpolationAlpha());
+}
+
+glm::quat XPBDSystem::getInterpolatedRotation(const Entity* entity) const
+{
+    uint32_t i = entity->getBodyIndex();
+    if (entity->getStore() != &bodies || i >= stepStartRotations.size()) return entity->getRotation();
+    return glm::slerp(stepStartRotations[i], bodies.rotations[i], getInterpolationAlpha());
+}
+
+glm::vec3 XPBDSystem::predictPosition(const Entity* obj) const
+{
+    if (obj->getInverseMass() == 0.0f) return obj->getPosition();
+    glm::vec3 velocity = obj->getLinearVelocity() + glm::vec3(0.0f, gravity * timeStep, 0.0f);
+    return obj->getPosition() + velocity * timeStep;
+}
+
+void XPBDSystem::collectContacts()
+{
+    XPBD_PROFILE_ZONE("collectContacts");
+    contactConstraints.clear();
+
+    // 宽相检测：包围盒覆盖本时间步的速度位移，并额外外扩重力位移与接触余量
+    {
+        XPBD_PROFILE_ZONE("broadPhase.update");
+        broadPhase->update(timeStep, std::fabs(gravity) * timeStep * timeStep + contactMargin);
+    }
+    {
+        XPBD_PROFILE_ZONE("collectCollisionPairs");
+        broadPhase->collectCollisionPairs(potentialCollisions);
+    }
+    // AABB 树宽相的 Begin/Persist 事件与碰撞对一一对应，通过它取得跨时间步保留的窄相缓存
+    CollisionBroadPhase* pairCache = nullptr;
+    if (broadPhaseType == BroadPhaseType::AABBTree)
+    {
+        pairCache = static_cast<CollisionBroadPhase*>(broadPhase.get());
+    }
 
     // 窄相处理
-    for (const auto& pair : potentialCollisions)
+    XPBD_PROFILE_ZONE("narrowPhase");
+    skippedNarrowPhaseCount = 0;
+    for (size_t i = 0; i < potentialCollisions.size(); ++i)
     {
-        Entity* obj1 = pair.first;
-        Entity* obj2 = pair.second;
-        
+        Entity* obj1 = potentialCollisions[i].first;
+        Entity* obj2 = potentialCollisions[i].second;
+        // 两侧都是静态或休眠刚体时不会产生新的运动，跳过窄相
+        bool inactive1 = obj1->getInverseMass() == 0.0f || obj1->isSleeping();
+        bool inactive2 = obj2->getInverseMass() == 0.0f || obj2->isSleeping();
+        if (inactive1 && inactive2) continue;
+
         bool isGroundInvolved = (obj1->getMass() == 0 || obj2->getMass() == 0);
-            
-        if(isGroundInvolved)
+        if (isGroundInvolved)
         {
             Entity* movingObj = (obj1->getMass() != 0) ? obj1 : obj2;
-            applyImpulseWithGround(movingObj, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            Entity* ground = (movingObj == obj1) ? obj2 : obj1;
+            addGroundContact(movingObj, ground);
         }
         else
         {
-            float penetration = 0.0f;
-            glm::vec3 normal(0.0f);
-            if (narrowPhase.detectCollision(obj1, obj1->getPosition(), obj2, obj2->getPosition(), penetration, normal))
-            {
-                std::cout << "Collision between " << obj1 << " and " << obj2 << " detected!" << std::endl;
+            addBodyContact(obj1, obj2, pairCache ? &pairCache->getPairData(pairCache->getPairEvents()[i].slot) : nullptr);
+        }
+    }
+
+    // 接触约束全部生成后再着色（vector 不再扩容，指针保持有效）；Jacobi 模式不需要着色
+    contactGraph.clear();
+    if (solverMode == SolverMode::GaussSeidel)
+    {
+        for (CollisionConstraint& contact : contactConstraints)
+        {
+            contactGraph.addConstraint(&contact);
+        }
+    }
+}
 
-                // 确保法线方向正确（指向 obj2 到 obj1）
-                glm::vec3 direction = obj2->getPosition() - obj1->getPosition();
-                if (glm::dot(normal, direction) < 0)
-                    normal = -normal;
+void XPBDSystem::buildIslands()
+{
+    XPBD_PROFILE_ZONE("buildIslands");
+    if (!sleepEnabled) return;
 
-                applyImpulse(obj1, obj2, normal);
-            }
+    const float* inverseMasses = bodies.inverseMasses.data();
+    auto isAwakeDynamic = [&](uint32_t body) { return inverseMasses[body] > 0.0f && !bodies.isSleeping(body); };
+
+    // 唤醒 body 所在的整个休眠岛，返回是否有刚体被唤醒
+    auto wakeIsland = [&](uint32_t body)
+    {
+        uint32_t island = islands.getSleepingIsland(body);
+        if (island == SimulationIslands::NoIsland)
+        {
+            if (!bodies.isSleeping(body)) return false;
+            bodies.wakeUp(body);
+            return true;
         }
+        for (uint32_t member : islands.removeSleepingIsland(island))
+        {
+            bodies.wakeUp(member);
+        }
+        return true;
+    };
+
+    // 被外力等单独唤醒的刚体带醒原来的整个岛；唤醒会向 awakeBodies 追加刚体，因此按下标遍历
+    for (size_t i = 0; i < bodies.awakeBodies.size(); ++i)
+    {
+        uint32_t body = bodies.awakeBodies[i];
+        if (islands.getSleepingIsland(body) != SimulationIslands::NoIsland) wakeIsland(body);
     }
 
-    // 更新位置和旋转
-    for (auto& obj : objects)
+    // 约束或接触一侧是活动的动态刚体时，另一侧所在的休眠岛也要唤醒；
+    // 用户约束可能把刚唤醒的岛再连到别的休眠岛上，直到没有新的唤醒为止
+    auto wakeConnected = [&](const Constraint* constraint)
+    {
+        bool anyAwake = false;
+        for (const Entity* entity : constraint->getEntities())
+        {
+            if (isAwakeDynamic(entity->getBodyIndex())) anyAwake = true;
+        }
+        if (!anyAwake) return false;
+        bool woke = false;
+        for (const Entity* entity : constraint->getEntities())
+        {
+            uint32_t body = entity->getBodyIndex();
+            if (inverseMasses[body] > 0.0f && bodies.isSleeping(body)) woke |= wakeIsland(body);
+        }
+        return woke;
+    };
+    for (const CollisionConstraint& contact : contactConstraints) wakeConnected(&contact);
+    bool woke = true;
+    while (woke)
+    {
+        woke = false;
+        for (const Constraint* constraint : constraints) woke |= wakeConnected(constraint);
+    }
+
+    // 只在活动的动态刚体上重建，休眠的岛保持不变
+    islands.reset(bodies.size());
+    for (uint32_t body : bodies.awakeBodies)
+    {
+        if (inverseMasses[body] > 0.0f) islands.addBody(body);
+    }
+
+    // 只有两个动态刚体之间的约束才连接岛
+    auto connectEntities = [&](const Constraint* constraint)
     {
-        glm::vec3 ve = obj->getLinearVelocity();
-        std::cout << " 物体" << obj << "此刻的速度是" << ve.x << " " << ve.y << " " << ve.z << std::endl;
+        const Entity* first = nullptr;
+        for (const Entity* entity : constraint->getEntities())
+        {
+            if (!isAwakeDynamic(entity->getBodyIndex())) continue;
+            if (first == nullptr) first = entity;
+            else islands.connect(first->getBodyIndex(), entity->getBodyIndex());
+        }
+    };
+    for (const Constraint* constraint : constraints) connectEntities(constraint);
+    for (const CollisionConstraint& contact : contactConstraints) connectEntities(&contact);
 
-        glm::vec3 x_0 = obj->getPosition();
-        glm::quat q_0 = obj->getRotation();
+    islands.build();
+}
 
-        glm::vec3 x = x_0 + obj->getLinearVelocity() * timeStep;
+void XPBDSystem::updateSleeping()
+{
+    XPBD_PROFILE_ZONE("updateSleeping");
+    if (!sleepEnabled) return;
 
-        glm::vec3 dw = 0.5f * obj->getAngularVelocity() * timeStep;
-        glm::quat qw(dw.x, dw.y, dw.z, 0.0f);
-        glm::quat q = glm::normalize(Add(q_0, qw * q_0));
+    const float linearSq = sleepLinearThreshold * sleepLinearThreshold;
+    const float angularSq = sleepAngularThreshold * sleepAngularThreshold;
+    for (uint32_t island = 0; island < islands.getIslandCount(); ++island)
+    {
+        const uint32_t* begin = islands.getIslandBegin(island);
+        const uint32_t* end = islands.getIslandEnd(island);
 
-        obj->setPosition(x);
-        obj->setRotation(q);
+        // 每个刚体单独计时，岛的计时取最小值
+        float islandTimer = std::numeric_limits<float>::max();
+        for (const uint32_t* body = begin; body != end; ++body)
+        {
+            uint32_t i = *body;
+            bool slow = glm::dot(bodies.linearVelocities[i], bodies.linearVelocities[i]) < linearSq &&
+                        glm::dot(bodies.angularVelocities[i], bodies.angularVelocities[i]) < angularSq;
+            bodies.sleepTimers[i] = slow ? bodies.sleepTimers[i] + timeStep : 0.0f;
+            islandTimer = std::min(islandTimer, bodies.sleepTimers[i]);
+        }
+        if (islandTimer < timeToSleep) continue;
+
+        for (const uint32_t* body = begin; body != end; ++body)
+        {
+            bodies.sleep(*body);
+        }
+        islands.addSleepingIsland(begin, end);
     }
 }
 
-void XPBDSystem::applyImpulse(Entity* obj1, Entity* obj2, glm::vec3 N)
+bool XPBDSystem::isConstraintAsleep(const Constraint* constraint)
 {
-    // 假设碰撞点为两物体中心的连线上的点
-    glm::vec3 T1 = obj1->getPosition();
-    glm::vec3 T2 = obj2->getPosition();
-    glm::vec3 P = (T1 + T2) * 0.5f; // 碰撞点近似为两中心的中点
-
-    // 计算相对于各自中心的碰撞点偏移
-    glm::vec3 r_i1 = P - T1;
-    glm::vec3 r_i2 = P - T2;
-
-    // 获取旋转矩阵
-    glm::mat4x4 R1 = glm::mat4_cast(obj1->getRotation());
-    glm::mat4x4 R2 = glm::mat4_cast(obj2->getRotation());
-
-    // 变换到世界坐标
-    glm::vec3 Rri1 = glm::mat3(R1) * r_i1;
-    glm::vec3 Rri2 = glm::mat3(R2) * r_i2;
-
-    // 计算碰撞点的速度
-    glm::vec3 v_collision1 = obj1->getLinearVelocity() + glm::cross(obj1->getAngularVelocity(), r_i1);
-    glm::vec3 v_collision2 = obj2->getLinearVelocity() + glm::cross(obj2->getAngularVelocity(), r_i2);
-
-    // 相对速度
-    glm::vec3 v_rel = v_collision1 - v_collision2;
-    glm::vec3 v_N = glm::dot(v_rel, N) * N;
-    glm::vec3 v_T = v_rel - v_N;
-
-    // 反弹和摩擦系数
-    float restitution = 0.5f;
-    float friction = 0.2f;
-    glm::vec3 v_N_new = -restitution * v_N;
-    float v_T_len = glm::length(v_T);
-    float v_N_len = glm::length(v_N);
-    float a = glm::max(1.0f - friction * (1.0f + restitution) * v_N_len / (v_T_len + 0.01f), 0.0f);
-    std::cout << "a is " << a << ", v_N_len: " << v_N_len << ", v_T_len: " << v_T_len << std::endl;
-    glm::vec3 v_T_new = a * v_T;
-    glm::vec3 v_new = v_N_new + v_T_new;
-
-    // 计算冲量 J
-    glm::mat4x4 I_rot1 = R1 * obj1->getIRef() * glm::transpose(R1);
-    glm::mat4x4 I_inv1 = glm::inverse(I_rot1);
-    glm::mat4x4 I_rot2 = R2 * obj2->getIRef() * glm::transpose(R2);
-    glm::mat4x4 I_inv2 = glm::inverse(I_rot2);
-
-    glm::mat4x4 Rri_star1 = get_Cross_Matrix(r_i1);
-    glm::mat4x4 Rri_star2 = get_Cross_Matrix(r_i2);
-    glm::mat4x4 identity_matrix(1.0f);
-    glm::mat4x4 K1 = Matrix_Subtraction(Matrix_Multiply_Float(identity_matrix, obj1->getInverseMass()), Rri_star1 * I_inv1 * Rri_star1);
-    glm::mat4x4 K2 = Matrix_Subtraction(Matrix_Multiply_Float(identity_matrix, obj2->getInverseMass()), Rri_star2 * I_inv2 * Rri_star2);
-    glm::mat4x4 K = K1 + K2;
-    std::cout << "K matrix: " << K[0][0] << " " << K[1][1] << " " << K[2][2] << std::endl;
-    glm::vec3 J = glm::mat3(glm::inverse(K)) * (v_new - v_rel);
-    std::cout << "J is " << J.x << " " << J.y << " " << J.z << std::endl;
-
-    // 应用冲量
-    obj1->setLinearVelocity(obj1->getLinearVelocity() + obj1->getInverseMass() * J);
-    obj1->setAngularVelocity(obj1->getAngularVelocity() + glm::mat3(I_inv1) * glm::cross(r_i1, J));
-    obj2->setLinearVelocity(obj2->getLinearVelocity() - obj2->getInverseMass() * J);
-    obj2->setAngularVelocity(obj2->getAngularVelocity() + glm::mat3(I_inv2) * glm::cross(r_i2, -J));
-
-    // 静止检测
-    glm::vec3 v1 = obj1->getLinearVelocity();
-    if (glm::length(v1) < 0.05f)
-    {
-        obj1->setLinearVelocity(glm::vec3(0.0f));
-        obj1->setAngularVelocity(glm::vec3(0.0f));
-        std::cout << "Object " << obj1 << " stopped due to low velocity" << std::endl;
-    }
-
-    glm::vec3 v2 = obj2->getLinearVelocity();
-    if (glm::length(v2) < 0.05f)
-    {
-        obj2->setLinearVelocity(glm::vec3(0.0f));
-        obj2->setAngularVelocity(glm::vec3(0.0f));
-        std::cout << "Object " << obj2 << " stopped due to low velocity" << std::endl;
+    for (const Entity* entity : constraint->getEntities())
+    {
+        if (entity->getInverseMass() > 0.0f && !entity->isSleeping()) return false;
     }
+    return true;
 }
 
-void XPBDSystem::applyImpulseWithGround(Entity* obj, glm::vec3 P, glm::vec3 N)
+void XPBDSystem::addGroundContact(Entity* obj, Entity* ground)
 {
-    std::vector<glm::vec3> vertices = obj->getMesh()->getPositions();
+    XPBD_PROFILE_ZONE("addGroundContact");
+    // 地面视为一个向上的平面，高度取地面包围盒的顶面
+    const glm::vec3 N(0.0f, 1.0f, 0.0f);
+    glm::vec3 P = ground->getPosition();
+    P.y = BroadPhase::computeAABB(ground).max.y;
+
+    // 在预测位置上找出所有会穿透或接近地面的顶点
+    // 接近但未穿透的顶点生成的约束在子步中穿透时才生效，避免其他约束把物体推入地面
+    const Mesh* mesh = obj->getMesh();
+    const std::vector<glm::vec3>& vertices = mesh->getPositions();
+    glm::mat3 R = glm::mat3_cast(obj->getRotation());
+    glm::vec3 T = predictPosition(obj);
+
+    // 连续碰撞检测：本时间步内朝向不变，最低顶点的高度随时间线性变化，直接解出首次触地的时刻，
+    // 在该时刻的位形上收集接触顶点，而不是在已经穿过薄地面的预测位置上把所有顶点都当作穿透
+    if (obj->isCCDEnabled())
+    {
+        const glm::vec3 start = obj->getPosition();
+        const glm::vec3 motion = T - start;
+        if (glm::length(motion) > CCDMotionRatio * mesh->getBoundingSphereRadius())
+        {
+            float lowest = std::numeric_limits<float>::max();
+            for (const glm::vec3& vertex : vertices)
+            {
+                lowest = std::min(lowest, glm::dot(R * vertex, N));
+            }
+            float startHeight = glm::dot(start - P, N) + lowest;
+            float endHeight = glm::dot(T - P, N) + lowest;
+            if (startHeight >= 0.0f && endHeight < 0.0f)
+            {
+                float t = startHeight / (startHeight - endHeight);
+                T = start + motion * t;
+                XPBD_LOG_TRACE(Solver, "Continuous ground contact of %p at t = %g", (const void*)obj, t);
+            }
+        }
+    }
 
-    glm::mat4x4 R = glm::mat4_cast(obj->getRotation());
-    glm::vec3 T = obj->getPosition();
+    // 包围球的最低点也离地面超过余量时不会有顶点满足条件，跳过逐顶点检查
+    glm::vec3 sphereCenter = T + R * mesh->getBoundingSphereCenter();
+    if (glm::dot(sphereCenter - P, N) - mesh->getBoundingSphereRadius() >= contactMargin) return;
 
-    glm::vec3 sum(0.0f, 0.0f, 0.0f);
+    glm::vec3 sum(0.0f);
     int collisionNum = 0;
+    float maxPenetration = -std::numeric_limits<float>::max();
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        glm::vec3 Rri = R * vertices[i];
+        float d = glm::dot(T + Rri - P, N);
+        if (d < contactMargin)
+        {
+            sum += Rri;
+            collisionNum++;
+            maxPenetration = std::max(maxPenetration, -d);
+        }
+    }
+    if (collisionNum == 0) return;
+
+    // 接触点取穿透顶点的平均位置，对应地面上的点按最大穿透深度放置
+    glm::vec3 r1 = sum / (float)collisionNum;
+    glm::vec3 pointOnGround = T + r1 + N * maxPenetration;
+    glm::vec3 r2 = pointOnGround - ground->getPosition();
+    contactConstraints.emplace_back(obj, ground, r1, r2, -N, std::fabs(gravity));
+}
+
+void XPBDSystem::addBodyContact(Entity* obj1, Entity* obj2, PairCacheData* cache)
+{
+    XPBD_PROFILE_ZONE("addBodyContact");
+    if ((obj1->isCCDEnabled() || obj2->isCCDEnabled()) && addContinuousContact(obj1, obj2)) return;
+
+    glm::vec3 pos1 = predictPosition(obj1);
+    glm::vec3 pos2 = predictPosition(obj2);
+    glm::vec3 relative = pos2 - pos1;
+
+    // 网格 SDF：间隙 = 两个中心处的 SDF 之和 - 中心距；SDF 是 1-Lipschitz 的，
+    // 因此间隙的变化不超过 3 倍相对位移，加上两侧转角乘以中心距（查询点在对方局部坐标系中的移动）
+    // GJK：间隙是两形状的距离（布尔 GJK 提前排除时为其下界），变化不超过相对位移加上转角乘以形状的半径
+    // 转角项取中心距和两侧半径之和中的较大者，两种窄相都成立
+    if (cache && cache->separation > 0.0f)
+    {
+        auto angle = [](const glm::quat& a, const glm::quat& b)
+        {
+            return 2.0f * std::acos(std::min(std::fabs(glm::dot(a, b)), 1.0f));
+        };
+        auto reach = [](const Entity* entity)
+        {
+            const Mesh* mesh = entity->getMesh();
+            return glm::length(mesh->getBoundingSphereCenter()) + mesh->getBoundingSphereRadius();
+        };
+        float lever = std::max(glm::length(cache->relativePosition), reach(obj1) + reach(obj2));
+        float drift = 3.0f * glm::length(relative - cache->relativePosition) +
+                      (angle(cache->rotationA, obj1->getRotation()) + angle(cache->rotationB, obj2->getRotation())) * lever;
+        if (drift < cache->separation)
+        {
+            ++skippedNarrowPhaseCount;
+            return;
+        }
+    }
+
+    float penetration = 0.0f;
+    glm::vec3 normal(0.0f);
+    float separation = 0.0f;
+    // 缓存中的特征为上次的支撑顶点，凸碰撞体从它开始爬山；缓存的分离轴让凸碰撞体先做布尔 GJK 提前排除
+    bool collided = narrowPhase.detectCollision(obj1, pos1, obj2, pos2, penetration, normal, separation,
+                                                cache ? &cache->featureA : nullptr,
+                                                cache ? &cache->featureB : nullptr,
+                                                cache ? &cache->separatingAxis : nullptr);
+    if (cache)
+    {
+        cache->separation = separation;
+        cache->relativePosition = relative;
+        cache->rotationA = obj1->getRotation();
+        cache->rotationB = obj2->getRotation();
+    }
+    if (!collided) return;
+
+    XPBD_LOG_TRACE(Solver, "Collision between %p and %p detected!", (const void*)obj1, (const void*)obj2);
+
+    // 确保法线方向正确（从 obj1 指向 obj2）
+    glm::vec3 direction = pos2 - pos1;
+    if (glm::dot(normal, direction) < 0)
+        normal = -normal;
+    emplaceBodyContact(obj1, pos1, obj2, pos2, normal, penetration);
+}
+
+void XPBDSystem::emplaceBodyContact(Entity* obj1, const glm::vec3& pos1, Entity* obj2, const glm::vec3& pos2,
+    const glm::vec3& normal, float penetration)
+{
+    // 接触点近似为两中心的中点，两侧各沿法线偏移半个穿透深度
+    glm::vec3 P = (pos1 + pos2) * 0.5f;
+    glm::vec3 r1 = P + normal * (0.5f * penetration) - pos1;
+    glm::vec3 r2 = P - normal * (0.5f * penetration) - pos2;
+    contactConstraints.emplace_back(obj1, obj2, r1, r2, normal, std::fabs(gravity));
+}
+
+bool XPBDSystem::addContinuousContact(Entity* obj1, Entity* obj2)
+{
+    XPBD_PROFILE_ZONE("addContinuousContact");
+    // 本时间步内两侧都沿直线从当前位置运动到预测位置，朝向保持不变
+    const glm::vec3 start1 = obj1->getPosition();
+    const glm::vec3 start2 = obj2->getPosition();
+    const glm::vec3 motion1 = predictPosition(obj1) - start1;
+    const glm::vec3 motion2 = predictPosition(obj2) - start2;
+    const float relativeMotion = glm::length(motion2 - motion1);
+    const float radius = std::min(obj1->getMesh()->getBoundingSphereRadius(), obj2->getMesh()->getBoundingSphereRadius());
+    if (relativeMotion <= CCDMotionRatio * radius) return false;
+
+    // 保守前进：间隙对相对位移是 3-Lipschitz 的（见 addBodyContact），
+    // 每次按当前间隙前进 separation / (3 * 相对位移) 的时间比例，不会越过第一次接触
+    const float tolerance = std::max(0.5f * contactMargin, 1e-4f);
+    float t = 0.0f;
+    glm::vec3 pos1, pos2, normal;
+    float penetration = 0.0f;
+    for (int iteration = 0; ; ++iteration)
+    {
+        pos1 = start1 + motion1 * t;
+        pos2 = start2 + motion2 * t;
+        normal = glm::vec3(0.0f);
+        float separation = 0.0f;
+        bool collided = narrowPhase.detectCollision(obj1, pos1, obj2, pos2, penetration, normal, separation);
+        if (collided || separation <= tolerance || iteration == MaxCCDIterations)
+        {
+            if (!collided) penetration = -separation;
+            break;
+        }
+        t += separation / (3.0f * relativeMotion);
+        // 整个时间步内都不接触
+        if (t >= 1.0f) return true;
+    }
+
+    // 在碰撞时刻的位形上生成接触：锚点在两表面上，约束只阻止越过该位形，不会把快速刚体推到另一侧
+    // 法线沿用窄相给出的表面法线，与 addBodyContact 一样统一为从 obj1 指向 obj2；退化时才取中心连线或相对运动方向
+    glm::vec3 direction = pos2 - pos1;
+    if (glm::dot(normal, normal) > 0.0f)
+    {
+        if (glm::dot(normal, direction) < 0.0f) normal = -normal;
+    }
+    else
+    {
+        float distance = glm::length(direction);
+        normal = distance > 0.0f ? direction / distance : glm::normalize(motion1 - motion2);
+    }
+    XPBD_LOG_TRACE(Solver, "Continuous collision between %p and %p at t = %g", (const void*)obj1, (const void*)obj2, t);
+    emplaceBodyContact(obj1, pos1, obj2, pos2, normal, penetration);
+    return true;
+}
+
+void XPBDSystem::integrate(float h)
+{
+    XPBD_PROFILE_ZONE("integrate");
+    const uint32_t bodyCount = bodies.size();
+    previousPositions.resize(bodyCount);
+    previousRotations.resize(bodyCount);
+
+    glm::vec3* positions = bodies.positions.data();
+    glm::vec3* linearVelocities = bodies.linearVelocities.data();
+    glm::vec3* angularVelocities = bodies.angularVelocities.data();
+    glm::quat* rotations = bodies.rotations.data();
+    const float* inverseMasses = bodies.inverseMasses.data();
+    const glm::vec3* forces = bodies.forces.data();
+    const uint8_t* sleepingFlags = bodies.sleepingFlags.data();
+
+    // 阻尼按子步数分摊，保证每个时间步总体衰减 0.99
+    const float damping = std::pow(0.99f, 1.0f / substepCount);
+    const float gravityStep = gravity * h;
+    for (uint32_t i = 0; i < bodyCount; ++i)
+    {
+        previousPositions[i] = positions[i];
+        previousRotations[i] = rotations[i];
+        if (sleepingFlags[i]) continue;
+
+        // 地面等静态物体逆质量为 0，不受重力和外力影响
+        float dynamicMask = (inverseMasses[i] > 0.0f) ? 1.0f : 0.0f;
+        linearVelocities[i] += forces[i] * (inverseMasses[i] * h);
+        linearVelocities[i].y += gravityStep * dynamicMask;
+        linearVelocities[i] *= damping;
+        angularVelocities[i] *= damping;
+
+        positions[i] += linearVelocities[i] * h;
+
+        glm::vec3 dw = 0.5f * angularVelocities[i] * h;
+        glm::quat qw(0.0f, dw.x, dw.y, dw.z);
+        rotations[i] = glm::normalize(Add(rotations[i], qw * rotations[i]));
+    }
+}
+
+template <typename Solve>
+void XPBDSystem::solveColored(const ConstraintGraph& graph, const Solve& solve)
+{
+    for (int color = 0; color < graph.getColorCount(); ++color)
+    {
+        const std::vector<Constraint*>& list = graph.getColor(color);
+        if (graph.isSerialColor(color))
+        {
+            for (Constraint* constraint : list) solve(constraint);
+            continue;
+        }
+        threadPool->parallelFor(list.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i) solve(list[i]);
+        });
+    }
+}
+
+void XPBDSystem::prepareJacobi()
+{
+    XPBD_PROFILE_ZONE("prepareJacobi");
+    jacobiConstraints.assign(constraints.begin(), constraints.end());
+    for (CollisionConstraint& contact : contactConstraints)
+    {
+        jacobiConstraints.push_back(&contact);
+    }
+
+    // 统计每个动态刚体参与的约束数，同时为每个约束分配连续的槽位
+    const uint32_t bodyCount = bodies.size();
+    bodyConstraintCounts.assign(bodyCount, 0);
+    uint32_t slotCount = 0;
+    for (Constraint* constraint : jacobiConstraints)
+    {
+        for (const Entity* entity : constraint->getEntities())
+        {
+            if (entity->getInverseMass() > 0.0f) bodyConstraintCounts[entity->getBodyIndex()]++;
+        }
+        slotCount += static_cast<uint32_t>(constraint->getEntities().size());
+    }
+    jacobiDeltas.resize(slotCount);
+
+    // 前缀和得到每个刚体在 bodySlots 中的区间，再填入槽位下标
+    bodySlotOffsets.resize(bodyCount + 1);
+    bodySlotOffsets[0] = 0;
+    for (uint32_t i = 0; i < bodyCount; ++i)
+    {
+        bodySlotOffsets[i + 1] = bodySlotOffsets[i] + bodyConstraintCounts[i];
+    }
+    bodySlots.resize(bodySlotOffsets[bodyCount]);
+    std::vector<uint32_t> fill(bodySlotOffsets.begin(), bodySlotOffsets.end() - 1);
+
+    uint32_t slot = 0;
+    for (Constraint* constraint : jacobiConstraints)
+    {
+        constraint->setJacobiOutput(jacobiDeltas.data() + slot, bodyConstraintCounts.data());
+        for (const Entity* entity : constraint->getEntities())
+        {
+            if (entity->getInverseMass() > 0.0f) bodySlots[fill[entity->getBodyIndex()]++] = slot;
+            ++slot;
+        }
+    }
+}
+
+void XPBDSystem::releaseJacobi()
+{
+    // 用户约束可能在之后以 Gauss-Seidel 模式求解，必须恢复直接写入刚体
+    for (Constraint* constraint : jacobiConstraints)
+    {
+        constraint->setJacobiOutput(nullptr, nullptr);
+    }
+    jacobiConstraints.clear();
+}
+
+template <typename Solve, typename Apply>
+void XPBDSystem::solveJacobi(const Solve& solve, const Apply& apply)
+{
+    std::fill(jacobiDeltas.begin(), jacobiDeltas.end(), BodyDelta());
 
-    for (int i = 0; i < vertices.size(); ++i)
+    // 所有约束读取同一份刚体状态，只写各自的槽位
+    threadPool->parallelFor(jacobiConstraints.size(), [&](size_t begin, size_t end)
     {
-        glm::vec3 r_i = vertices[i];
-        glm::vec3 Rri = glm::mat3(R) * r_i;
-        glm::vec3 x_i = T + Rri;
+        for (size_t i = begin; i < end; ++i) solve(jacobiConstraints[i]);
+    });
 
-        float d = glm::dot(x_i - P, N);
-        if (d < 0.0f)
+    // 每个刚体汇总自己的槽位，互不冲突
+    threadPool->parallelFor(bodies.size(), [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
         {
-            glm::vec3 v_i = obj->getLinearVelocity() + glm::cross(obj->getAngularVelocity(), Rri);
-            float v_N_size = glm::dot(v_i, N);
-            if (v_N_size < 0.0f)
+            if (bodySlotOffsets[i] == bodySlotOffsets[i + 1]) continue;
+            BodyDelta sum;
+            for (uint32_t k = bodySlotOffsets[i]; k < bodySlotOffsets[i + 1]; ++k)
             {
-                sum += r_i;
-                collisionNum ++;
+                sum.linear += jacobiDeltas[bodySlots[k]].linear;
+                sum.angular += jacobiDeltas[bodySlots[k]].angular;
             }
+            apply(static_cast<uint32_t>(i), sum);
+        }
+    });
+}
+
+void XPBDSystem::solvePositions(float h)
+{
+    XPBD_PROFILE_ZONE("solvePositions");
+    for (int iteration = 0; iteration < iterationCount; ++iteration)
+    {
+        auto solve = [h, iteration](Constraint* constraint)
+        {
+            if (!isConstraintAsleep(constraint)) constraint->solve(h, iteration);
+        };
+        if (solverMode == SolverMode::Jacobi)
+        {
+            // 位置修正按 relaxation 超松弛
+            solveJacobi(solve, [this](uint32_t i, const BodyDelta& delta)
+            {
+                bodies.positions[i] += delta.linear * relaxation;
+                glm::vec3 dTheta = delta.angular * relaxation;
+                glm::quat dq = glm::quat(0.0f, dTheta.x, dTheta.y, dTheta.z) * bodies.rotations[i];
+                bodies.rotations[i] = glm::normalize(Add(bodies.rotations[i], dq * 0.5f));
+            });
+            continue;
         }
+        solveColored(constraintGraph, solve);
+        solveColored(contactGraph, solve);
     }
+}
 
-    if (collisionNum == 0) return;
+void XPBDSystem::updateVelocities(float h)
+{
+    XPBD_PROFILE_ZONE("updateVelocities");
+    const uint32_t bodyCount = bodies.size();
+    const glm::vec3* positions = bodies.positions.data();
+    const glm::quat* rotations = bodies.rotations.data();
+    glm::vec3* linearVelocities = bodies.linearVelocities.data();
+    glm::vec3* angularVelocities = bodies.angularVelocities.data();
+    const float* inverseMasses = bodies.inverseMasses.data();
+    const uint8_t* sleepingFlags = bodies.sleepingFlags.data();
+
+    const float invH = 1.0f / h;
+    for (uint32_t i = 0; i < bodyCount; ++i)
+    {
+        if (inverseMasses[i] == 0.0f || sleepingFlags[i]) continue;
+
+        linearVelocities[i] = (positions[i] - previousPositions[i]) * invH;
+
+        // 角速度：dq = q * q_prev^-1，w = 2 * dq.xyz / h
+        glm::quat dq = rotations[i] * glm::inverse(previousRotations[i]);
+        glm::vec3 w = glm::vec3(dq.x, dq.y, dq.z) * (2.0f * invH);
+        angularVelocities[i] = (dq.w >= 0.0f) ? w : -w;
+    }
+}
 
-    glm::mat4x4 I_rot = R * obj->getIRef() * glm::transpose(R);
-    glm::mat4x4 I_inverse = glm::inverse(I_rot);
-    glm::vec3 r_collision = sum / (float)collisionNum;
-    glm::vec3 Rr_collision = glm::mat3(R) * r_collision;
-    glm::vec3 v_collision = obj->getLinearVelocity() + glm::cross(obj->getAngularVelocity(), Rr_collision);
-
-    float restitution = 0.5f;
-    float friction = 0.2f;
-    glm::vec3 v_N = glm::dot(v_collision, N) * N;
-    glm::vec3 v_T = v_collision - v_N;
-    glm::vec3 v_N_new = -restitution * v_N;
-    float v_T_len = glm::length(v_T);
-    float v_N_len = glm::length(v_N);
-    float a = glm::max(1.0f - friction * (1.0f + restitution) * v_N_len / v_T_len, 0.0f);
-    std::cout << "a is " << a << ", v_N_len: " << v_N_len << ", v_T_len: " << v_T_len << std::endl;
-    glm::vec3 v_T_new = a * v_T;
-    glm::vec3 v_new = v_N_new + v_T_new;
-
-    glm::mat4x4 Rri_star = get_Cross_Matrix(Rr_collision);
-    glm::mat4x4 identity_matrix(1.0f);
-    glm::mat4x4 K = Matrix_Subtraction(Matrix_Multiply_Float(identity_matrix, 1.0f / obj->getMass()), Rri_star * I_inverse * Rri_star);
-    std::cout << "K matrix: " << K[0][0] << " " << K[1][1] << " " << K[2][2] << std::endl;
-    glm::vec3 J = glm::mat3(glm::inverse(K)) * (v_new - v_collision);
-    std::cout << " J is " << J.x << " " << J.y << " " << J.z << std::endl;
-
-    obj->setLinearVelocity(obj->getLinearVelocity() + 1.0f / obj->getMass() * J);
-    obj->setAngularVelocity(obj->getAngularVelocity() + glm::mat3(I_inverse) * glm::cross(Rr_collision, J));
-
-    // 静止检测
-    glm::vec3 v = obj->getLinearVelocity();
-    if (glm::length(v) < 0.02f)
-    {
-        obj->setLinearVelocity(glm::vec3(0.0f));
-        obj->setAngularVelocity(glm::vec3(0.0f));
-        std::cout << "Object stopped due to low velocity" << std::endl;
-    }
-}
\ No newline at end of file
+void XPBDSystem::solveVelocities(float h)
+{
+    XPBD_PROFILE_ZONE("solveVelocities");
+    auto solve = [h](Constraint* constraint)
+    {
+        if (!isConstraintAsleep(constraint)) constraint->solveVelocity(h);
+    };
+    if (solverMode == SolverMode::Jacobi)
+    {
+        // 反弹和摩擦不做超松弛，避免放大反弹速度
+        solveJacobi(solve, [this](uint32_t i, const BodyDelta& delta)
+        {
+            bodies.linearVelocities[i] += delta.linear;
+            bodies.angularVelocities[i] += delta.angular;
+        });
+        return;
+    }
+    solveColored(constraintGraph, solve);
+    solveColored(contactGraph, solve);
+}
@@ -2,28 +2,186 @@
 #define XPBD_H
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <memory>
 #include <vector>
+#include "core/thread_pool.h"
 #include "physics/entity.h"
+#include "physics/body_store.h"
+#include "physics/constraint.h"
+#include "physics/constraint_graph.h"
+#include "physics/simulation_islands.h"
+#include "physics/broad_phase.h"
 #include "physics/collision_broad_phase.h"
+#include "physics/sweep_and_prune_broad_phase.h"
+#include "physics/spatial_hash_grid.h"
 #include "physics/collision_narrow_phase.h"
 
+// 约束求解方式
+// GaussSeidel：按着色逐颜色求解，每个约束立即看到前面约束的结果，收敛快
+// Jacobi：所有约束基于同一快照计算修正量，按刚体累加（质量分裂）后统一施加，无需着色，完全数据并行
+enum class SolverMode
+{
+    GaussSeidel,
+    Jacobi
+};
+
+// 宽相实现，按场景特点选择
+// AABBTree：动态 AABB 树，适合尺寸差异大、分布不均匀的场景
+// SweepAndPrune：单轴扫掠剪枝，适合大量尺寸相近、整体连贯运动的刚体（传送带、堆积）
+// SpatialHash：均匀网格空间哈希，每步并行重建，适合大量同尺寸的小刚体（颗粒）
+enum class BroadPhaseType
+{
+    AABBTree,
+    SweepAndPrune,
+    SpatialHash
+};
+
 class XPBDSystem
 {
     public:
         XPBDSystem();
         void addObject(Entity* entity);
+        // 添加/移除用户约束（如 DistanceConstraint），约束对象由调用者管理
+        void addConstraint(Constraint* constraint);
+        void removeConstraint(Constraint* constraint);
+        // 推进一个时间步：预测位置 -> 多个子步的约束投影 -> 由位置差分出速度
         void run();
+        // 按墙钟时间推进：累积 elapsedSeconds，以固定的 timeStep 运行所需的步数并返回步数
+        // 单帧最多运行 maxStepsPerFrame 步，超出的时间被丢弃，防止慢帧导致步数越积越多
+        int step(float elapsedSeconds);
         void initialize();
-        void applyImpulse(Entity* obj1, Entity* obj2, glm::vec3 N);
-        void applyImpulseWithGround(Entity* obj, glm::vec3 P, glm::vec3 N);
         const std::vector<Entity*>& getObjects() const { return objects; }
+        const BodyStore& getBodies() const { return bodies; }
+        const std::vector<CollisionConstraint>& getContacts() const { return contactConstraints; }
+        // 上个时间步中因缓存的间隙足够大而跳过窄相的碰撞对数（仅 AABBTree 宽相保存碰撞对缓存）
+        size_t getSkippedNarrowPhaseCount() const { return skippedNarrowPhaseCount; }
+
+        int getMaxStepsPerFrame() const { return maxStepsPerFrame; }
+        void setMaxStepsPerFrame(int count) { maxStepsPerFrame = (count > 0) ? count : 1; }
+        // 累积的剩余时间占一个时间步的比例 [0, 1)，渲染时在上一步与当前步的状态之间插值
+        float getInterpolationAlpha() const { return accumulator / timeStep; }
+        glm::vec3 getInterpolatedPosition(const Entity* entity) const;
+        glm::quat getInterpolatedRotation(const Entity* entity) const;
+
+        // 求解器参数（每个 XPBDSystem 独立配置）
+        float getTimeStep() const { return timeStep; }
+        void setTimeStep(float dt) { timeStep = dt; }
+        // 沿 y 轴的重力加速度，默认 -9.81；接触的反弹速度阈值随其大小变化
+        float getGravity() const { return gravity; }
+        void setGravity(float g) { gravity = g; }
+        int getSubstepCount() const { return substepCount; }
+        void setSubstepCount(int count) { substepCount = (count > 0) ? count : 1; }
+        int getIterationCount() const { return iterationCount; }
+        void setIterationCount(int count) { iterationCount = (count > 0) ? count : 1; }
+        float getContactMargin() const { return contactMargin; }
+        void setContactMargin(float margin) { contactMargin = margin; }
+        BroadPhaseType getBroadPhaseType() const { return broadPhaseType; }
+        // 切换实现时用已加入的所有实体重建新的宽相
+        void setBroadPhaseType(BroadPhaseType type);
+        SolverMode getSolverMode() const { return solverMode; }
+        void setSolverMode(SolverMode mode) { solverMode = mode; }
+        // Jacobi 模式位置修正的超松弛系数，通常取 1 ~ 2
+        float getRelaxation() const { return relaxation; }
+        void setRelaxation(float omega) { relaxation = omega; }
+        // 休眠：岛内所有刚体的线速度、角速度持续 timeToSleep 秒低于阈值后整个岛进入休眠
+        bool isSleepEnabled() const { return sleepEnabled; }
+        void setSleepEnabled(bool enabled);
+        void setSleepThresholds(float linear, float angular) { sleepLinearThreshold = linear; sleepAngularThreshold = angular; }
+        float getTimeToSleep() const { return timeToSleep; }
+        void setTimeToSleep(float seconds) { timeToSleep = seconds; }
+        const SimulationIslands& getIslands() const { return islands; }
+        const ConstraintGraph& getConstraintGraph() const { return constraintGraph; }
+        // 约束投影使用的线程数（含调用线程），0 表示取硬件线程数
+        // 默认使用进程内共用的 ThreadPool::shared()；setThreadCount 改为本系统独占的线程池
+        size_t getThreadCount() const { return threadPool->getThreadCount(); }
+        void setThreadCount(size_t count);
+        // 使用调用者管理的线程池（生命周期须长于本系统），nullptr 表示恢复共用线程池
+        ThreadPool* getThreadPool() const { return threadPool; }
+        void setThreadPool(ThreadPool* pool);
 
     private:
-        std::vector<Entity*> objects;
+        std::vector<Entity*> objects;   // 实体句柄，下标与 bodies 一致
+        BodyStore bodies;               // 所有刚体状态的结构化数组存储
         float gravity;
         float timeStep;
-        CollisionBroadPhase broadPhase;
+        float accumulator;              // step() 中尚未模拟的墙钟时间
+        int maxStepsPerFrame;           // step() 单次调用最多运行的时间步数
+        int substepCount;               // 每个时间步的子步数
+        int iterationCount;             // 每个子步的约束迭代次数
+        float contactMargin;            // 距离小于该值的顶点也生成（尚未生效的）接触约束
+        SolverMode solverMode;
+        float relaxation;               // Jacobi 模式的超松弛系数
+        bool sleepEnabled;
+        float sleepLinearThreshold;     // 线速度阈值 (m/s)
+        float sleepAngularThreshold;    // 角速度阈值 (rad/s)
+        float timeToSleep;              // 低于阈值持续多久后休眠 (s)
+        SimulationIslands islands;      // 本时间步活动刚体的仿真岛，以及保存下来的休眠岛
+        BroadPhaseType broadPhaseType;
+        std::unique_ptr<BroadPhase> broadPhase;
         CollisionNarrowPhase narrowPhase;
+
+        std::vector<Constraint*> constraints;                // 用户约束
+        std::vector<Constraint*> pendingConstraints;         // 已添加但尚未着色的用户约束
+        std::vector<CollisionConstraint> contactConstraints; // 每个时间步重新生成的接触约束
+        std::vector<std::pair<Entity*, Entity*>> potentialCollisions; // 宽相输出，跨时间步复用容量
+        size_t skippedNarrowPhaseCount;
+        ConstraintGraph constraintGraph;                     // 用户约束的着色，随增删增量更新
+        uint32_t coloredStaticVersion;                       // 着色时的 BodyStore::staticVersion
+        ConstraintGraph contactGraph;                        // 接触约束的着色，每个时间步重建
+        ThreadPool* threadPool;
+        std::unique_ptr<ThreadPool> ownedThreadPool;         // setThreadCount 创建的独占线程池
+
+        // Jacobi 模式的数据：每个约束在 jacobiDeltas 中占 entities.size() 个连续槽位，
+        // bodySlotOffsets/bodySlots 按刚体列出它的所有槽位（CSR），用于并行汇总
+        std::vector<Constraint*> jacobiConstraints;
+        std::vector<BodyDelta> jacobiDeltas;
+        std::vector<uint32_t> bodyConstraintCounts;
+        std::vector<uint32_t> bodySlotOffsets;
+        std::vector<uint32_t> bodySlots;
+        std::vector<glm::vec3> previousPositions;            // 子步开始时的位置
+        std::vector<glm::quat> previousRotations;            // 子步开始时的朝向
+        std::vector<glm::vec3> stepStartPositions;           // step() 中最后一个时间步开始时的位置，用于插值
+        std::vector<glm::quat> stepStartRotations;
+
+        void collectContacts();
+        // 开启连续碰撞检测的刚体在首次触地时刻的位形上收集接触顶点
+        void addGroundContact(Entity* obj, Entity* ground);
+        // cache 为宽相保存的该碰撞对数据，可为 nullptr
+        void addBodyContact(Entity* obj1, Entity* obj2, PairCacheData* cache);
+        // 在两实体位于 pos1、pos2 的位形上添加接触约束
+        void emplaceBodyContact(Entity* obj1, const glm::vec3& pos1, Entity* obj2, const glm::vec3& pos2,
+            const glm::vec3& normal, float penetration);
+        // 连续碰撞检测：相对位移足够大时沿本时间步的运动路径保守前进求碰撞时间，在碰撞时刻的位形上生成接触
+        // 返回 false 表示运动较慢，由离散检测处理
+        bool addContinuousContact(Entity* obj1, Entity* obj2);
+        // 相对位移超过较小包围球半径的该比例时才做连续碰撞检测
+        static constexpr float CCDMotionRatio = 0.5f;
+        static constexpr int MaxCCDIterations = 32;
+        glm::vec3 predictPosition(const Entity* obj) const;
+
+        // 按接触和约束构建仿真岛，唤醒与活动刚体相连的休眠刚体
+        void buildIslands();
+        // 时间步结束时更新休眠计时，让静止足够久的岛进入休眠
+        void updateSleeping();
+        // 约束涉及的刚体都处于休眠或静态时跳过求解
+        static bool isConstraintAsleep(const Constraint* constraint);
+
+        // 按颜色依次求解，同一颜色内的约束在线程池上并行执行
+        template <typename Solve>
+        void solveColored(const ConstraintGraph& graph, const Solve& solve);
+
+        // Jacobi 模式：为本时间步的约束分配槽位并建立刚体到槽位的索引；结束后解除约束的输出
+        void prepareJacobi();
+        void releaseJacobi();
+        // 并行计算所有约束的修正量，再按刚体汇总后调用 apply(bodyIndex, 汇总修正量)
+        template <typename Solve, typename Apply>
+        void solveJacobi(const Solve& solve, const Apply& apply);
+
+        void integrate(float h);
+        void solvePositions(float h);
+        void updateVelocities(float h);
+        void solveVelocities(float h);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,62 @@
+#include "render/gl_mesh.h"
+#include <iostream>
+
+GLMesh::GLMesh(const Mesh& mesh) : VAO(0), VBO(0), EBO(0), indexCount(mesh.getIndexCount())
+{
+    // 构建 vertexData（位置 + 法线交错存放）
+    const std::vector<glm::vec3>& positions = mesh.getPositions();
+    const std::vector<glm::vec3>& normals = mesh.getNormals();
+    const std::vector<unsigned int>& indices = mesh.getIndices();
+    std::vector<GLfloat> vertexData;
+    vertexData.reserve(positions.size() * 6);
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        glm::vec3 normal = (i < normals.size()) ? normals[i] : glm::vec3(0.0f, 1.0f, 0.0f);
+        vertexData.push_back(positions[i].x);
+        vertexData.push_back(positions[i].y);
+        vertexData.push_back(positions[i].z);
+        vertexData.push_back(normal.x);
+        vertexData.push_back(normal.y);
+        vertexData.push_back(normal.z);
+    }
+
+    // 生成新的资源
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    if (VAO == 0 || VBO == 0 || EBO == 0) {
+        std::cerr << "Failed to generate OpenGL resources: VAO=" << VAO 
+                  << ", VBO=" << VBO << ", EBO=" << EBO << std::endl;
+        return;
+    }
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(GLfloat),
+                 vertexData.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint),
+                 indices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    std::cout << "Initialized GLMesh with VAO: " << VAO 
+              << ", VBO: " << VBO << ", EBO: " << EBO << std::endl;
+}
+
+GLMesh::~GLMesh()
+{
+    if (VAO != 0) glDeleteVertexArrays(1, &VAO);
+    if (VBO != 0) glDeleteBuffers(1, &VBO);
+    if (EBO != 0) glDeleteBuffers(1, &EBO);
+}
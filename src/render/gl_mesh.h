@@ -0,0 +1,27 @@
+#ifndef GL_MESH_H
+#define GL_MESH_H
+
+#include <GL/glew.h>
+#include <vector>
+#include "geometry/mesh.h"
+
+// Mesh 的 GPU 端副本：持有 VAO/VBO/EBO，需要在有效的 OpenGL 上下文中创建
+class GLMesh
+{
+    public:
+        explicit GLMesh(const Mesh& mesh);
+        ~GLMesh();
+
+        // 禁止拷贝（OpenGL 资源不可共享所有权）
+        GLMesh(const GLMesh&) = delete;
+        GLMesh& operator=(const GLMesh&) = delete;
+
+        GLuint getVAO() const { return VAO; }
+        int getIndexCount() const { return indexCount; }
+
+    private:
+        GLuint VAO, VBO, EBO;             // OpenGL 资源
+        int indexCount;                   // 索引数量
+};
+
+#endif
@@ -58,6 +58,10 @@ MeshRenderer::~MeshRenderer()
     {
         glDeleteProgram(shaderProgram);
     }
+    for (auto& entry : glMeshes)
+    {
+        delete entry.second;
+    }
 }
 
 void MeshRenderer::initialize()
@@ -65,6 +69,18 @@ void MeshRenderer::initialize()
     shaderProgram = createShaderProgram();
 }
 
+GLMesh* MeshRenderer::getGLMesh(const Mesh* mesh)
+{
+    auto it = glMeshes.find(mesh);
+    if (it != glMeshes.end())
+    {
+        return it->second;
+    }
+    GLMesh* glMesh = new GLMesh(*mesh);
+    glMeshes[mesh] = glMesh;
+    return glMesh;
+}
+
 void MeshRenderer::render(Mesh* mesh, const glm::mat4& mvp, const glm::vec3& lightPos, 
                           const glm::vec3& viewPos, const glm::vec3& objectPos, const glm::quat& rotation) 
 {
@@ -89,8 +105,9 @@ void MeshRenderer::render(Mesh* mesh, const glm::mat4& mvp, const glm::vec3& lig
     glUniform3fv(glGetUniformLocation(shaderProgram, "objectColor"), 1, glm::value_ptr(objectColor));
     glUniform3fv(glGetUniformLocation(shaderProgram, "lightColor"), 1, glm::value_ptr(lightColor));
 
-    glBindVertexArray(mesh->getVAO());
-    glDrawElements(GL_TRIANGLES, mesh->getIndexCount(), GL_UNSIGNED_INT, 0);
+    GLMesh* glMesh = getGLMesh(mesh);
+    glBindVertexArray(glMesh->getVAO());
+    glDrawElements(GL_TRIANGLES, glMesh->getIndexCount(), GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 }
 
@@ -4,7 +4,10 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
-#include "mesh.h"
+#include <glm/gtc/quaternion.hpp>
+#include <unordered_map>
+#include "geometry/mesh.h"
+#include "render/gl_mesh.h"
 
 class MeshRenderer 
 {
@@ -18,6 +21,9 @@ public:
 
 private:
     GLuint shaderProgram;
+    std::unordered_map<const Mesh*, GLMesh*> glMeshes; // 每个 Mesh 首次渲染时上传到 GPU
+
+    GLMesh* getGLMesh(const Mesh* mesh);
 
     GLuint compileShader(GLenum type, const char* source);
     GLuint createShaderProgram();
@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include "physics/collision_broad_phase.h"
+#include "physics/sweep_and_prune_broad_phase.h"
+#include "physics/spatial_hash_grid.h"
+#include "core/thread_pool.h"
 #include "physics/entity.h"
-#include "render/sphere_mesh.h"
+#include "geometry/sphere_mesh.h"
+#include "geometry/cube_mesh.h"
 
 // 测试夹具类，用于设置通用测试环境
 class CollisionBroadPhaseTest : public ::testing::Test {
@@ -9,9 +16,7 @@ protected:
     void SetUp() override {
         // 初始化测试所需的资源
         sphereMesh1 = new SphereMesh(0.1f, 20, 20);
-        sphereMesh1->initialize();
         sphereMesh2 = new SphereMesh(0.1f, 20, 20);
-        sphereMesh2->initialize();
 
         entity1 = new Entity(sphereMesh1, glm::vec3(0.0f, 0.0f, 0.0f), 1.0f);
         entity2 = new Entity(sphereMesh2, glm::vec3(0.2f, 0.0f, 0.0f), 1.0f);
@@ -76,6 +81,521 @@ TEST_F(CollisionBroadPhaseTest, NoCollisionForSeparatedEntities) {
     EXPECT_EQ(pairs.size(), 0); // 不应检测到碰撞对
 }
 
+// 测试4：按顺序插入一排刚体时树保持平衡，碰撞对与暴力枚举一致
+TEST_F(CollisionBroadPhaseTest, SAHTreeStaysBalancedAndMatchesBruteForce) {
+    const int count = 1024;
+    std::vector<std::unique_ptr<Entity>> entities;
+    for (int i = 0; i < count; ++i) {
+        // 间距 0.15 小于直径，相邻两球重叠；每 32 个换一行
+        glm::vec3 position(0.15f * (i % 32), 0.5f * (i / 32), 0.0f);
+        entities.emplace_back(new Entity(sphereMesh1, position, 1.0f));
+        broadPhase->addObject(entities.back().get());
+    }
+    broadPhase->update();
+
+    // 完全平衡时高度为 10，允许 SAH 有一定的偏斜
+    EXPECT_LE(broadPhase->getTreeHeight(), 20);
+
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    broadPhase->collectCollisionPairs(pairs);
+
+    auto bruteForceCount = [&]() {
+        std::vector<AABB> boxes;
+        for (const auto& entity : entities) boxes.push_back(broadPhase->computeAABB(entity.get()));
+        size_t expected = 0;
+        for (int i = 0; i < count; ++i) {
+            const AABB& a = boxes[i];
+            for (int j = i + 1; j < count; ++j) {
+                const AABB& b = boxes[j];
+                if (a.min.x <= b.max.x && a.max.x >= b.min.x &&
+                    a.min.y <= b.max.y && a.max.y >= b.min.y &&
+                    a.min.z <= b.max.z && a.max.z >= b.min.z) {
+                    ++expected;
+                }
+            }
+        }
+        return expected;
+    };
+    EXPECT_EQ(pairs.size(), bruteForceCount());
+
+    // 少量刚体移动时走逐个查询的增量路径，结果应与暴力枚举一致
+    for (int i = 0; i < 16; ++i) {
+        Entity* entity = entities[i * 61].get();
+        entity->setPosition(entity->getPosition() + glm::vec3(0.07f, 0.3f, 0.0f));
+    }
+    broadPhase->update();
+    broadPhase->collectCollisionPairs(pairs);
+    EXPECT_EQ(pairs.size(), bruteForceCount());
+}
+
+// 测试5：胖包围盒内的小位移不触发重新插入，越界后只重新插入移动的叶节点且碰撞对随之更新
+TEST_F(CollisionBroadPhaseTest, FatAABBReinsertsOnlyEscapedLeaves) {
+    entity2->setPosition(glm::vec3(0.5f, 0.0f, 0.0f));
+    broadPhase->addObject(entity1);
+    broadPhase->addObject(entity2);
+    broadPhase->update();
+    EXPECT_EQ(broadPhase->getMovedCount(), 0u);
+
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    broadPhase->collectCollisionPairs(pairs);
+    EXPECT_EQ(pairs.size(), 0u);
+
+    // 小于胖包围盒余量的位移
+    entity1->setPosition(glm::vec3(0.5f * broadPhase->getFatMargin(), 0.0f, 0.0f));
+    broadPhase->update();
+    EXPECT_EQ(broadPhase->getMovedCount(), 0u);
+
+    // 移到与 entity2 重叠的位置
+    entity1->setPosition(glm::vec3(0.35f, 0.0f, 0.0f));
+    broadPhase->update();
+    EXPECT_EQ(broadPhase->getMovedCount(), 1u);
+    broadPhase->collectCollisionPairs(pairs);
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0].first, entity1);
+    EXPECT_EQ(pairs[0].second, entity2);
+
+    // 再移开后碰撞对消失
+    entity1->setPosition(glm::vec3(-0.5f, 0.0f, 0.0f));
+    broadPhase->update();
+    broadPhase->collectCollisionPairs(pairs);
+    EXPECT_EQ(pairs.size(), 0u);
+}
+
+// 测试6：碰撞对集合依次报告 Begin、Persist、End
+TEST_F(CollisionBroadPhaseTest, PairSetReportsBeginPersistEnd) {
+    broadPhase->addObject(entity1);
+    broadPhase->addObject(entity2);
+    broadPhase->update();
+
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    broadPhase->collectCollisionPairs(pairs);
+    ASSERT_EQ(broadPhase->getPairEvents().size(), 1u);
+    EXPECT_EQ(broadPhase->getPairEvents()[0].type, PairEventType::Begin);
+    uint64_t key = broadPhase->getPairEvents()[0].key;
+
+    broadPhase->update();
+    broadPhase->collectCollisionPairs(pairs);
+    ASSERT_EQ(broadPhase->getPairEvents().size(), 1u);
+    EXPECT_EQ(broadPhase->getPairEvents()[0].type, PairEventType::Persist);
+    EXPECT_EQ(broadPhase->getPairEvents()[0].key, key);
+
+    entity2->setPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+    broadPhase->update();
+    broadPhase->collectCollisionPairs(pairs);
+    EXPECT_TRUE(pairs.empty());
+    ASSERT_EQ(broadPhase->getPairEvents().size(), 1u);
+    EXPECT_EQ(broadPhase->getPairEvents()[0].type, PairEventType::End);
+    EXPECT_EQ(broadPhase->getPairEvents()[0].entityA, entity1);
+    EXPECT_EQ(broadPhase->getPairEvents()[0].entityB, entity2);
+
+    broadPhase->update();
+    broadPhase->collectCollisionPairs(pairs);
+    EXPECT_TRUE(broadPhase->getPairEvents().empty());
+}
+
+// 测试7：扫掠剪枝与 AABB 树输出相同的碰撞对，刚体移动后也一致
+TEST_F(CollisionBroadPhaseTest, SweepAndPruneMatchesTree) {
+    SweepAndPruneBroadPhase sweepAndPrune;
+    std::vector<std::unique_ptr<Entity>> entities;
+    for (int i = 0; i < 300; ++i) {
+        // 沿 z 轴分布最广，扫掠轴应切换到 z
+        glm::vec3 position(0.15f * (i % 5), 0.15f * ((i / 5) % 3), 0.12f * (i / 15));
+        entities.emplace_back(new Entity(sphereMesh1, position, 1.0f));
+        broadPhase->addObject(entities.back().get());
+        sweepAndPrune.addObject(entities.back().get());
+    }
+
+    auto expectSamePairs = [&]() {
+        std::vector<std::pair<Entity*, Entity*>> treePairs;
+        std::vector<std::pair<Entity*, Entity*>> sapPairs;
+        broadPhase->collectCollisionPairs(treePairs);
+        sweepAndPrune.collectCollisionPairs(sapPairs);
+        std::sort(treePairs.begin(), treePairs.end());
+        std::sort(sapPairs.begin(), sapPairs.end());
+        EXPECT_FALSE(sapPairs.empty());
+        EXPECT_EQ(treePairs, sapPairs);
+    };
+
+    broadPhase->update();
+    sweepAndPrune.update();
+    EXPECT_EQ(sweepAndPrune.getSortAxis(), 2);
+    expectSamePairs();
+
+    for (int i = 0; i < 300; i += 7) {
+        Entity* entity = entities[i].get();
+        entity->setPosition(entity->getPosition() + glm::vec3(0.05f, 0.0f, 0.2f));
+    }
+    broadPhase->update();
+    sweepAndPrune.update();
+    EXPECT_GT(sweepAndPrune.getSwapCount(), 0u);
+    expectSamePairs();
+}
+
+// 测试8：空间哈希网格与 AABB 树输出相同的碰撞对，包括不放入网格的大实体
+TEST_F(CollisionBroadPhaseTest, SpatialHashGridMatchesTree) {
+    SpatialHashGrid grid;
+    std::vector<std::unique_ptr<Entity>> entities;
+    for (int i = 0; i < 300; ++i) {
+        glm::vec3 position(0.15f * (i % 5), 0.15f * ((i / 5) % 3), 0.12f * (i / 15));
+        entities.emplace_back(new Entity(sphereMesh1, position, 1.0f));
+    }
+    // 远大于单元尺寸的实体不进入网格，单独检查
+    std::unique_ptr<SphereMesh> largeMesh(new SphereMesh(2.0f, 8, 8));
+    entities.emplace_back(new Entity(largeMesh.get(), glm::vec3(0.3f, -1.9f, 1.0f), 0.0f));
+    for (auto& entity : entities) {
+        broadPhase->addObject(entity.get());
+        grid.addObject(entity.get());
+    }
+
+    std::vector<std::pair<Entity*, Entity*>> treePairs;
+    std::vector<std::pair<Entity*, Entity*>> gridPairs;
+    broadPhase->update();
+    grid.update();
+    broadPhase->collectCollisionPairs(treePairs);
+    grid.collectCollisionPairs(gridPairs);
+    std::sort(treePairs.begin(), treePairs.end());
+    std::sort(gridPairs.begin(), gridPairs.end());
+    EXPECT_FALSE(gridPairs.empty());
+    EXPECT_EQ(treePairs, gridPairs);
+}
+
+// 测试9：粒子邻居对和半径查询与暴力枚举一致
+TEST_F(CollisionBroadPhaseTest, SpatialHashNeighbourPairsMatchBruteForce) {
+    // 伪随机粒子，部分坐标为负，覆盖跨越原点的单元
+    std::vector<glm::vec3> positions;
+    uint32_t seed = 12345u;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+    for (int i = 0; i < 2000; ++i) {
+        positions.emplace_back(next() * 2.0f - 1.0f, next() * 2.0f - 1.0f, next() * 2.0f - 1.0f);
+    }
+
+    const float radius = 0.08f;
+    std::vector<std::pair<uint32_t, uint32_t>> expected;
+    for (uint32_t i = 0; i < positions.size(); ++i) {
+        for (uint32_t j = i + 1; j < positions.size(); ++j) {
+            glm::vec3 d = positions[i] - positions[j];
+            if (glm::dot(d, d) <= radius * radius) expected.emplace_back(i, j);
+        }
+    }
+
+    // 多线程构建的结果应与串行一致且有序
+    ThreadPool pool(4);
+    SpatialHashGrid grid;
+    grid.setThreadPool(&pool);
+    grid.build(positions, radius);
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    grid.collectNeighbourPairs(radius, pairs);
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(pairs, expected);
+
+    std::vector<uint32_t> neighbours;
+    grid.queryNeighbours(positions[0], 0.3f, neighbours);
+    std::vector<uint32_t> expectedNeighbours;
+    for (uint32_t i = 0; i < positions.size(); ++i) {
+        glm::vec3 d = positions[i] - positions[0];
+        if (glm::dot(d, d) <= 0.3f * 0.3f) expectedNeighbours.push_back(i);
+    }
+    EXPECT_EQ(neighbours, expectedNeighbours);
+}
+
+// 测试10：网格缓存局部包围体，旋转后的世界包围盒由局部包围盒直接得到
+TEST_F(CollisionBroadPhaseTest, ComputeAABBUsesCachedLocalBounds) {
+    EXPECT_NEAR(sphereMesh1->getBoundingSphereRadius(), 0.1f, 0.001f);
+    EXPECT_NEAR(glm::length(sphereMesh1->getBoundingSphereCenter()), 0.0f, 0.001f);
+
+    CubeMesh cube(2.0f, 1.0f, 1.0f);
+    EXPECT_NEAR(cube.getLocalBoundsMin().x, -1.0f, 1e-6f);
+    EXPECT_NEAR(cube.getLocalBoundsMax().z, 0.5f, 1e-6f);
+
+    // 绕 y 轴旋转 90 度后 x、z 方向的尺寸互换
+    Entity box(&cube, glm::vec3(1.0f, 2.0f, 3.0f), 1.0f);
+    box.setRotation(glm::angleAxis(1.5707963f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    AABB aabb = BroadPhase::computeAABB(&box);
+    EXPECT_NEAR(aabb.min.x, 0.5f, 1e-4f);
+    EXPECT_NEAR(aabb.max.x, 1.5f, 1e-4f);
+    EXPECT_NEAR(aabb.min.y, 1.5f, 1e-4f);
+    EXPECT_NEAR(aabb.max.y, 2.5f, 1e-4f);
+    EXPECT_NEAR(aabb.min.z, 2.0f, 1e-4f);
+    EXPECT_NEAR(aabb.max.z, 4.0f, 1e-4f);
+}
+
+// 测试11：批量加载时在线程池上并行按分箱 SAH 建树，碰撞对与暴力枚举一致；手动重建不改变碰撞对
+TEST_F(CollisionBroadPhaseTest, BulkBuildMatchesBruteForce) {
+    const int count = 5000;
+    ThreadPool pool(4);
+    broadPhase->setThreadPool(&pool);
+    std::vector<std::unique_ptr<Entity>> entities;
+    for (int i = 0; i < count; ++i) {
+        glm::vec3 position(0.15f * (i % 20), 0.15f * ((i / 20) % 25), 0.3f * (i / 500));
+        entities.emplace_back(new Entity(sphereMesh1, position, 1.0f));
+        broadPhase->addObject(entities.back().get());
+    }
+    broadPhase->update();
+    // 完全平衡时高度为 13
+    EXPECT_LE(broadPhase->getTreeHeight(), 26);
+
+    std::vector<AABB> boxes;
+    for (const auto& entity : entities) boxes.push_back(BroadPhase::computeAABB(entity.get()));
+    std::vector<std::pair<Entity*, Entity*>> expected;
+    for (int i = 0; i < count; ++i) {
+        for (int j = i + 1; j < count; ++j) {
+            if (BroadPhase::checkAABBCollision(boxes[i], boxes[j])) {
+                expected.emplace_back(entities[i].get(), entities[j].get());
+            }
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    broadPhase->collectCollisionPairs(pairs);
+    std::sort(pairs.begin(), pairs.end());
+    EXPECT_EQ(pairs, expected);
+
+    broadPhase->rebuild();
+    broadPhase->update();
+    broadPhase->collectCollisionPairs(pairs);
+    std::sort(pairs.begin(), pairs.end());
+    EXPECT_EQ(pairs, expected);
+}
+
+// 测试12：静态实体放在静态树中，不生成静态-静态碰撞对，update 不移动它们
+TEST_F(CollisionBroadPhaseTest, StaticTreeSkipsStaticPairs) {
+    Entity ground1(sphereMesh1, glm::vec3(0.0f, -0.1f, 0.0f), 0.0f);
+    Entity ground2(sphereMesh1, glm::vec3(0.1f, -0.1f, 0.0f), 0.0f);
+    Entity fixedBody(sphereMesh1, glm::vec3(-0.1f, -0.1f, 0.0f), 1.0f);
+    fixedBody.setFixed(true);
+    broadPhase->addObject(&ground1);
+    broadPhase->addObject(&ground2);
+    broadPhase->addObject(&fixedBody);
+    broadPhase->addObject(entity1);
+    broadPhase->update();
+    EXPECT_EQ(broadPhase->getStaticCount(), 3u);
+
+    // entity1 与三个静态实体都重叠，静态实体之间的重叠不输出
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    broadPhase->collectCollisionPairs(pairs);
+    std::vector<std::pair<Entity*, Entity*>> expected = {
+        { &ground1, entity1 }, { &ground2, entity1 }, { &fixedBody, entity1 }
+    };
+    std::sort(pairs.begin(), pairs.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(pairs, expected);
+
+    // 动态实体离开后只剩静态实体，不输出任何碰撞对，静态实体也不被重新插入
+    entity1->setPosition(glm::vec3(0.0f, 2.0f, 0.0f));
+    broadPhase->update();
+    EXPECT_EQ(broadPhase->getMovedCount(), 1u);
+    broadPhase->collectCollisionPairs(pairs);
+    EXPECT_TRUE(pairs.empty());
+
+    // 静态实体被移动后需要显式刷新
+    ground1.setPosition(glm::vec3(0.0f, 1.9f, 0.0f));
+    broadPhase->updateStatics();
+    broadPhase->collectCollisionPairs(pairs);
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0], std::make_pair(&ground1, entity1));
+}
+
+// 测试13：射线检测返回最近命中和按距离排序的全部命中，命中点落在网格表面上
+TEST_F(CollisionBroadPhaseTest, RayCastClosestAndAll) {
+    Entity ground(sphereMesh1, glm::vec3(0.6f, 0.0f, 0.0f), 0.0f);
+    broadPhase->addObject(entity1);
+    broadPhase->addObject(entity2);
+    broadPhase->addObject(&ground);
+    broadPhase->update();
+
+    RayCastHit hit;
+    ASSERT_TRUE(broadPhase->rayCastClosest(glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(2.0f, 0.0f, 0.0f), 10.0f, hit));
+    EXPECT_EQ(hit.entity, entity1);
+    EXPECT_NEAR(hit.distance, 0.9f, 0.01f);
+    EXPECT_NEAR(hit.point.x, -0.1f, 0.01f);
+    EXPECT_GT(glm::dot(hit.normal, glm::vec3(-1.0f, 0.0f, 0.0f)), 0.9f);
+
+    // 反方向射来时先命中静态树中的实体
+    ASSERT_TRUE(broadPhase->rayCastClosest(glm::vec3(2.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), 10.0f, hit));
+    EXPECT_EQ(hit.entity, &ground);
+    EXPECT_NEAR(hit.distance, 1.3f, 0.01f);
+
+    std::vector<RayCastHit> hits;
+    broadPhase->rayCastAll(glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 10.0f, hits);
+    ASSERT_EQ(hits.size(), 3u);
+    EXPECT_EQ(hits[0].entity, entity1);
+    EXPECT_EQ(hits[1].entity, entity2);
+    EXPECT_EQ(hits[2].entity, &ground);
+    EXPECT_LT(hits[0].distance, hits[1].distance);
+    EXPECT_LT(hits[1].distance, hits[2].distance);
+
+    // 最大距离不够、射线偏离、方向为 0 时都不命中
+    EXPECT_FALSE(broadPhase->rayCastClosest(glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 0.5f, hit));
+    EXPECT_FALSE(broadPhase->rayCastClosest(glm::vec3(-1.0f, 0.5f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 10.0f, hit));
+    EXPECT_FALSE(broadPhase->rayCastClosest(glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f), 10.0f, hit));
+    EXPECT_EQ(hit.entity, nullptr);
+}
+
+// 测试14：包围盒和球的重叠查询按实体的当前位姿精确筛选
+TEST_F(CollisionBroadPhaseTest, OverlapAABBAndSphere) {
+    broadPhase->addObject(entity1);
+    broadPhase->addObject(entity2);
+    broadPhase->update();
+
+    std::vector<Entity*> entities;
+    broadPhase->overlapSphere(glm::vec3(0.35f, 0.0f, 0.0f), 0.1f, entities);
+    EXPECT_EQ(entities, std::vector<Entity*>{ entity2 });
+
+    // 球完全在网格内部也算相交
+    broadPhase->overlapSphere(glm::vec3(0.0f), 0.01f, entities);
+    EXPECT_EQ(entities, std::vector<Entity*>{ entity1 });
+
+    // 包围盒角落与球面之间有空隙，但包围盒与包围盒相交
+    broadPhase->overlapSphere(glm::vec3(0.09f, 0.09f, 0.09f) + glm::vec3(0.02f), 0.02f, entities);
+    EXPECT_TRUE(entities.empty());
+
+    AABB box;
+    box.min = glm::vec3(0.25f, -0.01f, -0.01f);
+    box.max = glm::vec3(0.4f, 0.01f, 0.01f);
+    broadPhase->overlapAABB(box, entities);
+    EXPECT_EQ(entities, std::vector<Entity*>{ entity2 });
+
+    box.min = glm::vec3(-1.0f);
+    box.max = glm::vec3(1.0f);
+    broadPhase->overlapAABB(box, entities);
+    std::sort(entities.begin(), entities.end());
+    std::vector<Entity*> expected = { entity1, entity2 };
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(entities, expected);
+}
+
+// 测试15：在线程池上批量检测的结果与逐条检测一致
+TEST_F(CollisionBroadPhaseTest, RayCastBatchMatchesSingleRays) {
+    ThreadPool pool(4);
+    broadPhase->setThreadPool(&pool);
+    std::vector<std::unique_ptr<Entity>> entities;
+    for (int i = 0; i < 400; ++i) {
+        glm::vec3 position(0.25f * (i % 10), 0.25f * ((i / 10) % 10), 0.25f * (i / 100));
+        entities.emplace_back(new Entity(sphereMesh1, position, i % 4 == 0 ? 0.0f : 1.0f));
+        broadPhase->addObject(entities.back().get());
+    }
+    broadPhase->update();
+
+    std::vector<RayCastQuery> rays;
+    for (int i = 0; i < 2000; ++i) {
+        RayCastQuery ray;
+        ray.origin = glm::vec3(-1.0f, 0.0013f * i, 0.0011f * (i % 700));
+        ray.direction = glm::vec3(1.0f, 0.3f * std::sin(0.01f * i), 0.2f * std::cos(0.013f * i));
+        ray.maxDistance = 2.0f + 0.002f * i;
+        rays.push_back(ray);
+    }
+    std::vector<RayCastHit> hits;
+    broadPhase->rayCastClosestBatch(rays, hits);
+    ASSERT_EQ(hits.size(), rays.size());
+
+    size_t hitCount = 0;
+    for (size_t i = 0; i < rays.size(); ++i) {
+        RayCastHit single;
+        bool found = broadPhase->rayCastClosest(rays[i].origin, rays[i].direction, rays[i].maxDistance, single);
+        ASSERT_EQ(hits[i].entity != nullptr, found) << "ray " << i;
+        if (!found) continue;
+        ++hitCount;
+        EXPECT_EQ(hits[i].entity, single.entity) << "ray " << i;
+        EXPECT_FLOAT_EQ(hits[i].distance, single.distance) << "ray " << i;
+    }
+    EXPECT_GT(hitCount, rays.size() / 2);
+}
+
+// 测试16：增量只含 Begin 和 End，碰撞对缓存数据在存续期间保留，槽位被移动后事件中的 slot 随之更新
+TEST_F(CollisionBroadPhaseTest, PairCacheKeepsDataAndReportsDeltas) {
+    Entity entity3(sphereMesh1, glm::vec3(-0.15f, 0.0f, 0.0f), 1.0f);
+    broadPhase->addObject(entity1);
+    broadPhase->addObject(entity2);
+    broadPhase->update();
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    broadPhase->collectCollisionPairs(pairs);
+    ASSERT_EQ(broadPhase->getAddedPairs().size(), 1u);
+    EXPECT_TRUE(broadPhase->getRemovedPairs().empty());
+    uint32_t slot = broadPhase->getAddedPairs()[0].slot;
+    EXPECT_EQ(broadPhase->getPairData(slot).separation, 0.0f);
+    broadPhase->getPairData(slot).featureA = 12;
+
+    broadPhase->addObject(&entity3);
+    broadPhase->update();
+    broadPhase->collectCollisionPairs(pairs);
+    ASSERT_EQ(broadPhase->getAddedPairs().size(), 1u);
+    EXPECT_EQ(broadPhase->getAddedPairs()[0].entityB, &entity3);
+    broadPhase->getPairData(broadPhase->getAddedPairs()[0].slot).featureA = 13;
+    ASSERT_EQ(broadPhase->getPairEvents().size(), 2u);
+    for (const PairEvent& event : broadPhase->getPairEvents()) {
+        EXPECT_EQ(event.type, event.entityB == &entity3 ? PairEventType::Begin : PairEventType::Persist);
+        EXPECT_EQ(broadPhase->getPairData(event.slot).featureA, event.entityB == &entity3 ? 13u : 12u);
+    }
+
+    // (entity1, entity2) 结束，它的槽位被 (entity1, entity3) 填补
+    entity2->setPosition(glm::vec3(2.0f, 0.0f, 0.0f));
+    broadPhase->update();
+    broadPhase->collectCollisionPairs(pairs);
+    EXPECT_TRUE(broadPhase->getAddedPairs().empty());
+    ASSERT_EQ(broadPhase->getRemovedPairs().size(), 1u);
+    EXPECT_EQ(broadPhase->getRemovedPairs()[0].entityB, entity2);
+    EXPECT_EQ(broadPhase->getPairCount(), 1u);
+    const PairEvent& persisted = broadPhase->getPairEvents()[0];
+    EXPECT_EQ(persisted.type, PairEventType::Persist);
+    EXPECT_EQ(persisted.slot, 0u);
+    EXPECT_EQ(broadPhase->getPairData(persisted.slot).featureA, 13u);
+}
+
+// 测试17：锐角棱外侧的球心不会被当成内部，内外判断与窄相的伪法线一致
+TEST_F(CollisionBroadPhaseTest, OverlapSphereOutsideSharpEdge) {
+    // 截面为尖角约 14° 的三角形的楔形棱柱，厚度 0.1，不带顶点法线
+    // 左下方另有一块小棱柱，使尖角外侧落在网格的包围盒内，网格整体不是凸的
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    auto addPrism = [&](const glm::vec2 (&outline)[3]) {
+        const unsigned int base = static_cast<unsigned int>(positions.size());
+        for (int layer = 0; layer < 2; ++layer)
+            for (const glm::vec2& corner : outline)
+                positions.emplace_back(corner.x, corner.y, 0.1f * layer);
+        indices.insert(indices.end(), { base, base + 2, base + 1, base + 3, base + 4, base + 5 });
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            unsigned int j = (i + 1) % 3;
+            indices.insert(indices.end(), { base + i, base + j, base + j + 3 });
+            indices.insert(indices.end(), { base + i, base + j + 3, base + i + 3 });
+        }
+    };
+    const glm::vec2 wedgeOutline[3] = { glm::vec2(0.0f, 0.0f), glm::vec2(0.2f, 0.0f), glm::vec2(0.2f, 0.05f) };
+    const glm::vec2 blockOutline[3] = { glm::vec2(-0.1f, -0.1f), glm::vec2(-0.08f, -0.1f), glm::vec2(-0.08f, -0.08f) };
+    addPrism(wedgeOutline);
+    addPrism(blockOutline);
+    Mesh wedgeMesh(positions, {}, indices);
+    Entity wedge(&wedgeMesh, glm::vec3(0.0f), 0.0f);
+    broadPhase->addObject(&wedge);
+    broadPhase->update();
+
+    struct Probe { glm::vec3 center; bool inside; };
+    const Probe probes[] = {
+        { glm::vec3(0.15f, 0.02f, 0.05f), true },
+        { glm::vec3(0.05f, 0.005f, 0.05f), true },
+        // 尖角棱外侧，最近点落在棱上，两侧面的法线夹角超过 90°
+        { glm::vec3(-0.02f, 0.003f, 0.05f), false },
+        { glm::vec3(-0.005f, -0.02f, 0.05f), false },
+        { glm::vec3(-0.01f, 0.0f, 0.05f), false },
+    };
+    std::vector<Entity*> entities;
+    for (const Probe& probe : probes)
+    {
+        // 半径远小于球心到表面的距离，结果只取决于内外判断
+        broadPhase->overlapSphere(probe.center, 0.001f, entities);
+        EXPECT_EQ(entities.size(), probe.inside ? 1u : 0u)
+            << probe.center.x << ", " << probe.center.y << ", " << probe.center.z;
+    }
+
+    // 半径够到尖角棱的球仍然相交
+    broadPhase->overlapSphere(glm::vec3(-0.02f, 0.003f, 0.05f), 0.021f, entities);
+    EXPECT_EQ(entities, std::vector<Entity*>{ &wedge });
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
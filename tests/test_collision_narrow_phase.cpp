@@ -0,0 +1,356 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "physics/collider.h"
+#include "physics/gjk.h"
+#include "physics/collision_narrow_phase.h"
+#include "physics/entity.h"
+#include "geometry/sphere_mesh.h"
+#include "geometry/cube_mesh.h"
+#include "geometry/signed_distance_grid.h"
+
+// 测试夹具类：半径 0.1 的球碰撞体和边长 0.2 的立方体凸包碰撞体
+class CollisionNarrowPhaseTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sphere = new Collider(0.1f);
+        const float h = 0.1f;
+        std::vector<glm::vec3> vertices = {
+            { -h, -h, -h }, { h, -h, -h }, { h, h, -h }, { -h, h, -h },
+            { -h, -h, h }, { h, -h, h }, { h, h, h }, { -h, h, h }
+        };
+        std::vector<std::vector<unsigned int>> faces = {
+            { 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 },
+            { 2, 3, 7, 6 }, { 1, 2, 6, 5 }, { 0, 4, 7, 3 }
+        };
+        box = new Collider(vertices, faces);
+    }
+
+    void TearDown() override {
+        delete sphere;
+        delete box;
+    }
+
+    ConvexShape shape(const Collider* collider, const glm::vec3& position,
+                      const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f)) {
+        return ConvexShape{ collider, position, rotation };
+    }
+
+    Collider* sphere;
+    Collider* box;
+};
+
+// 测试1：两球分离和浅穿透时由核心距离减去半径得到精确结果
+TEST_F(CollisionNarrowPhaseTest, SphereSphereDistanceAndPenetration) {
+    ConvexContact contact;
+    EXPECT_FALSE(computeConvexContact(shape(sphere, glm::vec3(0.0f)), shape(sphere, glm::vec3(0.3f, 0.0f, 0.0f)), contact));
+    EXPECT_NEAR(contact.separation, 0.1f, 1e-5f);
+    EXPECT_NEAR(contact.normal.x, 1.0f, 1e-5f);
+    EXPECT_NEAR(contact.pointA.x, 0.1f, 1e-5f);
+    EXPECT_NEAR(contact.pointB.x, 0.2f, 1e-5f);
+
+    EXPECT_TRUE(computeConvexContact(shape(sphere, glm::vec3(0.0f)), shape(sphere, glm::vec3(0.0f, 0.15f, 0.0f)), contact));
+    EXPECT_NEAR(contact.separation, -0.05f, 1e-5f);
+    EXPECT_NEAR(contact.normal.y, 1.0f, 1e-5f);
+    EXPECT_LE(contact.supportCount, 4);
+}
+
+// 测试2：凸包之间的距离，以及核心相交时 EPA 给出的穿透深度和法线
+TEST_F(CollisionNarrowPhaseTest, BoxBoxDistanceAndEPA) {
+    ConvexContact contact;
+    EXPECT_FALSE(computeConvexContact(shape(box, glm::vec3(0.0f)), shape(box, glm::vec3(0.0f, 0.0f, 0.25f)), contact));
+    EXPECT_NEAR(contact.separation, 0.05f, 1e-5f);
+    EXPECT_NEAR(contact.normal.z, 1.0f, 1e-5f);
+
+    // 绕 y 轴转 45 度后角到对面的距离为 0.4 - 0.1 * sqrt(2) - 0.1
+    glm::quat rotated = glm::angleAxis(0.25f * 3.14159265f, glm::vec3(0.0f, 1.0f, 0.0f));
+    EXPECT_FALSE(computeConvexContact(shape(box, glm::vec3(0.0f), rotated), shape(box, glm::vec3(0.4f, 0.0f, 0.0f)), contact));
+    EXPECT_NEAR(contact.separation, 0.3f - 0.1f * std::sqrt(2.0f), 1e-4f);
+
+    EXPECT_TRUE(computeConvexContact(shape(box, glm::vec3(0.0f)), shape(box, glm::vec3(0.15f, 0.02f, -0.01f)), contact));
+    EXPECT_NEAR(contact.separation, -0.05f, 1e-4f);
+    EXPECT_NEAR(contact.normal.x, 1.0f, 1e-4f);
+    EXPECT_NEAR(contact.pointA.x - contact.pointB.x, 0.05f, 1e-4f);
+}
+
+// 测试3：球与立方体，球心进入立方体后由 EPA 求穿透深度
+TEST_F(CollisionNarrowPhaseTest, SphereBoxShallowAndDeep) {
+    ConvexContact contact;
+    EXPECT_FALSE(computeConvexContact(shape(box, glm::vec3(0.0f)), shape(sphere, glm::vec3(0.25f, 0.0f, 0.0f)), contact));
+    EXPECT_NEAR(contact.separation, 0.05f, 1e-5f);
+
+    EXPECT_TRUE(computeConvexContact(shape(box, glm::vec3(0.0f)), shape(sphere, glm::vec3(0.15f, 0.0f, 0.0f)), contact));
+    EXPECT_NEAR(contact.separation, -0.05f, 1e-5f);
+
+    EXPECT_TRUE(computeConvexContact(shape(box, glm::vec3(0.0f)), shape(sphere, glm::vec3(0.0f, -0.05f, 0.0f)), contact));
+    EXPECT_NEAR(contact.separation, -0.15f, 1e-4f);
+    EXPECT_NEAR(contact.normal.y, -1.0f, 1e-3f);
+
+    // 两球心重合时没有明确的法线，穿透深度仍为两半径之和
+    EXPECT_TRUE(computeConvexContact(shape(sphere, glm::vec3(0.0f)), shape(sphere, glm::vec3(0.0f)), contact));
+    EXPECT_NEAR(contact.separation, -0.2f, 1e-3f);
+}
+
+// 测试4：布尔 GJK 与距离 GJK 的结论一致，返回的分离轴确实分开两个形状，沿轴的间隙不超过真实距离
+TEST_F(CollisionNarrowPhaseTest, IntersectMatchesDistance) {
+    for (int i = 0; i < 200; ++i) {
+        glm::vec3 offset(0.35f * std::sin(0.7f * i), 0.3f * std::cos(1.3f * i), 0.25f * std::sin(2.1f * i + 1.0f));
+        glm::quat rotation = glm::angleAxis(0.05f * i, glm::normalize(glm::vec3(1.0f, 0.5f * std::sin(0.3f * i), 0.2f)));
+        ConvexShape a = shape(box, glm::vec3(0.0f), rotation);
+        ConvexShape b = shape(i % 2 ? sphere : box, offset);
+
+        ConvexContact contact;
+        bool overlap = computeConvexContact(a, b, contact);
+        glm::vec3 axis(0.0f);
+        float bound = 0.0f;
+        bool intersect = gjkIntersect(a, b, axis, &bound);
+        if (std::fabs(contact.separation) < 1e-4f) continue;
+        EXPECT_EQ(intersect, overlap) << "case " << i;
+        if (!intersect) {
+            EXPECT_LT(glm::dot(a.support(axis), axis), glm::dot(b.support(-axis), axis) + 1e-5f) << "case " << i;
+            EXPECT_GT(bound, 0.0f) << "case " << i;
+            EXPECT_LE(bound, contact.separation + 1e-5f) << "case " << i;
+        }
+    }
+}
+
+// 测试5：两个实体都挂上碰撞体时窄相改用 GJK/EPA
+TEST_F(CollisionNarrowPhaseTest, NarrowPhaseUsesAttachedColliders) {
+    SphereMesh mesh(0.1f, 20, 20);
+    Entity entityA(&mesh, glm::vec3(0.0f), 1.0f);
+    Entity entityB(&mesh, glm::vec3(0.25f, 0.0f, 0.0f), 1.0f);
+    entityA.setCollider(box);
+    entityB.setCollider(sphere);
+
+    CollisionNarrowPhase narrowPhase;
+    float penetration = 0.0f;
+    float separation = 0.0f;
+    glm::vec3 normal(0.0f);
+    EXPECT_FALSE(narrowPhase.detectCollision(&entityA, entityA.getPosition(), &entityB, entityB.getPosition(),
+                                             penetration, normal, separation));
+    EXPECT_NEAR(separation, 0.05f, 1e-5f);
+
+    EXPECT_TRUE(narrowPhase.detectCollision(&entityA, entityA.getPosition(), &entityB, glm::vec3(0.0f, 0.18f, 0.0f),
+                                            penetration, normal, separation));
+    EXPECT_NEAR(penetration, 0.02f, 1e-5f);
+    EXPECT_NEAR(normal.y, 1.0f, 1e-5f);
+}
+
+// 测试6：有面信息的大凸包爬山得到的支撑点与线性扫描一致，沿用上次下标时结果不变
+TEST_F(CollisionNarrowPhaseTest, HillClimbMatchesLinearScan) {
+    SphereMesh mesh(0.1f, 40, 40);
+    const std::vector<unsigned int>& indices = mesh.getIndices();
+    std::vector<std::vector<unsigned int>> faces;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        faces.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+    }
+    Collider hull(mesh.getPositions(), faces);
+    Collider scan(mesh.getPositions(), std::vector<std::vector<unsigned int>>());
+    ASSERT_GE(hull.convexHull.vertices.size(), Collider::HillClimbMinVertices);
+    ASSERT_FALSE(hull.convexHull.adjacency.empty());
+
+    unsigned int coherentHint = 0;
+    for (int i = 0; i < 500; ++i) {
+        glm::vec3 direction(std::sin(0.37f * i), std::cos(1.11f * i), std::sin(0.53f * i + 0.2f));
+        float expected = glm::dot(scan.getSupportPoint(direction), direction);
+
+        unsigned int hint = static_cast<unsigned int>(i * 7919) % hull.convexHull.vertices.size();
+        EXPECT_NEAR(glm::dot(hull.getSupportPoint(direction, hint), direction), expected, 1e-6f) << "case " << i;
+        EXPECT_NEAR(glm::dot(hull.convexHull.vertices[hint], direction), expected, 1e-6f) << "case " << i;
+
+        // 方向缓慢转动，模拟帧间的时间相关性
+        glm::vec3 slow(std::cos(0.01f * i), std::sin(0.01f * i), 0.3f);
+        float slowExpected = glm::dot(scan.getSupportPoint(slow), slow);
+        EXPECT_NEAR(glm::dot(hull.getSupportPoint(slow, coherentHint), slow), slowExpected, 1e-6f) << "case " << i;
+    }
+
+    // 越界的下标退回从第 0 个顶点开始
+    unsigned int invalid = 1u << 30;
+    glm::vec3 up(0.0f, 0.0f, 1.0f);
+    EXPECT_NEAR(hull.getSupportPoint(up, invalid).z, 0.1f, 1e-6f);
+    EXPECT_LT(invalid, hull.convexHull.vertices.size());
+}
+
+// 测试7：窄相通过调用者保存的下标跨帧复用支撑顶点，结果与不带下标时一致
+TEST_F(CollisionNarrowPhaseTest, SupportHintsPersistAcrossQueries) {
+    SphereMesh mesh(0.1f, 24, 24);
+    const std::vector<unsigned int>& indices = mesh.getIndices();
+    std::vector<std::vector<unsigned int>> faces;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        faces.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+    }
+    Collider hull(mesh.getPositions(), faces);
+    Entity entityA(&mesh, glm::vec3(0.0f), 1.0f);
+    Entity entityB(&mesh, glm::vec3(0.25f, 0.0f, 0.0f), 1.0f);
+    entityA.setCollider(&hull);
+    entityB.setCollider(&hull);
+
+    CollisionNarrowPhase narrowPhase;
+    unsigned int hintA = 0;
+    unsigned int hintB = 0;
+    for (int i = 0; i < 20; ++i) {
+        glm::vec3 posB(0.25f * std::cos(0.05f * i), 0.25f * std::sin(0.05f * i), 0.0f);
+        float penetration = 0.0f, separation = 0.0f;
+        float expectedPenetration = 0.0f, expectedSeparation = 0.0f;
+        glm::vec3 normal(0.0f), expectedNormal(0.0f);
+        bool hinted = narrowPhase.detectCollision(&entityA, entityA.getPosition(), &entityB, posB,
+                                                  penetration, normal, separation, &hintA, &hintB);
+        bool plain = narrowPhase.detectCollision(&entityA, entityA.getPosition(), &entityB, posB,
+                                                 expectedPenetration, expectedNormal, expectedSeparation);
+        EXPECT_EQ(hinted, plain);
+        EXPECT_NEAR(separation, expectedSeparation, 1e-5f) << "frame " << i;
+        // A 的支撑顶点朝向 B，B 的支撑顶点朝向 A
+        EXPECT_GT(glm::dot(hull.convexHull.vertices[hintA], posB), 0.0f) << "frame " << i;
+        EXPECT_LT(glm::dot(hull.convexHull.vertices[hintB], posB), 0.0f) << "frame " << i;
+    }
+}
+
+// 测试8：球网格的距离场与解析距离一致，梯度沿径向；网格外的点逐个三角形求精确距离
+TEST_F(CollisionNarrowPhaseTest, SignedDistanceGridMatchesSphere) {
+    SphereMesh mesh(0.1f, 32, 32);
+    const std::shared_ptr<const SignedDistanceGrid> grid = mesh.getSignedDistanceGrid();
+    ASSERT_FALSE(grid->empty());
+    EXPECT_EQ(grid, mesh.getSignedDistanceGrid());
+
+    for (int i = 0; i < 200; ++i) {
+        glm::vec3 direction = glm::normalize(glm::vec3(std::sin(0.37f * i), std::cos(1.11f * i), std::sin(0.53f * i + 0.2f)));
+        float radius = 0.04f + 0.16f * (i % 20) / 19.0f;
+        glm::vec3 point = direction * radius;
+        glm::vec3 gradient(0.0f);
+        float distance = grid->sample(point, &gradient);
+        // 多边形近似球面的误差约为 r * (1 - cos(pi / 32))，再加上插值误差
+        EXPECT_NEAR(distance, radius - 0.1f, 2e-3f) << "case " << i;
+        EXPECT_GT(glm::dot(glm::normalize(gradient), direction), 0.95f) << "case " << i;
+
+        glm::vec3 far = direction * 0.5f;
+        EXPECT_NEAR(grid->sample(far, &gradient), 0.4f, 2e-3f) << "case " << i;
+        EXPECT_GT(glm::dot(glm::normalize(gradient), direction), 0.95f) << "case " << i;
+    }
+}
+
+// 测试9：立方体内部、外部、棱和角附近的符号正确，网格节点上的距离是精确值
+TEST_F(CollisionNarrowPhaseTest, SignedDistanceGridSignsNearFeatures) {
+    CubeMesh mesh(0.2f, 0.2f, 0.2f);
+    const std::shared_ptr<const SignedDistanceGrid> grid = mesh.getSignedDistanceGrid();
+    ASSERT_FALSE(grid->empty());
+    const float h = grid->getCellSize();
+
+    EXPECT_NEAR(grid->sample(glm::vec3(0.0f)), -0.1f, 1e-5f);
+    EXPECT_NEAR(grid->sample(glm::vec3(0.15f, 0.0f, 0.0f)), 0.05f, 1e-5f);
+    EXPECT_NEAR(grid->sample(glm::vec3(0.0f, -0.09f, 0.0f)), -0.01f, 1e-5f);
+    // 棱外和角外的最近特征分别是边和顶点
+    EXPECT_NEAR(grid->sample(glm::vec3(0.15f, 0.15f, 0.0f)), 0.05f * std::sqrt(2.0f), h);
+    EXPECT_NEAR(grid->sample(glm::vec3(0.15f, 0.15f, 0.15f)), 0.05f * std::sqrt(3.0f), h);
+    EXPECT_LT(grid->sample(glm::vec3(0.095f, 0.095f, 0.095f)), 0.0f);
+    EXPECT_GT(grid->sample(glm::vec3(0.105f, 0.105f, 0.105f)), 0.0f);
+
+    // 网格外直接求到三角形的精确距离，最近特征是棱
+    glm::vec3 gradient(0.0f);
+    EXPECT_NEAR(grid->sample(glm::vec3(1.0f, 0.3f, 0.0f), &gradient), glm::length(glm::vec3(0.9f, 0.2f, 0.0f)), 1e-5f);
+    EXPECT_GT(glm::dot(gradient, glm::normalize(glm::vec3(0.9f, 0.2f, 0.0f))), 0.9999f);
+}
+
+// 测试10：三角形绕序整体朝内的网格与朝外的网格得到相同的距离场
+TEST_F(CollisionNarrowPhaseTest, SignedDistanceGridIgnoresWindingOrientation) {
+    SphereMesh outward(0.1f, 16, 16);
+    std::vector<unsigned int> flipped = outward.getIndices();
+    for (size_t i = 0; i + 2 < flipped.size(); i += 3) std::swap(flipped[i + 1], flipped[i + 2]);
+    Mesh inward(outward.getPositions(), outward.getNormals(), flipped);
+
+    for (int i = 0; i < 50; ++i) {
+        glm::vec3 point(0.2f * std::sin(0.7f * i), 0.15f * std::cos(1.3f * i), 0.12f * std::sin(2.1f * i + 1.0f));
+        EXPECT_NEAR(inward.getSignedDistanceGrid()->sample(point), outward.getSignedDistanceGrid()->sample(point), 1e-6f)
+            << "case " << i;
+    }
+}
+
+// 测试11：没有碰撞体时窄相在网格距离场上求间隙，结果与解析球一致
+TEST_F(CollisionNarrowPhaseTest, SDFNarrowPhaseUsesBakedGrid) {
+    SphereMesh meshA(0.1f, 32, 32);
+    SphereMesh meshB(0.05f, 32, 32);
+    Entity entityA(&meshA, glm::vec3(0.0f), 1.0f);
+    Entity entityB(&meshB, glm::vec3(0.2f, 0.0f, 0.0f), 1.0f);
+
+    CollisionNarrowPhase narrowPhase;
+    float penetration = 0.0f;
+    float separation = 0.0f;
+    glm::vec3 normal(0.0f);
+    EXPECT_FALSE(narrowPhase.detectCollision(&entityA, entityA.getPosition(), &entityB, entityB.getPosition(),
+                                             penetration, normal, separation));
+    EXPECT_NEAR(separation, 0.05f, 3e-3f);
+
+    EXPECT_TRUE(narrowPhase.detectCollision(&entityA, entityA.getPosition(), &entityB, glm::vec3(0.0f, 0.13f, 0.0f),
+                                            penetration, normal, separation));
+    EXPECT_NEAR(penetration, 0.02f, 3e-3f);
+    // B 的中心离 A 的表面更近（更深入 A），法线由 B 指向 A；法线取多边形球面的梯度，与径向相差不超过一个面片的夹角
+    EXPECT_NEAR(normal.y, -1.0f, 1e-2f);
+}
+
+// 测试12：小球偏离中心压在大立方体顶面上，大物体中心落在小球网格外时穿透深度仍然精确，法线取表面梯度而不是中心连线
+TEST_F(CollisionNarrowPhaseTest, SDFSmallBodyOnLargeMesh) {
+    CubeMesh meshA(1.0f, 1.0f, 1.0f);
+    SphereMesh meshB(0.05f, 32, 32);
+    Entity entityA(&meshA, glm::vec3(0.0f), 0.0f);
+    Entity entityB(&meshB, glm::vec3(0.3f, 0.52f, 0.0f), 1.0f);
+
+    CollisionNarrowPhase narrowPhase;
+    float penetration = 0.0f;
+    float separation = 0.0f;
+    glm::vec3 normal(0.0f);
+    EXPECT_TRUE(narrowPhase.detectCollision(&entityA, entityA.getPosition(), &entityB, entityB.getPosition(),
+                                            penetration, normal, separation));
+    EXPECT_NEAR(penetration, 0.03f, 2e-3f);
+    EXPECT_NEAR(normal.y, -1.0f, 1e-3f);
+    EXPECT_NEAR(normal.x, 0.0f, 1e-3f);
+}
+
+// 测试13：窄相沿调用者保存的分离轴先做布尔 GJK，分离时给出真实距离的下界，相交时结果与不带分离轴时一致
+TEST_F(CollisionNarrowPhaseTest, CachedSeparatingAxisRejectsEarly) {
+    CubeMesh mesh(0.2f, 0.2f, 0.2f);
+    Entity entityA(&mesh, glm::vec3(0.0f), 1.0f);
+    Entity entityB(&mesh, glm::vec3(0.0f), 1.0f);
+    entityA.setCollider(box);
+    entityB.setCollider(box);
+
+    CollisionNarrowPhase narrowPhase;
+    glm::vec3 axis(0.0f);
+    for (int i = 0; i < 40; ++i) {
+        // B 沿 x 轴从远处靠近并穿入 A，再略微绕着 A 转动
+        glm::vec3 posB(0.4f - 0.006f * i, 0.02f * std::sin(0.3f * i), 0.0f);
+        float penetration = 0.0f, separation = 0.0f;
+        float expectedPenetration = 0.0f, expectedSeparation = 0.0f;
+        glm::vec3 normal(0.0f), expectedNormal(0.0f);
+        bool cached = narrowPhase.detectCollision(&entityA, entityA.getPosition(), &entityB, posB,
+                                                  penetration, normal, separation, nullptr, nullptr, &axis);
+        bool plain = narrowPhase.detectCollision(&entityA, entityA.getPosition(), &entityB, posB,
+                                                 expectedPenetration, expectedNormal, expectedSeparation);
+        EXPECT_EQ(cached, plain) << "frame " << i;
+        EXPECT_NEAR(glm::length(axis), 1.0f, 1e-5f) << "frame " << i;
+        EXPECT_GT(axis.x, 0.0f) << "frame " << i;
+        if (cached) {
+            EXPECT_NEAR(penetration, expectedPenetration, 1e-5f) << "frame " << i;
+            EXPECT_NEAR(glm::dot(normal, expectedNormal), 1.0f, 1e-5f) << "frame " << i;
+        } else {
+            EXPECT_GT(separation, 0.0f) << "frame " << i;
+            EXPECT_LE(separation, expectedSeparation + 1e-5f) << "frame " << i;
+        }
+    }
+}
+
+// 测试14：网格几何变化后距离场重新烘焙，此前取得的距离场在持有期间仍然有效
+TEST_F(CollisionNarrowPhaseTest, SignedDistanceGridOutlivesReshape) {
+    struct ScalableCube : CubeMesh {
+        void scale(float factor) {
+            for (glm::vec3& position : positions) position *= factor;
+            computeBounds();
+        }
+    };
+    ScalableCube mesh;
+    std::shared_ptr<const SignedDistanceGrid> before = mesh.getSignedDistanceGrid();
+    mesh.scale(2.0f);
+    std::shared_ptr<const SignedDistanceGrid> after = mesh.getSignedDistanceGrid();
+    EXPECT_NE(before, after);
+    EXPECT_NEAR(before->sample(glm::vec3(0.0f)), -0.1f, 1e-5f);
+    EXPECT_NEAR(after->sample(glm::vec3(0.0f)), -0.2f, 1e-5f);
+}
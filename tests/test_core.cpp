@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "core/ring_buffer.h"
+#include "core/log.h"
+#include "core/profiler.h"
+#include "core/thread_pool.h"
+
+// 测试1：环形队列先进先出，满时 tryPush 返回 false
+TEST(RingBufferTest, FifoAndFullQueue) {
+    RingBuffer<int> queue(4);
+    EXPECT_EQ(queue.capacity(), 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+    EXPECT_FALSE(queue.tryPush(4));
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+// 测试2：多个生产者并发写入，不丢失也不重复
+TEST(RingBufferTest, ConcurrentProducers) {
+    RingBuffer<int> queue(4096);
+    const int producers = 4;
+    const int perProducer = 1000;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < perProducer; ++i) {
+                while (!queue.tryPush(p * perProducer + i)) {}
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    std::vector<int> seen(producers * perProducer, 0);
+    int value = 0;
+    while (queue.tryPop(value)) seen[value]++;
+    for (int count : seen) EXPECT_EQ(count, 1);
+}
+
+// 测试3：日志按级别过滤，flush 后写入输出
+TEST(LoggerTest, FiltersByLevelAndFlushes) {
+#if XPBD_LOGGING_ENABLED
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+    Logger& logger = Logger::instance();
+    logger.setOutput(file);
+    logger.setLevel(LogLevel::Info);
+
+    XPBD_LOG_DEBUG(Solver, "hidden %d", 1);
+    XPBD_LOG_INFO(Solver, "visible %d", 2);
+    logger.flush();
+
+    rewind(file);
+    char buffer[512] = {};
+    size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+    buffer[length] = '\0';
+    EXPECT_EQ(strstr(buffer, "hidden"), nullptr);
+    EXPECT_NE(strstr(buffer, "visible 2"), nullptr);
+
+    logger.setOutput(stdout);
+    fclose(file);
+#else
+    GTEST_SKIP() << "logging is compiled out";
+#endif
+}
+
+// 测试4：开启时记录嵌套 zone 并导出 trace_event JSON，关闭时不记录
+TEST(ProfilerTest, RecordsZonesAndExportsChromeTrace) {
+#if XPBD_PROFILING_ENABLED
+    Profiler& profiler = Profiler::instance();
+    profiler.clear();
+
+    profiler.setEnabled(false);
+    {
+        XPBD_PROFILE_ZONE("disabled");
+    }
+    EXPECT_EQ(profiler.getZoneCount(), 0u);
+
+    profiler.setEnabled(true);
+    {
+        XPBD_PROFILE_ZONE("outer");
+        XPBD_PROFILE_ZONE("inner");
+    }
+    std::thread worker([] { XPBD_PROFILE_ZONE("worker"); });
+    worker.join();
+    profiler.setEnabled(false);
+    EXPECT_EQ(profiler.getZoneCount(), 3u);
+
+    std::ostringstream out;
+    profiler.exportChromeTrace(out);
+    std::string json = out.str();
+    EXPECT_EQ(json.find("{\"traceEvents\":["), 0u);
+    EXPECT_NE(json.find("\"name\":\"outer\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"worker\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+    profiler.clear();
+#else
+    GTEST_SKIP() << "profiling is compiled out";
+#endif
+}
+
+// 测试5：多个线程同时向同一个线程池提交 parallelFor，各自的结果完整且互不干扰
+TEST(ThreadPoolTest, SharedPoolSerializesConcurrentCallers) {
+    ThreadPool pool(4, 100);
+    EXPECT_EQ(pool.getThreadCount(), 4u);
+    EXPECT_EQ(pool.getSpinCount(), 100);
+    EXPECT_EQ(&ThreadPool::shared(), &ThreadPool::shared());
+
+    const int callers = 3;
+    const size_t count = 10000;
+    std::vector<std::vector<int>> hits(callers, std::vector<int>(count, 0));
+    std::vector<std::thread> threads;
+    for (int c = 0; c < callers; ++c) {
+        threads.emplace_back([&, c] {
+            for (int round = 0; round < 20; ++round) {
+                pool.parallelFor(count, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) hits[c][i]++;
+                });
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    for (const std::vector<int>& caller : hits) {
+        for (int value : caller) EXPECT_EQ(value, 20);
+    }
+}
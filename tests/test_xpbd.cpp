@@ -0,0 +1,445 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "physics/xpbd.h"
+#include "physics/entity.h"
+#include "geometry/sphere_mesh.h"
+#include "geometry/cube_mesh.h"
+
+// 测试夹具类：一个半径 0.1 的球和一块顶面在 y = -0.075 的地面
+class XPBDSystemTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sphereMesh = new SphereMesh(0.1f, 20, 20);
+        groundMesh = new CubeMesh(2.0f, 2.0f, 0.05f);
+
+        sphere = new Entity(sphereMesh, glm::vec3(0.0f, 0.5f, 0.0f), 1.0f);
+        ground = new Entity(groundMesh, glm::vec3(0.0f, -0.1f, 0.0f), 0.0f);
+
+        system = new XPBDSystem();
+    }
+
+    void TearDown() override {
+        delete system;
+        delete sphere;
+        delete ground;
+        delete sphereMesh;
+        delete groundMesh;
+    }
+
+    SphereMesh* sphereMesh;
+    CubeMesh* groundMesh;
+    Entity* sphere;
+    Entity* ground;
+    XPBDSystem* system;
+};
+
+// 测试1：下落的球最终静止在地面上，不穿透也不弹飞
+TEST_F(XPBDSystemTest, SphereComesToRestOnGround) {
+    system->addObject(sphere);
+    system->addObject(ground);
+    system->initialize();
+
+    for (int i = 0; i < 600; ++i) {
+        system->run();
+    }
+
+    EXPECT_NEAR(sphere->getPosition().y, 0.025f, 0.01f); // 地面顶面 -0.075 + 半径 0.1
+    EXPECT_NEAR(glm::length(sphere->getLinearVelocity()), 0.0f, 0.05f);
+}
+
+// 测试2：距离约束把两个自由物体拉回到目标距离
+TEST_F(XPBDSystemTest, DistanceConstraintKeepsRestLength) {
+    Entity other(sphereMesh, glm::vec3(0.5f, 0.5f, 0.0f), 1.0f);
+    system->addObject(sphere);
+    system->addObject(&other);
+    system->initialize();
+
+    DistanceConstraint constraint(sphere, &other, 0.3f, 1e9f);
+    system->addConstraint(&constraint);
+    for (int i = 0; i < 10; ++i) {
+        system->run();
+    }
+
+    float distance = glm::length(sphere->getPosition() - other.getPosition());
+    EXPECT_NEAR(distance, 0.3f, 0.01f);
+}
+
+// 测试3：子步数和迭代次数至少为 1
+TEST_F(XPBDSystemTest, SolverSettingsAreClamped) {
+    system->setSubstepCount(0);
+    system->setIterationCount(-3);
+    EXPECT_EQ(system->getSubstepCount(), 1);
+    EXPECT_EQ(system->getIterationCount(), 1);
+
+    system->setSubstepCount(8);
+    EXPECT_EQ(system->getSubstepCount(), 8);
+}
+
+// 测试4：着色后同一颜色内的约束不共享动态刚体，删除约束后颜色被释放
+TEST_F(XPBDSystemTest, ConstraintGraphColorsDoNotShareBodies) {
+    std::vector<Entity*> chain;
+    for (int i = 0; i < 6; ++i) {
+        chain.push_back(new Entity(sphereMesh, glm::vec3(0.3f * i, 0.5f, 0.0f), 1.0f));
+        system->addObject(chain.back());
+    }
+    system->addObject(ground);
+
+    // 链式约束，外加一个连接静态地面的约束
+    std::vector<DistanceConstraint*> links;
+    for (int i = 0; i + 1 < 6; ++i) {
+        links.push_back(new DistanceConstraint(chain[i], chain[i + 1], 0.3f));
+    }
+    links.push_back(new DistanceConstraint(chain[0], ground, 0.6f));
+
+    ConstraintGraph graph;
+    for (DistanceConstraint* link : links) graph.addConstraint(link);
+    EXPECT_EQ(graph.getConstraintCount(), links.size());
+    EXPECT_EQ(graph.getColorCount(), 2); // 链式约束两种颜色交替，地面是静态的，只与 chain[0] 的约束冲突
+
+    for (int color = 0; color < graph.getColorCount(); ++color) {
+        std::vector<uint32_t> bodies;
+        for (Constraint* constraint : graph.getColor(color)) {
+            for (Entity* entity : constraint->getEntities()) {
+                if (entity->getInverseMass() == 0.0f) continue;
+                EXPECT_EQ(std::count(bodies.begin(), bodies.end(), entity->getBodyIndex()), 0);
+                bodies.push_back(entity->getBodyIndex());
+            }
+        }
+    }
+
+    // 删除 chain[2]-chain[3]（颜色 0）后，新约束可以复用该颜色
+    graph.removeConstraint(links[2]);
+    EXPECT_EQ(graph.getConstraintCount(), links.size() - 1);
+    DistanceConstraint extra(chain[2], chain[3], 0.3f);
+    graph.addConstraint(&extra);
+    EXPECT_EQ(graph.getColor(0).back(), &extra);
+
+    for (DistanceConstraint* link : links) delete link;
+    for (Entity* entity : chain) delete entity;
+}
+
+// 测试5：Jacobi 模式（质量分裂 + 超松弛）同样能让球静止在地面上并满足距离约束
+TEST_F(XPBDSystemTest, JacobiModeSolvesContactsAndConstraints) {
+    Entity other(sphereMesh, glm::vec3(0.5f, 0.5f, 0.0f), 1.0f);
+    system->addObject(sphere);
+    system->addObject(&other);
+    system->addObject(ground);
+    system->initialize();
+    system->setSolverMode(SolverMode::Jacobi);
+    system->setRelaxation(1.5f);
+
+    DistanceConstraint constraint(sphere, &other, 0.3f, 1e9f);
+    system->addConstraint(&constraint);
+    for (int i = 0; i < 600; ++i) {
+        system->run();
+    }
+
+    float distance = glm::length(sphere->getPosition() - other.getPosition());
+    EXPECT_NEAR(distance, 0.3f, 0.01f);
+    EXPECT_NEAR(sphere->getPosition().y, 0.025f, 0.01f);
+    EXPECT_NEAR(other.getPosition().y, 0.025f, 0.01f);
+    EXPECT_NEAR(glm::length(sphere->getLinearVelocity()), 0.0f, 0.05f);
+}
+
+// 测试6：静止的球进入休眠后不再移动，施加外力后被唤醒
+TEST_F(XPBDSystemTest, RestingSphereSleepsAndWakesOnForce) {
+    system->addObject(sphere);
+    system->addObject(ground);
+    system->initialize();
+
+    for (int i = 0; i < 600; ++i) {
+        system->run();
+    }
+    ASSERT_TRUE(sphere->isSleeping());
+    glm::vec3 restingPosition = sphere->getPosition();
+
+    system->run();
+    EXPECT_EQ(sphere->getPosition(), restingPosition);
+    EXPECT_TRUE(system->getContacts().empty()); // 休眠刚体与地面之间不做窄相检测
+
+    sphere->addForce(glm::vec3(0.0f, 5000.0f, 0.0f));
+    EXPECT_FALSE(sphere->isSleeping());
+    system->run();
+    EXPECT_GT(sphere->getPosition().y, restingPosition.y);
+}
+
+// 测试7：step() 按固定步长消耗累积时间，慢帧时受步数上限约束，插值系数保持在 [0, 1)
+TEST_F(XPBDSystemTest, FixedStepAccumulatorCapsStepsAndInterpolates) {
+    system->addObject(sphere);
+    system->initialize();
+    system->setTimeStep(0.01f);
+    system->setMaxStepsPerFrame(4);
+
+    EXPECT_EQ(system->step(0.025f), 2);
+    EXPECT_NEAR(system->getInterpolationAlpha(), 0.5f, 1e-3f);
+
+    // 插值位置位于上一步与当前步之间
+    glm::vec3 interpolated = system->getInterpolatedPosition(sphere);
+    EXPECT_GT(interpolated.y, sphere->getPosition().y);
+
+    EXPECT_EQ(system->step(1.0f), 4); // 超出上限的积压时间被丢弃
+    EXPECT_GE(system->getInterpolationAlpha(), 0.0f);
+    EXPECT_LT(system->getInterpolationAlpha(), 1.0f);
+    EXPECT_EQ(system->step(0.0f), 0);
+}
+
+// 测试8：切换为扫掠剪枝宽相后结果不变
+TEST_F(XPBDSystemTest, SweepAndPruneBroadPhaseSettlesSphere) {
+    system->addObject(sphere);
+    system->addObject(ground);
+    system->setBroadPhaseType(BroadPhaseType::SweepAndPrune);
+    EXPECT_EQ(system->getBroadPhaseType(), BroadPhaseType::SweepAndPrune);
+    system->initialize();
+
+    for (int i = 0; i < 600; ++i) {
+        system->run();
+    }
+
+    EXPECT_NEAR(sphere->getPosition().y, 0.025f, 0.01f);
+    EXPECT_NEAR(glm::length(sphere->getLinearVelocity()), 0.0f, 0.05f);
+}
+
+// 测试9：空间哈希宽相在线程池更换后同样让球静止在地面上
+TEST_F(XPBDSystemTest, SpatialHashBroadPhaseSettlesSphere) {
+    system->addObject(sphere);
+    system->addObject(ground);
+    system->setBroadPhaseType(BroadPhaseType::SpatialHash);
+    // 更换线程池后网格应改用新的线程池
+    system->setThreadCount(2);
+    system->initialize();
+
+    for (int i = 0; i < 600; ++i) {
+        system->run();
+    }
+
+    EXPECT_NEAR(sphere->getPosition().y, 0.025f, 0.01f);
+    EXPECT_NEAR(glm::length(sphere->getLinearVelocity()), 0.0f, 0.05f);
+}
+
+// 测试10：相对位姿不变的两个相邻球只在第一次做窄相，之后由碰撞对缓存中的间隙直接判为不碰撞
+TEST_F(XPBDSystemTest, PairCacheSkipsSeparatedNarrowPhase) {
+    Entity other(sphereMesh, glm::vec3(0.215f, 0.5f, 0.0f), 1.0f);
+    system->addObject(sphere);
+    system->addObject(&other);
+    system->setSleepEnabled(false);
+    system->initialize();
+
+    system->run();
+    EXPECT_EQ(system->getSkippedNarrowPhaseCount(), 0u);
+    for (int i = 0; i < 10; ++i) {
+        system->run();
+        EXPECT_EQ(system->getSkippedNarrowPhaseCount(), 1u);
+        EXPECT_TRUE(system->getContacts().empty());
+    }
+    EXPECT_NEAR(other.getPosition().x - sphere->getPosition().x, 0.215f, 1e-5f);
+
+    // 推动其中一个球使间隙不再可靠时重新检测
+    other.setLinearVelocity(glm::vec3(-1.0f, 0.0f, 0.0f));
+    system->run();
+    EXPECT_EQ(system->getSkippedNarrowPhaseCount(), 0u);
+
+    // 没有碰撞对缓存的宽相每步都做窄相
+    system->setBroadPhaseType(BroadPhaseType::SweepAndPrune);
+    system->run();
+    EXPECT_EQ(system->getSkippedNarrowPhaseCount(), 0u);
+}
+
+// 测试11：大时间步下高速飞行的球穿过另一个球，开启连续碰撞检测后被挡住
+TEST_F(XPBDSystemTest, ContinuousCollisionStopsTunneling) {
+    for (bool ccd : { false, true }) {
+        XPBDSystem world;
+        world.setTimeStep(1.0f / 30.0f);
+        world.setSleepEnabled(false);
+        Entity target(sphereMesh, glm::vec3(0.0f, 0.5f, 0.0f), 1.0f);
+        Entity bullet(sphereMesh, glm::vec3(-1.0f, 0.5f, 0.0f), 1.0f);
+        bullet.setLinearVelocity(glm::vec3(60.0f, 0.0f, 0.0f)); // 每步 2 m，远大于球的直径
+        bullet.setCCDEnabled(ccd);
+        world.addObject(&target);
+        world.addObject(&bullet);
+        world.initialize();
+        EXPECT_EQ(bullet.isCCDEnabled(), ccd);
+
+        for (int i = 0; i < 5; ++i) {
+            world.run();
+        }
+        if (ccd) {
+            EXPECT_LT(bullet.getPosition().x, target.getPosition().x);
+            EXPECT_GT(target.getLinearVelocity().x, 1.0f);
+        } else {
+            EXPECT_GT(bullet.getPosition().x, target.getPosition().x);
+        }
+    }
+}
+// 测试12：高速下落的倾斜立方体每步移动数倍于自身的尺寸，撞上悬空的薄静态板后不会穿过；
+// 开启连续碰撞检测时在首次触板的位形上生成接触，只有领先的棱角受力，反弹时带上转动
+TEST_F(XPBDSystemTest, ContinuousCollisionWithThinStaticBody) {
+    CubeMesh plateMesh(0.6f, 0.6f, 0.02f);
+    CubeMesh boxMesh(0.2f, 0.2f, 0.2f);
+    for (bool ccd : { false, true }) {
+        XPBDSystem world;
+        world.setTimeStep(1.0f / 30.0f);
+        world.setSleepEnabled(false);
+        Entity plate(&plateMesh, glm::vec3(0.0f, 0.5f, 0.0f), 0.0f);
+        Entity bullet(&boxMesh, glm::vec3(0.0f, 1.3f, 0.0f), 1.0f);
+        bullet.setRotation(glm::angleAxis(0.5f, glm::vec3(0.0f, 0.0f, 1.0f)));
+        bullet.setLinearVelocity(glm::vec3(0.0f, -60.0f, 0.0f)); // 每步 2 m，是立方体边长的 10 倍
+        bullet.setCCDEnabled(ccd);
+        world.addObject(&plate);
+        world.addObject(&bullet);
+        world.initialize();
+
+        for (int i = 0; i < 4; ++i) {
+            world.run();
+            EXPECT_GT(bullet.getPosition().y, 0.51f) << "ccd " << ccd << " step " << i;
+        }
+        EXPECT_GT(bullet.getLinearVelocity().y, 0.0f) << "ccd " << ccd;
+        if (ccd) {
+            EXPECT_GT(std::fabs(bullet.getAngularVelocity().z), 1.0f);
+        }
+    }
+}
+
+// 测试13：休眠的岛保存下来不参与每步的重建，单独唤醒其中一个刚体时整岛唤醒，其他休眠岛不受影响
+TEST_F(XPBDSystemTest, SleepingIslandsStayIntactUntilWoken) {
+    Entity linked(sphereMesh, glm::vec3(0.3f, 0.5f, 0.0f), 1.0f);
+    Entity lonely(sphereMesh, glm::vec3(-0.6f, 0.5f, 0.0f), 1.0f);
+    DistanceConstraint link(sphere, &linked, 0.3f, 1e9f);
+    system->addObject(sphere);
+    system->addObject(&linked);
+    system->addObject(&lonely);
+    system->addObject(ground);
+    system->addConstraint(&link);
+    system->initialize();
+
+    for (int i = 0; i < 600; ++i) {
+        system->run();
+    }
+    ASSERT_TRUE(sphere->isSleeping());
+    ASSERT_TRUE(linked.isSleeping());
+    ASSERT_TRUE(lonely.isSleeping());
+    system->run();
+    EXPECT_EQ(system->getIslands().getIslandCount(), 0u);
+    EXPECT_EQ(system->getIslands().getSleepingIslandCount(), 2u);
+
+    linked.wakeUp();
+    system->run();
+    EXPECT_FALSE(sphere->isSleeping());
+    EXPECT_FALSE(linked.isSleeping());
+    EXPECT_TRUE(lonely.isSleeping());
+    ASSERT_EQ(system->getIslands().getIslandCount(), 1u);
+    EXPECT_EQ(system->getIslands().getIslandEnd(0) - system->getIslands().getIslandBegin(0), 2);
+    EXPECT_EQ(system->getIslands().getSleepingIslandCount(), 1u);
+}
+
+// 测试14：默认所有系统共用进程内的线程池，也可以注入调用者的线程池或改用独占线程池
+TEST_F(XPBDSystemTest, SystemsShareThreadPool) {
+    XPBDSystem other;
+    EXPECT_EQ(system->getThreadPool(), &ThreadPool::shared());
+    EXPECT_EQ(other.getThreadPool(), system->getThreadPool());
+
+    ThreadPool pool(2);
+    system->setThreadPool(&pool);
+    other.setThreadPool(&pool);
+    EXPECT_EQ(system->getThreadCount(), 2u);
+
+    system->setThreadCount(3);
+    EXPECT_EQ(system->getThreadCount(), 3u);
+    EXPECT_NE(system->getThreadPool(), &pool);
+    system->setThreadPool(nullptr);
+    EXPECT_EQ(system->getThreadPool(), &ThreadPool::shared());
+
+    // 两个系统交替在同一个线程池上运行
+    Entity otherSphere(sphereMesh, glm::vec3(0.0f, 0.5f, 0.0f), 1.0f);
+    Entity otherGround(groundMesh, glm::vec3(0.0f, -0.1f, 0.0f), 0.0f);
+    system->addObject(sphere);
+    system->addObject(ground);
+    other.addObject(&otherSphere);
+    other.addObject(&otherGround);
+    system->initialize();
+    other.initialize();
+    for (int i = 0; i < 600; ++i) {
+        system->run();
+        other.run();
+    }
+    EXPECT_NEAR(sphere->getPosition().y, 0.025f, 0.01f);
+    EXPECT_NEAR(otherSphere.getPosition().y, 0.025f, 0.01f);
+}
+
+// 测试15：开启连续碰撞检测的球高速砸在宽板的边缘附近，接触法线取板的表面法线而不是两中心的连线，球不会被横向推开
+TEST_F(XPBDSystemTest, ContinuousCollisionUsesSurfaceNormal) {
+    CubeMesh plateMesh(1.0f, 1.0f, 0.02f);
+    XPBDSystem world;
+    world.setTimeStep(1.0f / 30.0f);
+    world.setSleepEnabled(false);
+    Entity plate(&plateMesh, glm::vec3(0.0f), 10.0f);
+    Entity bullet(sphereMesh, glm::vec3(0.4f, 1.3f, 0.0f), 1.0f);
+    bullet.setLinearVelocity(glm::vec3(0.0f, -60.0f, 0.0f)); // 每步 2 m，是球直径的 10 倍
+    bullet.setCCDEnabled(true);
+    world.addObject(&plate);
+    world.addObject(&bullet);
+    world.initialize();
+
+    world.run();
+    // 板比球轻得多，被撞后翻转着一起下落；球仍在板的上侧
+    glm::vec3 local = glm::inverse(plate.getRotation()) * (bullet.getPosition() - plate.getPosition());
+    EXPECT_GT(local.y, 0.1f);
+    EXPECT_LT(plate.getLinearVelocity().y, -1.0f);
+    // 沿中心连线的法线与竖直方向夹角约 75°，会把球明显地横向推开
+    EXPECT_LT(std::fabs(bullet.getLinearVelocity().x), 0.1f * std::fabs(bullet.getLinearVelocity().y));
+    EXPECT_LT(std::fabs(plate.getLinearVelocity().x), 0.1f * std::fabs(plate.getLinearVelocity().y));
+}
+
+// 测试16：被 70 个约束共用的固定锚点解除固定后重新着色，并行颜色内的约束仍不共享刚体，超出的约束进入串行颜色
+TEST_F(XPBDSystemTest, FreeingSharedAnchorRecolorsConstraints) {
+    const int count = 70;
+    Entity anchor(sphereMesh, glm::vec3(0.0f, 5.0f, 0.0f), 1.0f);
+    anchor.setFixed(true);
+    system->addObject(&anchor);
+    std::vector<Entity*> hanging;
+    std::vector<DistanceConstraint*> links;
+    for (int i = 0; i < count; ++i) {
+        hanging.push_back(new Entity(sphereMesh, glm::vec3(0.3f * (i - count / 2), 4.0f, 0.0f), 1.0f));
+        system->addObject(hanging.back());
+        links.push_back(new DistanceConstraint(&anchor, hanging.back(), glm::length(hanging.back()->getPosition() - anchor.getPosition())));
+        system->addConstraint(links.back());
+    }
+    system->initialize();
+
+    system->run();
+    EXPECT_EQ(system->getConstraintGraph().getColorCount(), 1); // 锚点固定时不参与冲突判断
+
+    anchor.setFixed(false);
+    system->run();
+    const ConstraintGraph& graph = system->getConstraintGraph();
+    EXPECT_EQ(graph.getConstraintCount(), static_cast<size_t>(count));
+    EXPECT_EQ(graph.getColorCount(), ConstraintGraph::MaxParallelColors + 1);
+    for (int color = 0; color < graph.getColorCount(); ++color) {
+        if (graph.isSerialColor(color)) continue;
+        std::vector<uint32_t> bodies;
+        for (Constraint* constraint : graph.getColor(color)) {
+            for (Entity* entity : constraint->getEntities()) {
+                if (entity->getInverseMass() == 0.0f) continue;
+                EXPECT_EQ(std::count(bodies.begin(), bodies.end(), entity->getBodyIndex()), 0) << "color " << color;
+                bodies.push_back(entity->getBodyIndex());
+            }
+        }
+    }
+
+    for (DistanceConstraint* link : links) delete link;
+    for (Entity* entity : hanging) delete entity;
+}
+
+// 测试17：反弹的速度阈值跟随求解器的重力，无重力时缓慢接触地面的球也会按恢复系数弹开
+TEST_F(XPBDSystemTest, RestitutionThresholdFollowsGravity) {
+    system->setGravity(0.0f);
+    EXPECT_EQ(system->getGravity(), 0.0f);
+    sphere->setPosition(glm::vec3(0.0f, 0.025f, 0.0f));       // 恰好与地面顶面接触
+    sphere->setLinearVelocity(glm::vec3(0.0f, -0.03f, 0.0f)); // 低于 9.81 重力在两个子步内产生的速度
+    system->setSleepEnabled(false);
+    system->addObject(sphere);
+    system->addObject(ground);
+    system->initialize();
+
+    system->run();
+    EXPECT_NEAR(sphere->getLinearVelocity().y, 0.015f, 0.005f); // 默认恢复系数 0.5
+}